@@ -0,0 +1,792 @@
+// Concurrent load generator and latency benchmark for DAX queries (grew out of the
+// interactive single-query console). N clients run a weighted query mix for a
+// fixed duration after a warmup, each query start to finish the way an msolap()
+// scan does: connect, execute, first row, drain. Build with
+// -DMSOLAP_BUILD_BENCHMARKS=ON or directly:
+//
+//   g++ -O2 -std=c++17 -pthread -Isrc/include -o msolap_bench
+//       benchmark/msolap_bench.cpp src/msolap_connection_string.cpp
+//
+//   msolap_bench --queries FILE (--connection STRING | --replay LOG) [--clients N]
+//                [--duration S] [--warmup S] [--replay-speed X] [--record FILE]
+//                [--output FILE] [--seed N]
+//
+// The query mix file holds DAX queries separated by lines starting with "---",
+// which may carry "name=" and "weight=" attributes:
+//
+//   --- name=sales_by_year weight=3
+//   EVALUATE SUMMARIZECOLUMNS('Date'[Year], "Sales", [Total Sales])
+//   --- name=products
+//   EVALUATE Product
+//
+// --connection runs against a server through the OLE DB provider (Windows only).
+// --replay replays recorded timings instead: a JSON lines file as written by
+// msolap_query_log_file or by --record, matched to the mix by query text. The
+// client sleeps through each recorded phase, so the tool and its report run on
+// any platform. The report (JSON, stdout or --output) has throughput, rows/s,
+// bytes/s and p50/p95/p99 of every phase, overall and per query.
+
+#include "msolap_connection_string.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <oledb.h>
+#include <oledberr.h>
+#include <comdef.h>
+#endif
+
+using namespace duckdb;
+using Clock = std::chrono::steady_clock;
+
+struct BenchQuery {
+    std::string name;
+    std::string text;
+    double weight = 1;
+};
+
+// One query run: the phases in the order a scan goes through them
+struct BenchSample {
+    size_t query = 0;
+    double connect_ms = 0;
+    double execute_ms = 0;
+    // From the end of execute to the first row
+    double first_row_ms = 0;
+    // From the first row to the end of the rowset
+    double drain_ms = 0;
+    uint64_t rows = 0;
+    uint64_t bytes = 0;
+    bool ok = true;
+    std::string error;
+
+    double TotalMs() const {
+        return connect_ms + execute_ms + first_row_ms + drain_ms;
+    }
+};
+
+class BenchBackend {
+public:
+    virtual ~BenchBackend() = default;
+    virtual const char *Name() const = 0;
+    // Run one query start to finish on the calling client thread
+    virtual BenchSample Run(const BenchQuery &query) = 0;
+};
+
+static double ElapsedMs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static std::string Trim(const std::string &text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return std::string();
+    }
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+static std::string ReadFile(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("cannot read " + path);
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+//===--------------------------------------------------------------------===//
+// Query mix
+//===--------------------------------------------------------------------===//
+
+static std::vector<BenchQuery> ParseQueryMix(const std::string &content) {
+    std::vector<BenchQuery> queries;
+    BenchQuery current;
+    std::string text;
+    auto flush = [&]() {
+        current.text = Trim(text);
+        if (!current.text.empty()) {
+            if (current.name.empty()) {
+                current.name = "q" + std::to_string(queries.size());
+            }
+            queries.push_back(current);
+        }
+        current = BenchQuery();
+        text.clear();
+    };
+
+    std::istringstream lines(content);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, 3, "---") != 0) {
+            text += line + "\n";
+            continue;
+        }
+        flush();
+        std::istringstream attributes(line.substr(3));
+        std::string attribute;
+        while (attributes >> attribute) {
+            auto equals = attribute.find('=');
+            auto key = attribute.substr(0, equals);
+            auto value = equals == std::string::npos ? std::string() : attribute.substr(equals + 1);
+            if (key == "name") {
+                current.name = value;
+            } else if (key == "weight") {
+                current.weight = std::strtod(value.c_str(), nullptr);
+                if (!(current.weight > 0)) {
+                    throw std::runtime_error("weight must be positive: " + line);
+                }
+            } else {
+                throw std::runtime_error("unknown query attribute \"" + key + "\": " + line);
+            }
+        }
+    }
+    flush();
+    if (queries.empty()) {
+        throw std::runtime_error("the query mix holds no queries");
+    }
+    return queries;
+}
+
+//===--------------------------------------------------------------------===//
+// JSON lines of recorded scans (msolap_query_log_file format)
+//===--------------------------------------------------------------------===//
+
+static std::string JsonEscape(const std::string &input) {
+    std::string result;
+    for (char c : input) {
+        switch (c) {
+        case '"':
+            result += "\\\"";
+            break;
+        case '\\':
+            result += "\\\\";
+            break;
+        case '\n':
+            result += "\\n";
+            break;
+        case '\r':
+            result += "\\r";
+            break;
+        case '\t':
+            result += "\\t";
+            break;
+        default:
+            if ((unsigned char)c < 0x20) {
+                char buffer[8];
+                snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned char)c);
+                result += buffer;
+            } else {
+                result += c;
+            }
+        }
+    }
+    return result;
+}
+
+// Position just after "key": in a flat JSON object, npos if missing. A match after
+// a backslash is an escaped quote inside a string value, e.g. a query's text.
+static size_t JsonFind(const std::string &line, const std::string &key) {
+    auto pattern = "\"" + key + "\":";
+    auto pos = line.find(pattern);
+    while (pos != std::string::npos && pos > 0 && line[pos - 1] == '\\') {
+        pos = line.find(pattern, pos + 1);
+    }
+    return pos == std::string::npos ? pos : pos + pattern.size();
+}
+
+static bool JsonString(const std::string &line, const std::string &key, std::string &result) {
+    auto pos = JsonFind(line, key);
+    if (pos == std::string::npos || pos >= line.size() || line[pos] != '"') {
+        return false;
+    }
+    result.clear();
+    for (pos++; pos < line.size() && line[pos] != '"'; pos++) {
+        if (line[pos] != '\\' || pos + 1 >= line.size()) {
+            result += line[pos];
+            continue;
+        }
+        char escaped = line[++pos];
+        switch (escaped) {
+        case 'n':
+            result += '\n';
+            break;
+        case 'r':
+            result += '\r';
+            break;
+        case 't':
+            result += '\t';
+            break;
+        case 'u':
+            // Only control characters are written as \u00XX
+            result += (char)std::strtoul(line.substr(pos + 1, 4).c_str(), nullptr, 16);
+            pos += 4;
+            break;
+        default:
+            result += escaped;
+        }
+    }
+    return true;
+}
+
+static double JsonNumber(const std::string &line, const std::string &key) {
+    auto pos = JsonFind(line, key);
+    return pos == std::string::npos ? 0 : std::strtod(line.c_str() + pos, nullptr);
+}
+
+// Written so that --replay reads it back into the same phases
+static std::string RecordLine(const BenchQuery &query, const BenchSample &sample) {
+    char numbers[512];
+    snprintf(numbers, sizeof(numbers),
+             ",\"connect_ms\":%.3f,\"execute_ms\":%.3f,\"first_row_ms\":%.3f,\"fetch_ms\":%.3f,"
+             "\"convert_ms\":0,\"rows\":%llu,\"bytes\":%llu}\n",
+             sample.connect_ms, sample.execute_ms, sample.connect_ms + sample.execute_ms + sample.first_row_ms,
+             sample.first_row_ms + sample.drain_ms, (unsigned long long)sample.rows,
+             (unsigned long long)sample.bytes);
+    return "{\"query\":\"" + JsonEscape(query.text) + "\",\"status\":\"" + (sample.ok ? "completed" : "failed") +
+           "\"" + numbers;
+}
+
+//===--------------------------------------------------------------------===//
+// Replay backend
+//===--------------------------------------------------------------------===//
+
+class ReplayBackend : public BenchBackend {
+public:
+    ReplayBackend(const std::string &log_file, const std::vector<BenchQuery> &queries, double speed)
+        : speed(speed), recordings(queries.size()), next(queries.size()) {
+        std::map<std::string, size_t> by_text;
+        for (size_t i = 0; i < queries.size(); i++) {
+            by_text[queries[i].text] = i;
+        }
+        std::istringstream lines(ReadFile(log_file));
+        std::string line;
+        while (std::getline(lines, line)) {
+            std::string query;
+            std::string status;
+            if (!JsonString(line, "query", query)) {
+                continue;
+            }
+            auto entry = by_text.find(Trim(query));
+            if (entry == by_text.end() || (JsonString(line, "status", status) && status != "completed")) {
+                continue;
+            }
+            BenchSample sample;
+            sample.connect_ms = JsonNumber(line, "connect_ms");
+            sample.execute_ms = JsonNumber(line, "execute_ms");
+            sample.first_row_ms =
+                std::max(0.0, JsonNumber(line, "first_row_ms") - sample.connect_ms - sample.execute_ms);
+            sample.drain_ms = std::max(
+                0.0, JsonNumber(line, "fetch_ms") + JsonNumber(line, "convert_ms") - sample.first_row_ms);
+            sample.rows = (uint64_t)JsonNumber(line, "rows");
+            sample.bytes = (uint64_t)JsonNumber(line, "bytes");
+            recordings[entry->second].push_back(sample);
+        }
+        for (size_t i = 0; i < queries.size(); i++) {
+            if (recordings[i].empty()) {
+                throw std::runtime_error("no completed recording of query " + queries[i].name + " in " + log_file);
+            }
+        }
+        for (size_t i = 0; i < queries.size(); i++) {
+            index_of[&queries[i]] = i;
+        }
+    }
+
+    const char *Name() const override {
+        return "replay";
+    }
+
+    BenchSample Run(const BenchQuery &query) override {
+        size_t index = index_of.at(&query);
+        auto &samples = recordings[index];
+        // Recordings of a query are replayed round robin across clients
+        const auto &recorded = samples[next[index].fetch_add(1) % samples.size()];
+
+        BenchSample sample;
+        sample.query = index;
+        sample.rows = recorded.rows;
+        sample.bytes = recorded.bytes;
+        sample.connect_ms = Phase(recorded.connect_ms);
+        sample.execute_ms = Phase(recorded.execute_ms);
+        sample.first_row_ms = Phase(recorded.first_row_ms);
+        sample.drain_ms = Phase(recorded.drain_ms);
+        return sample;
+    }
+
+private:
+    // Sleep through a recorded phase and measure how long it actually took
+    double Phase(double recorded_ms) {
+        auto start = Clock::now();
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(recorded_ms / speed));
+        return ElapsedMs(start, Clock::now());
+    }
+
+    double speed;
+    std::vector<std::vector<BenchSample>> recordings;
+    std::vector<std::atomic<size_t>> next;
+    std::map<const BenchQuery *, size_t> index_of;
+};
+
+//===--------------------------------------------------------------------===//
+// OLE DB backend
+//===--------------------------------------------------------------------===//
+
+#ifdef _WIN32
+
+// MSOLAP.8
+static const CLSID CLSID_MSOLAP = {0xDBC724B0, 0xDD86, 0x4772, {0xBB, 0x5A, 0xFC, 0xC6, 0xCA, 0xB2, 0xFC, 0x1A}};
+
+// Structure for column data when using variants
+struct COLUMNDATA {
+    DBSTATUS dwStatus;
+    DBLENGTH dwLength;
+    VARIANT var;
+};
+
+template <class T>
+static void SafeRelease(T **ppT) {
+    if (*ppT) {
+        (*ppT)->Release();
+        *ppT = NULL;
+    }
+}
+
+static std::wstring Widen(const std::string &text) {
+    int length = MultiByteToWideChar(CP_UTF8, 0, text.c_str(), (int)text.size(), NULL, 0);
+    std::wstring result(length, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, text.c_str(), (int)text.size(), &result[0], length);
+    return result;
+}
+
+static void Check(HRESULT hr, const char *what) {
+    if (FAILED(hr)) {
+        _com_error err(hr);
+        char message[512];
+        snprintf(message, sizeof(message), "%s failed: 0x%08lx %ls", what, (unsigned long)hr, err.ErrorMessage());
+        throw std::runtime_error(message);
+    }
+}
+
+class OleDbBackend : public BenchBackend {
+public:
+    OleDbBackend(const std::string &connection_string, const std::vector<BenchQuery> &queries) : queries(queries) {
+        // Data Source and Catalog are initialization properties, the provider reads the rest itself
+        auto parsed = MSOLAPConnectionString::Parse(connection_string);
+        for (auto &property : parsed.InitProperties()) {
+            if (property.first == MSOLAPInitProperty::DATA_SOURCE) {
+                data_source = Widen(property.second);
+            } else if (property.first == MSOLAPInitProperty::CATALOG) {
+                catalog = Widen(property.second);
+            }
+        }
+        provider_string = Widen(connection_string);
+    }
+
+    const char *Name() const override {
+        return "oledb";
+    }
+
+    BenchSample Run(const BenchQuery &query) override {
+        // Every client thread joins the multithreaded apartment once
+        thread_local HRESULT com = CoInitializeEx(NULL, COINIT_MULTITHREADED);
+        (void)com;
+
+        BenchSample sample;
+        sample.query = &query - queries.data();
+        IDBInitialize *initialize = NULL;
+        IDBCreateSession *create_session = NULL;
+        IDBCreateCommand *create_command = NULL;
+        ICommandText *command = NULL;
+        IRowset *rowset = NULL;
+        IAccessor *accessor = NULL;
+        HACCESSOR haccessor = NULL;
+        std::vector<DBBINDING> bindings;
+        try {
+            auto phase_start = Clock::now();
+            Check(CoCreateInstance(CLSID_MSOLAP, NULL, CLSCTX_INPROC_SERVER, IID_IDBInitialize,
+                                   (void **)&initialize),
+                  "CoCreateInstance");
+            SetProperties(initialize);
+            Check(initialize->Initialize(), "Initialize");
+            Check(initialize->QueryInterface(IID_IDBCreateSession, (void **)&create_session), "QueryInterface");
+            Check(create_session->CreateSession(NULL, IID_IDBCreateCommand, (IUnknown **)&create_command),
+                  "CreateSession");
+            auto phase_end = Clock::now();
+            sample.connect_ms = ElapsedMs(phase_start, phase_end);
+
+            phase_start = phase_end;
+            Check(create_command->CreateCommand(NULL, IID_ICommandText, (IUnknown **)&command), "CreateCommand");
+            Check(command->SetCommandText(DBGUID_DEFAULT, Widen(query.text).c_str()), "SetCommandText");
+            Check(command->Execute(NULL, IID_IRowset, NULL, NULL, (IUnknown **)&rowset), "Execute");
+            phase_end = Clock::now();
+            sample.execute_ms = ElapsedMs(phase_start, phase_end);
+
+            // Bind every column as a VARIANT, like the extension's reader
+            IColumnsInfo *columns_info = NULL;
+            Check(rowset->QueryInterface(IID_IColumnsInfo, (void **)&columns_info), "QueryInterface");
+            DBORDINAL column_count = 0;
+            DBCOLUMNINFO *column_info = NULL;
+            WCHAR *strings = NULL;
+            HRESULT hr = columns_info->GetColumnInfo(&column_count, &column_info, &strings);
+            SafeRelease(&columns_info);
+            Check(hr, "GetColumnInfo");
+            bindings.resize(column_count);
+            for (DBORDINAL i = 0; i < column_count; i++) {
+                auto &binding = bindings[i];
+                ZeroMemory(&binding, sizeof(DBBINDING));
+                binding.iOrdinal = column_info[i].iOrdinal;
+                binding.obValue = i * sizeof(COLUMNDATA) + offsetof(COLUMNDATA, var);
+                binding.obLength = i * sizeof(COLUMNDATA) + offsetof(COLUMNDATA, dwLength);
+                binding.obStatus = i * sizeof(COLUMNDATA) + offsetof(COLUMNDATA, dwStatus);
+                binding.cbMaxLen = sizeof(VARIANT);
+                binding.eParamIO = DBPARAMIO_NOTPARAM;
+                binding.dwPart = DBPART_VALUE | DBPART_LENGTH | DBPART_STATUS;
+                binding.dwMemOwner = DBMEMOWNER_CLIENTOWNED;
+                binding.wType = DBTYPE_VARIANT;
+            }
+            CoTaskMemFree(column_info);
+            CoTaskMemFree(strings);
+            Check(rowset->QueryInterface(IID_IAccessor, (void **)&accessor), "QueryInterface");
+            Check(accessor->CreateAccessor(DBACCESSOR_ROWDATA, column_count, bindings.data(),
+                                           column_count * sizeof(COLUMNDATA), &haccessor, NULL),
+                  "CreateAccessor");
+
+            // Drain the rowset in batches of the extension's default fetch size
+            const DBROWCOUNT batch_size = 2048;
+            std::vector<HROW> handles(batch_size);
+            std::vector<COLUMNDATA> row(column_count);
+            bool first = true;
+            while (true) {
+                DBCOUNTITEM obtained = 0;
+                HROW *rows = handles.data();
+                hr = rowset->GetNextRows(0, 0, batch_size, &obtained, &rows);
+                Check(hr, "GetNextRows");
+                if (first) {
+                    auto now = Clock::now();
+                    sample.first_row_ms = ElapsedMs(phase_end, now);
+                    phase_end = now;
+                    first = false;
+                }
+                for (DBCOUNTITEM r = 0; r < obtained; r++) {
+                    memset(row.data(), 0, row.size() * sizeof(COLUMNDATA));
+                    if (FAILED(rowset->GetData(handles[r], haccessor, row.data()))) {
+                        continue;
+                    }
+                    for (auto &column : row) {
+                        if (column.dwStatus == DBSTATUS_S_OK) {
+                            sample.bytes += column.var.vt == VT_BSTR && column.var.bstrVal
+                                                ? SysStringByteLen(column.var.bstrVal)
+                                                : sizeof(column.var.llVal);
+                        }
+                        VariantClear(&column.var);
+                    }
+                }
+                sample.rows += obtained;
+                if (obtained > 0) {
+                    rowset->ReleaseRows(obtained, handles.data(), NULL, NULL, NULL);
+                }
+                if (hr == DB_S_ENDOFROWSET || obtained == 0) {
+                    break;
+                }
+            }
+            sample.drain_ms = ElapsedMs(phase_end, Clock::now());
+        } catch (std::exception &e) {
+            sample.ok = false;
+            sample.error = e.what();
+        }
+
+        if (accessor && haccessor) {
+            accessor->ReleaseAccessor(haccessor, NULL);
+        }
+        SafeRelease(&accessor);
+        SafeRelease(&rowset);
+        SafeRelease(&command);
+        SafeRelease(&create_command);
+        SafeRelease(&create_session);
+        if (initialize) {
+            initialize->Uninitialize();
+            SafeRelease(&initialize);
+        }
+        return sample;
+    }
+
+private:
+    void SetProperties(IDBInitialize *initialize) {
+        IDBProperties *properties = NULL;
+        Check(initialize->QueryInterface(IID_IDBProperties, (void **)&properties), "QueryInterface");
+        DBPROP props[4];
+        ZeroMemory(props, sizeof(props));
+        props[0].dwPropertyID = DBPROP_INIT_DATASOURCE;
+        props[0].vValue.vt = VT_BSTR;
+        props[0].vValue.bstrVal = SysAllocString(data_source.empty() ? L"localhost" : data_source.c_str());
+        props[1].dwPropertyID = DBPROP_INIT_CATALOG;
+        props[1].vValue.vt = VT_BSTR;
+        props[1].vValue.bstrVal = SysAllocString(catalog.c_str());
+        props[2].dwPropertyID = DBPROP_INIT_MODE;
+        props[2].vValue.vt = VT_I4;
+        props[2].vValue.lVal = DB_MODE_READ;
+        props[3].dwPropertyID = DBPROP_INIT_PROVIDERSTRING;
+        props[3].vValue.vt = VT_BSTR;
+        props[3].vValue.bstrVal = SysAllocString(provider_string.c_str());
+        for (auto &prop : props) {
+            prop.dwOptions = DBPROPOPTIONS_REQUIRED;
+        }
+        DBPROPSET prop_set;
+        prop_set.guidPropertySet = DBPROPSET_DBINIT;
+        prop_set.cProperties = 4;
+        prop_set.rgProperties = props;
+        HRESULT hr = properties->SetProperties(1, &prop_set);
+        for (auto &prop : props) {
+            VariantClear(&prop.vValue);
+        }
+        SafeRelease(&properties);
+        Check(hr, "SetProperties");
+    }
+
+    const std::vector<BenchQuery> &queries;
+    std::wstring data_source;
+    std::wstring catalog;
+    std::wstring provider_string;
+};
+
+#endif
+
+//===--------------------------------------------------------------------===//
+// Load generation and report
+//===--------------------------------------------------------------------===//
+
+struct BenchOptions {
+    std::string queries_file;
+    std::string connection_string;
+    std::string replay_file;
+    std::string record_file;
+    std::string output_file;
+    size_t clients = 1;
+    double duration_s = 10;
+    double warmup_s = 2;
+    double replay_speed = 1;
+    unsigned seed = 42;
+};
+
+// Nearest-rank percentile of sorted values
+static double Percentile(const std::vector<double> &sorted, double percent) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t rank = (size_t)std::ceil(percent / 100 * sorted.size());
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+static std::string LatencyJson(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (auto value : values) {
+        sum += value;
+    }
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "{\"mean\":%.3f,\"p50\":%.3f,\"p95\":%.3f,\"p99\":%.3f,\"max\":%.3f}",
+             values.empty() ? 0 : sum / values.size(), Percentile(values, 50), Percentile(values, 95),
+             Percentile(values, 99), values.empty() ? 0 : values.back());
+    return buffer;
+}
+
+// Throughput and per phase latencies of a set of samples
+static std::string StatsJson(const std::vector<const BenchSample *> &samples, double duration_s) {
+    std::vector<double> total, connect, execute, first_row, drain;
+    uint64_t rows = 0;
+    uint64_t bytes = 0;
+    size_t errors = 0;
+    for (auto sample : samples) {
+        if (!sample->ok) {
+            errors++;
+            continue;
+        }
+        total.push_back(sample->TotalMs());
+        connect.push_back(sample->connect_ms);
+        execute.push_back(sample->execute_ms);
+        first_row.push_back(sample->first_row_ms);
+        drain.push_back(sample->drain_ms);
+        rows += sample->rows;
+        bytes += sample->bytes;
+    }
+    char numbers[256];
+    snprintf(numbers, sizeof(numbers),
+             "\"completed\":%zu,\"errors\":%zu,\"queries_per_s\":%.3f,\"rows\":%llu,\"rows_per_s\":%.1f,"
+             "\"bytes\":%llu,\"bytes_per_s\":%.1f",
+             total.size(), errors, total.size() / duration_s, (unsigned long long)rows, rows / duration_s,
+             (unsigned long long)bytes, bytes / duration_s);
+    return std::string(numbers) + ",\"latency_ms\":{\"total\":" + LatencyJson(total) +
+           ",\"connect\":" + LatencyJson(connect) + ",\"execute\":" + LatencyJson(execute) +
+           ",\"first_row\":" + LatencyJson(first_row) + ",\"drain\":" + LatencyJson(drain) + "}";
+}
+
+static int RunBenchmark(const BenchOptions &options) {
+    auto queries = ParseQueryMix(ReadFile(options.queries_file));
+    std::unique_ptr<BenchBackend> backend;
+    if (!options.replay_file.empty()) {
+        backend.reset(new ReplayBackend(options.replay_file, queries, options.replay_speed));
+    } else {
+#ifdef _WIN32
+        backend.reset(new OleDbBackend(options.connection_string, queries));
+#else
+        throw std::runtime_error("--connection needs the OLE DB provider (Windows), use --replay elsewhere");
+#endif
+    }
+
+    std::vector<double> weights;
+    for (auto &query : queries) {
+        weights.push_back(query.weight);
+    }
+
+    std::mutex lock;
+    std::vector<BenchSample> samples;
+    std::string first_error;
+    std::ofstream record;
+    if (!options.record_file.empty()) {
+        record.open(options.record_file, std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!record) {
+            throw std::runtime_error("cannot write " + options.record_file);
+        }
+    }
+
+    // Queries started during the warmup are run but not measured, none start after the end
+    auto start = Clock::now();
+    auto seconds = [](double value) {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(value));
+    };
+    auto measure_from = start + seconds(options.warmup_s);
+    auto stop_at = measure_from + seconds(options.duration_s);
+    std::vector<std::thread> clients;
+    for (size_t client = 0; client < options.clients; client++) {
+        clients.emplace_back([&, client]() {
+            std::mt19937 random(options.seed + (unsigned)client);
+            std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+            while (true) {
+                auto query_start = Clock::now();
+                if (query_start >= stop_at) {
+                    break;
+                }
+                auto &query = queries[pick(random)];
+                auto sample = backend->Run(query);
+                sample.query = &query - queries.data();
+                std::lock_guard<std::mutex> guard(lock);
+                if (!sample.ok && first_error.empty()) {
+                    first_error = query.name + ": " + sample.error;
+                }
+                if (record.is_open() && sample.ok) {
+                    record << RecordLine(query, sample);
+                }
+                if (query_start >= measure_from) {
+                    samples.push_back(std::move(sample));
+                }
+            }
+        });
+    }
+    for (auto &client : clients) {
+        client.join();
+    }
+    // Queries in flight at the end finish after it, rates are over the time actually measured
+    double measured_s = std::chrono::duration<double>(Clock::now() - measure_from).count();
+
+    std::vector<const BenchSample *> all;
+    std::vector<std::vector<const BenchSample *>> per_query(queries.size());
+    for (auto &sample : samples) {
+        all.push_back(&sample);
+        per_query[sample.query].push_back(&sample);
+    }
+    std::string report = "{\"backend\":\"" + std::string(backend->Name()) + "\",\"clients\":" +
+                         std::to_string(options.clients) + ",\"duration_s\":" + std::to_string(options.duration_s) +
+                         ",\"warmup_s\":" + std::to_string(options.warmup_s) + ",\"measured_s\":" +
+                         std::to_string(measured_s) + "," + StatsJson(all, measured_s) + ",\"queries\":[";
+    for (size_t i = 0; i < queries.size(); i++) {
+        report += std::string(i == 0 ? "" : ",") + "{\"name\":\"" + JsonEscape(queries[i].name) +
+                  "\",\"weight\":" + std::to_string(queries[i].weight) + "," +
+                  StatsJson(per_query[i], measured_s) + "}";
+    }
+    report += "]}\n";
+
+    if (options.output_file.empty()) {
+        fputs(report.c_str(), stdout);
+    } else {
+        std::ofstream out(options.output_file, std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!(out << report)) {
+            throw std::runtime_error("cannot write " + options.output_file);
+        }
+    }
+    if (!first_error.empty()) {
+        fprintf(stderr, "first error: %s\n", first_error.c_str());
+    }
+    size_t completed = 0;
+    for (auto &sample : samples) {
+        completed += sample.ok;
+    }
+    return completed > 0 && first_error.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char **argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            fprintf(stderr, "missing value for %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+        std::string value = argv[++i];
+        if (arg == "--queries") {
+            options.queries_file = value;
+        } else if (arg == "--connection") {
+            options.connection_string = value;
+        } else if (arg == "--replay") {
+            options.replay_file = value;
+        } else if (arg == "--replay-speed") {
+            options.replay_speed = strtod(value.c_str(), nullptr);
+        } else if (arg == "--record") {
+            options.record_file = value;
+        } else if (arg == "--output") {
+            options.output_file = value;
+        } else if (arg == "--clients") {
+            options.clients = strtoul(value.c_str(), nullptr, 10);
+        } else if (arg == "--duration") {
+            options.duration_s = strtod(value.c_str(), nullptr);
+        } else if (arg == "--warmup") {
+            options.warmup_s = strtod(value.c_str(), nullptr);
+        } else if (arg == "--seed") {
+            options.seed = (unsigned)strtoul(value.c_str(), nullptr, 10);
+        } else {
+            fprintf(stderr, "unknown argument %s\n", arg.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    if (options.queries_file.empty() || options.connection_string.empty() == options.replay_file.empty()) {
+        fprintf(stderr, "usage: msolap_bench --queries FILE (--connection STRING | --replay LOG) [--clients N]\n"
+                        "                    [--duration S] [--warmup S] [--replay-speed X] [--record FILE]\n"
+                        "                    [--output FILE] [--seed N]\n");
+        return EXIT_FAILURE;
+    }
+    if (options.clients == 0 || !(options.duration_s > 0) || options.warmup_s < 0 || !(options.replay_speed > 0)) {
+        fprintf(stderr, "--clients, --duration and --replay-speed must be positive, --warmup not negative\n");
+        return EXIT_FAILURE;
+    }
+
+    try {
+        return RunBenchmark(options);
+    } catch (std::exception &e) {
+        fprintf(stderr, "msolap_bench: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,129 @@
+// Transfer time of a query response with and without transport compression.
+// Portable, needs zlib; build with -DMSOLAP_BUILD_BENCHMARKS=ON or directly:
+//
+//   g++ -O2 -std=c++17 -o msolap_compression_benchmark
+//       benchmark/msolap_compression_benchmark.cpp -lz
+//
+//   msolap_compression_benchmark [--payload FILE] [--rows N] [--rtt-ms MS]
+//
+// The response is either a recorded one (e.g. an XMLA response body saved from a
+// trace) or a generated stand-in shaped like an XMLA rowset. The provider's XPRESS
+// compression isn't available outside Windows, deflate stands in for it: the
+// point is the trade of CPU time for bytes on the wire, which depends on the
+// link far more than on the exact codec. Wire time is modelled as one round trip
+// plus bytes / bandwidth; compression and decompression are measured.
+
+#include <zlib.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// An XMLA rowset response of a typical fact extract: keys, a date, a category and two measures
+static std::string GenerateResponse(size_t rows) {
+    static const char *categories[] = {"Bikes", "Components", "Clothing", "Accessories"};
+    static const char *countries[] = {"Germany", "France", "United States", "Australia", "Canada"};
+    std::string response = "<return><root xmlns=\"urn:schemas-microsoft-com:xml-analysis:rowset\">";
+    unsigned state = 12345;
+    char row[512];
+    for (size_t i = 0; i < rows; i++) {
+        state = state * 1103515245 + 12345;
+        snprintf(row, sizeof(row),
+                 "<row><C0>%zu</C0><C1>2024-%02u-%02uT00:00:00</C1><C2>%s</C2><C3>%s</C3>"
+                 "<C4>%u.%02u</C4><C5>%u</C5></row>",
+                 100000 + i, 1 + (state >> 8) % 12, 1 + (state >> 12) % 28, categories[(state >> 16) % 4],
+                 countries[(state >> 20) % 5], (state >> 4) % 5000, (state >> 2) % 100, 1 + (state >> 24) % 10);
+        response += row;
+    }
+    response += "</root></return>";
+    return response;
+}
+
+struct CompressionResult {
+    std::string name;
+    size_t bytes;
+    double cpu_ms;
+};
+
+static CompressionResult Measure(const std::string &payload, int level) {
+    if (level == 0) {
+        return {"none", payload.size(), 0};
+    }
+    std::vector<Bytef> compressed(compressBound(payload.size()));
+    std::vector<Bytef> restored(payload.size());
+    const int repetitions = 5;
+    uLongf compressed_size = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < repetitions; i++) {
+        compressed_size = compressed.size();
+        if (compress2(compressed.data(), &compressed_size, (const Bytef *)payload.data(), payload.size(), level) !=
+            Z_OK) {
+            fprintf(stderr, "compress2 failed\n");
+            exit(EXIT_FAILURE);
+        }
+        uLongf restored_size = restored.size();
+        if (uncompress(restored.data(), &restored_size, compressed.data(), compressed_size) != Z_OK ||
+            restored_size != payload.size() || memcmp(restored.data(), payload.data(), payload.size()) != 0) {
+            fprintf(stderr, "round trip failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    double cpu_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / repetitions;
+    return {"deflate " + std::to_string(level), (size_t)compressed_size, cpu_ms};
+}
+
+int main(int argc, char **argv) {
+    std::string payload_file;
+    size_t rows = 200000;
+    double rtt_ms = 40;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--payload") {
+            payload_file = argv[i + 1];
+        } else if (arg == "--rows") {
+            rows = strtoull(argv[i + 1], nullptr, 10);
+        } else if (arg == "--rtt-ms") {
+            rtt_ms = strtod(argv[i + 1], nullptr);
+        } else {
+            fprintf(stderr, "unknown argument %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::string payload;
+    if (payload_file.empty()) {
+        payload = GenerateResponse(rows);
+    } else {
+        std::ifstream in(payload_file, std::ios::binary);
+        if (!in) {
+            fprintf(stderr, "cannot read %s\n", payload_file.c_str());
+            return EXIT_FAILURE;
+        }
+        payload.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    printf("payload: %s, %.1f MB, round trip %.0f ms\n", payload_file.empty() ? "generated" : payload_file.c_str(),
+           payload.size() / 1e6, rtt_ms);
+
+    std::vector<CompressionResult> results;
+    for (int level : {0, 1, 6, 9}) {
+        results.push_back(Measure(payload, level));
+    }
+
+    // LAN, fast WAN, slow WAN / VPN
+    for (double mbit : {1000.0, 100.0, 10.0}) {
+        printf("\n%6.0f Mbit/s    %12s %8s %10s %10s %10s\n", mbit, "bytes", "ratio", "cpu ms", "wire ms",
+               "total ms");
+        for (auto &result : results) {
+            double wire_ms = rtt_ms + result.bytes * 8 / (mbit * 1e6) * 1000;
+            printf("  %-14s %12zu %8.2f %10.1f %10.1f %10.1f\n", result.name.c_str(), result.bytes,
+                   (double)payload.size() / result.bytes, result.cpu_ms, wire_ms, result.cpu_ms + wire_ms);
+        }
+    }
+    return EXIT_SUCCESS;
+}
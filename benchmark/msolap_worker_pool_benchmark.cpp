@@ -0,0 +1,163 @@
+// Micro benchmark of the MSOLAP worker pool against a mutex/condition variable
+// queue. Portable, build with -DMSOLAP_BUILD_BENCHMARKS=ON or directly:
+//
+//   g++ -O2 -std=c++17 -pthread -Isrc/include -o msolap_worker_pool_benchmark
+//       benchmark/msolap_worker_pool_benchmark.cpp src/msolap_worker_pool.cpp
+//
+// "round trip" mimics a scan handing one fetch request to the pool and waiting
+// for the batch, "throughput" mimics many scans queueing work at once.
+
+#include "msolap_worker_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+
+using namespace duckdb;
+using Clock = std::chrono::steady_clock;
+
+// Reference implementation: the usual locked queue
+class LockedPool {
+public:
+    explicit LockedPool(size_t thread_count) : stopping(false) {
+        for (size_t i = 0; i < thread_count; i++) {
+            threads.emplace_back([this]() {
+                while (true) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> guard(lock);
+                        cv.wait(guard, [&]() { return !tasks.empty() || stopping; });
+                        if (tasks.empty()) {
+                            return;
+                        }
+                        task = std::move(tasks.front());
+                        tasks.pop_front();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+    ~LockedPool() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+    void Submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            tasks.push_back(std::move(task));
+        }
+        cv.notify_one();
+    }
+    template <class F>
+    auto Run(F &&f) -> decltype(f()) {
+        auto task = std::make_shared<std::packaged_task<decltype(f())()>>(std::forward<F>(f));
+        auto result = task->get_future();
+        Submit([task]() { (*task)(); });
+        return result.get();
+    }
+
+private:
+    std::vector<std::thread> threads;
+    std::deque<std::function<void()>> tasks;
+    std::mutex lock;
+    std::condition_variable cv;
+    bool stopping;
+};
+
+struct Result {
+    double seconds;
+    std::vector<double> latencies_us;
+};
+
+static double Percentile(std::vector<double> &values, double p) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, static_cast<size_t>(p * values.size()))];
+}
+
+// clients threads each run `requests` blocking round trips
+template <class POOL>
+static Result RoundTrip(POOL &pool, size_t clients, size_t requests) {
+    Result result;
+    std::vector<std::vector<double>> latencies(clients);
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (size_t c = 0; c < clients; c++) {
+        threads.emplace_back([&, c]() {
+            volatile size_t sink = 0;
+            for (size_t i = 0; i < requests; i++) {
+                auto request_start = Clock::now();
+                sink += pool.Run([i]() { return i; });
+                latencies[c].push_back(
+                    std::chrono::duration<double, std::micro>(Clock::now() - request_start).count());
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (auto &client : latencies) {
+        result.latencies_us.insert(result.latencies_us.end(), client.begin(), client.end());
+    }
+    return result;
+}
+
+// producers threads each queue `tasks` fire-and-forget tasks
+template <class POOL>
+static double Throughput(POOL &pool, size_t producers, size_t tasks) {
+    std::atomic<size_t> done(0);
+    size_t total = producers * tasks;
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (size_t p = 0; p < producers; p++) {
+        threads.emplace_back([&]() {
+            for (size_t i = 0; i < tasks; i++) {
+                pool.Submit([&done]() { done++; });
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    while (done.load() < total) {
+        std::this_thread::yield();
+    }
+    return total / std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+template <class POOL>
+static void Report(const char *name, POOL &pool, size_t clients, size_t requests) {
+    auto round_trip = RoundTrip(pool, clients, requests);
+    double per_second = Throughput(pool, clients, requests * 10);
+    std::printf("%-10s clients=%-3zu round trips/s=%10.0f  p50=%7.1fus  p99=%7.1fus  tasks/s=%10.0f\n", name,
+                clients, round_trip.latencies_us.size() / round_trip.seconds,
+                Percentile(round_trip.latencies_us, 0.5), Percentile(round_trip.latencies_us, 0.99), per_second);
+}
+
+int main(int argc, char **argv) {
+    size_t workers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    size_t requests = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20000;
+    std::printf("workers=%zu requests per client=%zu\n", workers, requests);
+    for (size_t clients : {1, 4, 16}) {
+        {
+            MSOLAPWorkerPool pool(workers);
+            Report("lock-free", pool, clients, requests);
+        }
+        {
+            LockedPool pool(workers);
+            Report("locked", pool, clients, requests);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_batch.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_rowset_reader.hpp"
+#include <chrono>
+
+namespace duckdb {
+
+// Schema of one result set of a DAX batch, learned at bind time
+struct MSOLAPBatchResult {
+    vector<string> names;
+    vector<LogicalType> types;
+    // Value kinds of the variant columns typed from their first batch
+    vector<MSOLAPValueKind> column_kinds;
+    // Output column each result column is written to
+    vector<idx_t> output_columns;
+};
+
+// One execution of a batch as a single command: its results are read through
+// IMultipleResults one after the other, each by its own rowset reader. The whole
+// execution is one msolap_query_log() entry, logged by Finish.
+class MSOLAPBatchExecution {
+public:
+    MSOLAPBatchExecution(ClientContext &context, const string &connection_string, const string &dax_query);
+    // Cancels an execution that wasn't finished
+    ~MSOLAPBatchExecution();
+
+    // Reader of the next result set, nullptr after the last one
+    unique_ptr<MSOLAPRowsetReader> NextResult();
+
+    // Add the metrics of a result's reader once it is closed
+    void AddMetrics(const MSOLAPRowsetReader &reader);
+
+    // Release the command and log the execution; cancels it unless completed
+    void Finish(const string &status);
+
+    // Finish a failed execution and throw the error to report
+    [[noreturn]] void Fail(const std::exception &error);
+
+private:
+    ClientContext &context;
+    string connection_string;
+    string dax_query;
+    string log_file;
+    MSOLAPConnection connection;
+    ICommand *command = nullptr;
+    IMultipleResults *results = nullptr;
+    MSOLAPQueryWatchdog watchdog;
+    MSOLAPScanMetrics metrics;
+    std::chrono::steady_clock::time_point start;
+    // Seconds from the execution to the current result's reader
+    double result_open_seconds = 0;
+    idx_t result_count = 0;
+    bool finished = false;
+};
+
+// msolap_batch executes a query with several EVALUATE statements as one command:
+// one connection, one execution and one round trip for the whole batch. Bind
+// executes the batch to learn the schema of every result (typing variant columns
+// from their first batch) and cancels it without reading the rows. Each scan
+// executes the batch again and streams the results in order. The output is
+// result_index followed by the union by name of all result columns.
+struct MSOLAPBatchBindData : public TableFunctionData {
+    string connection_string;
+    string dax_query;
+    vector<MSOLAPBatchResult> results;
+    // Output types, result_index first
+    vector<LogicalType> types;
+};
+
+struct MSOLAPBatchGlobalState : public GlobalTableFunctionState {
+    unique_ptr<MSOLAPBatchExecution> execution;
+    // Reader of the result being scanned, nullptr between results
+    unique_ptr<MSOLAPRowsetReader> reader;
+    idx_t result_index = 0;
+    DataChunk chunk;
+};
+
+class MSOLAPBatchFunction : public TableFunction {
+public:
+    MSOLAPBatchFunction();
+};
+
+} // namespace duckdb
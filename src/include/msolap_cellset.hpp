@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_cellset.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace duckdb {
+
+// Tuples of one cellset axis, read once from its axis rowset
+struct MSOLAPCellsetAxis {
+    // One name per dimension (hierarchy) on the axis
+    std::vector<std::string> dimension_names;
+    // Member captions, tuple by tuple: members[tuple * dimension_names.size() + dimension]
+    std::vector<std::string> members;
+
+    size_t TupleCount() const {
+        return dimension_names.empty() ? 0 : members.size() / dimension_names.size();
+    }
+};
+
+// Maps a multidimensional cellset onto a table. Axis 0 (COLUMNS) becomes one value
+// column per tuple; every combination of tuples on the remaining axes becomes a
+// row with one column per dimension on those axes. Cell ordinals run with axis 0
+// fastest, so the cells of consecutive rows form a single contiguous ordinal
+// range that can be fetched with one GetCellData call.
+class MSOLAPCellsetLayout {
+public:
+    explicit MSOLAPCellsetLayout(std::vector<MSOLAPCellsetAxis> axes);
+
+    // Number of output rows: product of the tuple counts of axes 1..n
+    size_t RowCount() const;
+    // Number of leading member columns (dimensions on axes 1..n)
+    size_t MemberColumnCount() const;
+    // Number of value columns (tuples on axis 0, 1 without axes)
+    size_t ValueColumnCount() const;
+
+    // Member columns followed by value columns, made unique
+    std::vector<std::string> ColumnNames() const;
+
+    // Caption of the member shown in member column `column` of output row `row`
+    const std::string &Member(size_t row, size_t column) const;
+
+    // Ordinal of the cell shown in value column `column` of output row `row`
+    size_t CellOrdinal(size_t row, size_t column) const;
+
+    // Total number of cells in the cellset
+    size_t CellCount() const;
+
+private:
+    std::vector<MSOLAPCellsetAxis> axes;
+    // Index of the tuple on axis a for output row r is (r / row_strides[a]) % tuple count
+    std::vector<size_t> row_strides;
+    // For each member column: axis and dimension within it
+    std::vector<std::pair<size_t, size_t>> member_columns;
+};
+
+} // namespace duckdb
@@ -9,6 +9,9 @@
 #pragma once
 
 #include "duckdb.hpp"
+#include "msolap_connection_string.hpp"
+#include "msolap_parameters.hpp"
+#include "msolap_worker_pool.hpp"
 #include <windows.h>
 #include <oledb.h>
 #include <oledberr.h>
@@ -39,9 +42,32 @@ public:
     
     // Execute a DAX query and return an interface to process results
     IRowset* ExecuteQuery(const std::string &dax_query);
+
+    // Create a command for a DAX query without executing it, so the caller can keep
+    // it around for ICommand::Cancel
+    ICommand* CreateCommand(const std::string &dax_query);
+
+    // Execute a command created by CreateCommand
+    IRowset* ExecuteCommand(ICommand *command);
+
+    // Create a command and prepare it via ICommandPrepare so it can be executed
+    // repeatedly without being parsed again
+    ICommand* PrepareCommand(const std::string &dax_query);
+
+    // Execute an MDX command as a multidimensional dataset instead of a flattened rowset
+    IMDDataset* ExecuteDataset(ICommand *command);
+
+    // Execute a command with several statements, one result per EVALUATE
+    IMultipleResults* ExecuteMultiple(ICommand *command);
+
+    // Execute a command, binding the named parameters through ICommandWithParameters
+    IRowset* ExecuteCommand(ICommand *command, const vector<MSOLAPParameter> &parameters);
     
-    // Get column information from a rowset
-    bool GetColumnInfo(IRowset *rowset, std::vector<std::string> &names, std::vector<LogicalType> &types);
+    // Get column information from a rowset; references receives the unsanitized
+    // DAX column names (e.g. "Sales[Amount]") and variants which columns are
+    // DBTYPE_VARIANT when given
+    bool GetColumnInfo(IRowset *rowset, std::vector<std::string> &names, std::vector<LogicalType> &types,
+                       std::vector<std::string> *references = nullptr, std::vector<bool> *variants = nullptr);
     
     // Check if connection is open
     bool IsOpen() const;
@@ -49,20 +75,30 @@ public:
     // Close connection
     void Close();
 
-    // Initialize COM if needed
+    // Join the multithreaded apartment on an extension-owned thread (pool workers, watchdog)
     static void InitializeCOM();
+
+    // Extension-owned MTA threads that create and call all provider objects, except
+    // for ICommand::Cancel (see MSOLAPRowsetReader). DuckDB threads hand work to it
+    // instead of initializing COM themselves.
+    static MSOLAPWorkerPool &WorkerPool();
+
+    // Data Source of a connection string, lower-cased (identifies the server)
+    static std::string GetDataSource(const std::string &connection_string);
 private:
     // Parse connection string and set properties
     void ParseConnectionString(const std::string &connection_string);
-    
+
+    // Hand the parsed properties to the provider before Initialize
+    void SetInitProperties(IDBProperties *properties);
     
     // COM interfaces
     IDBInitialize* pIDBInitialize;
     IDBCreateCommand* pIDBCreateCommand;
     
-    // Connection properties
-    std::wstring server_name;
-    std::wstring database_name;
+    // Connection properties: DBPROPSET_DBINIT ones and the provider string with the rest
+    std::vector<std::pair<MSOLAPInitProperty, std::string>> init_properties;
+    std::string provider_string;
     
     // COM initialization flag
     static bool com_initialized;
@@ -70,7 +106,7 @@ private:
 class ComInitializer {
     public:
         ComInitializer() {
-            HRESULT hr = CoInitialize(NULL);
+            HRESULT hr = CoInitializeEx(NULL, COINIT_MULTITHREADED);
             if (FAILED(hr) && hr != S_FALSE) {
                 throw std::runtime_error("COM initialization failed");
             }
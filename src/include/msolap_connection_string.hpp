@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_connection_string.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace duckdb {
+
+// Initialization properties that have a DBPROPSET_DBINIT equivalent
+enum class MSOLAPInitProperty {
+    DATA_SOURCE,
+    CATALOG,
+    LOCATION,
+    USER_ID,
+    PASSWORD,
+    INTEGRATED_SECURITY,
+    PERSIST_SECURITY_INFO,
+    CONNECT_TIMEOUT,
+    LOCALE_IDENTIFIER
+};
+
+struct MSOLAPConnectionProperty {
+    std::string keyword;
+    std::string value;
+};
+
+// An OLE DB connection string: "keyword=value" pairs separated by ';'. Values may
+// be quoted with " or ' (the quote doubled inside) to contain ';' or '=', and '=='
+// in a keyword stands for a literal '='. Keywords are case-insensitive and a
+// repeated keyword replaces the earlier value.
+class MSOLAPConnectionString {
+public:
+    // Throws std::invalid_argument for unterminated quotes or pairs without '='
+    static MSOLAPConnectionString Parse(const std::string &connection_string);
+
+    // All pairs in the order they first appeared
+    const std::vector<MSOLAPConnectionProperty> &Properties() const {
+        return properties;
+    }
+
+    // Value of a keyword, compared case-insensitively without resolving synonyms
+    bool TryGet(const std::string &keyword, std::string &value) const;
+
+    // Pairs with a DBPROPSET_DBINIT property, synonyms (e.g. Initial Catalog) resolved
+    std::vector<std::pair<MSOLAPInitProperty, std::string>> InitProperties() const;
+
+    // Remaining provider specific pairs (Transport Compression, Packet Size, ...)
+    // as a connection string for DBPROP_INIT_PROVIDERSTRING. Provider is dropped,
+    // the MSOLAP provider is always used.
+    std::string ProviderString() const;
+
+    // "Data Source=...;Catalog=..." without credentials or other properties, for logs
+    // that outlive the connection
+    std::string Description() const;
+
+    // Quote a value when it would not survive Parse unquoted
+    static std::string QuoteValue(const std::string &value);
+
+private:
+    std::vector<MSOLAPConnectionProperty> properties;
+};
+
+} // namespace duckdb
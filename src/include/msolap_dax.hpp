@@ -0,0 +1,44 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_dax.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+// Helpers for generating DAX text from DuckDB values and user queries
+class MSOLAPDax {
+public:
+    // DAX literal for a value: numbers as-is, strings quoted, dates via DATE()/TIME(), NULL as BLANK()
+    static string ToLiteral(const Value &value);
+
+    // Quote a string as a DAX string literal ("" escapes embedded quotes)
+    static string QuoteString(const string &str);
+
+    // Single column table constructor {a, b, c}
+    static string TableConstructor(const vector<string> &literals);
+
+    // Table expression of a query: the text after a leading EVALUATE, or the text itself
+    static string TableExpression(const string &dax_query);
+
+    // DAX reference for a result column name as reported by the provider:
+    // "Sales Territory[Region]" becomes 'Sales Territory'[Region], "[Total]" stays as is
+    static string ColumnReference(const string &column_name);
+
+    // Whether a table expression is just a (possibly quoted) model table name
+    static bool IsTableName(const string &table_expression);
+
+    // Model table name as given by the user (Sales or 'Internet Sales') as a table expression
+    static string TableReference(const string &table_name);
+
+    // Whether the query is a single EVALUATE without DEFINE/ORDER BY that can be wrapped
+    static bool IsSimpleEvaluate(const string &dax_query);
+};
+
+} // namespace duckdb
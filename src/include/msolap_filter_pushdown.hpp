@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_filter_pushdown.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/planner/table_filter.hpp"
+
+namespace duckdb {
+
+// Default largest IN list (typically the build side keys of a hash join) pushed into DAX
+static constexpr idx_t MSOLAP_DEFAULT_JOIN_KEY_THRESHOLD = 1000;
+
+// Translates the table filters DuckDB hands to the scan (constant predicates and
+// the runtime filters a hash join derives from its build side) into DAX. DAX
+// comparisons are case-insensitive and treat BLANK as 0, so the server may return
+// a superset; every filter is re-checked locally with LocalFilter().
+//
+// In exact mode the translation has to select exactly the rows DuckDB would, for
+// rewrites whose result can't be re-checked (e.g. a COUNTROWS computed on the
+// server): comparisons exclude BLANK and strings are compared with EXACT().
+class MSOLAPFilterPushdown {
+public:
+    MSOLAPFilterPushdown(const vector<string> &column_references, const vector<LogicalType> &types,
+                         idx_t key_threshold, bool exact = false);
+
+    // The session's msolap_join_key_threshold
+    static idx_t KeyThreshold(ClientContext &context);
+
+    // Translate what can be pushed; filters are keyed by their index in column_ids.
+    // In exact mode returns whether every filter was translated.
+    bool AddFilters(const TableFilterSet &filters, const vector<column_t> &column_ids);
+
+    // The query with the translated filters and the extra row predicates applied, or
+    // dax_query unchanged when there are none or the query can't be wrapped. A plain
+    // table gets all of them as arguments of one CALCULATETABLE, which intersects
+    // them; nested CALCULATETABLEs would let a filter replace an outer one on the
+    // same column.
+    string Rewrite(const string &dax_query, const vector<string> &predicates = vector<string>()) const;
+
+    // Descriptions of the pushed filters for EXPLAIN ANALYZE
+    vector<string> pushdowns;
+
+    // Conjunction of all filters over the output chunk, nullptr without filters
+    static unique_ptr<Expression> LocalFilter(const TableFilterSet &filters, const vector<column_t> &column_ids,
+                                              const vector<LogicalType> &types);
+
+private:
+    struct Condition {
+        // Boolean row predicate, usable inside FILTER
+        string predicate;
+        // CALCULATETABLE filter argument, e.g. TREATAS({...}, 'T'[c])
+        string table_filter;
+    };
+
+    bool Translate(const TableFilter &filter, const string &column, const LogicalType &type);
+    static bool CanPushComparison(const LogicalType &type, const Value &constant, ExpressionType comparison);
+    static bool CanPushLiteral(const LogicalType &type, const Value &constant);
+
+    const vector<string> &column_references;
+    const vector<LogicalType> &types;
+    idx_t key_threshold;
+    bool exact;
+    vector<Condition> conditions;
+};
+
+// Re-check of a scan's pushed filters over its output chunks, one per local state
+class MSOLAPLocalFilter {
+public:
+    // filter is the scan's LocalFilter(), nullptr when it has no filters
+    void Initialize(ClientContext &context, const Expression *filter);
+
+    // Keep the rows of output that DuckDB's filters select. Returns false when none
+    // is left, output is reset then.
+    bool Apply(DataChunk &output);
+
+private:
+    unique_ptr<Expression> filter;
+    unique_ptr<ExpressionExecutor> executor;
+    SelectionVector selection;
+};
+
+} // namespace duckdb
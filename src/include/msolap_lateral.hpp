@@ -0,0 +1,43 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_lateral.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_rowset_reader.hpp"
+
+namespace duckdb {
+
+struct MSOLAPLateralBindData : public TableFunctionData {
+    std::string connection_string;
+    // Table expression evaluated once per input key
+    std::string dax_template;
+    // Model column the input keys are applied to, e.g. 'Customer'[CustomerKey]
+    std::string key_column;
+
+    std::vector<std::string> names;
+    std::vector<LogicalType> types;
+
+    // Query sent for one chunk of input keys
+    string BuildQuery(const vector<string> &key_literals) const;
+};
+
+struct MSOLAPLateralLocalState : public LocalTableFunctionState {
+    MSOLAPRowsetReader reader;
+    // Whether the query for the current input chunk is still being drained
+    bool executing = false;
+};
+
+// msolap_lateral((SELECT key FROM ...), conn, dax_template, key_column): evaluates
+// the template for every input key with one round trip per input chunk
+class MSOLAPLateralFunction : public TableFunction {
+public:
+    MSOLAPLateralFunction();
+};
+
+} // namespace duckdb
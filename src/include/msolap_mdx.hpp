@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_mdx.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_cellset.hpp"
+#include "msolap_connection.hpp"
+#include "msolap_query_log.hpp"
+#include "msolap_rowset_reader.hpp"
+
+namespace duckdb {
+
+// An MDX statement executed as a multidimensional dataset (IMDDataset) instead of
+// the provider's flattened rowset emulation. Axis tuples are read once when the
+// statement is executed, cells are fetched by ordinal range with GetCellData.
+// All provider calls run on the worker pool.
+class MSOLAPCellset {
+public:
+    MSOLAPCellset();
+    ~MSOLAPCellset();
+
+    MSOLAPCellset(const MSOLAPCellset &) = delete;
+    MSOLAPCellset &operator=(const MSOLAPCellset &) = delete;
+
+    // Connect, execute and read every axis into layout
+    void Execute(ClientContext &context, const string &connection_string, const string &mdx_query);
+
+    // VALUE of the cells [first, first + count) in ordinal order into cells;
+    // the caller clears the VARIANTs
+    void FetchCells(idx_t first, idx_t count, vector<ColumnData> &cells);
+
+    // Types of the value columns, taken from the first non-empty cell among the
+    // first sample_rows rows (DOUBLE for columns without any)
+    vector<LogicalType> InferValueTypes(idx_t sample_rows);
+
+    // Release everything and record the statement in the query log
+    void Close();
+
+    unique_ptr<MSOLAPCellsetLayout> layout;
+    MSOLAPScanMetrics metrics;
+
+private:
+    void ReadAxes();
+    void Release();
+
+    string connection_string;
+    string mdx_query;
+    string log_file;
+    std::chrono::steady_clock::time_point scan_start;
+    bool logged;
+
+    MSOLAPConnection connection;
+    ICommand* command;
+    IMDDataset* dataset;
+    IAccessor* accessor;
+    HACCESSOR haccessor;
+    MSOLAPQueryWatchdog watchdog;
+};
+
+struct MSOLAPMdxBindData : public TableFunctionData {
+    std::string connection_string;
+    std::string mdx_query;
+
+    std::vector<std::string> names;
+    std::vector<LogicalType> types;
+};
+
+// msolap_mdx(conn, mdx): one row per tuple combination on the non-COLUMNS axes,
+// one column per dimension on those axes plus one value column per COLUMNS tuple
+class MSOLAPMdxFunction : public TableFunction {
+public:
+    MSOLAPMdxFunction();
+};
+
+} // namespace duckdb
@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_multi.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_rowset_reader.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
+
+namespace duckdb {
+
+// Default number of concurrent queries msolap_multi sends to one server
+static constexpr idx_t MSOLAP_MULTI_DEFAULT_MAX_PER_SERVER = 4;
+// Interval at which a scan thread without a source checks for a completed execution
+static constexpr idx_t MSOLAP_MULTI_POLL_MS = 5;
+
+struct MSOLAPMultiSource {
+    string connection_string;
+    string dax_query;
+    // Data Source of the connection string, used to cap per-server concurrency
+    string server;
+};
+
+// Hands out sources to worker threads in order while keeping at most
+// max_per_server of them running against the same server
+class MSOLAPMultiScheduler {
+public:
+    MSOLAPMultiScheduler(const vector<MSOLAPMultiSource> &sources, idx_t max_per_server);
+
+    // Claim the next runnable source; blocks while every remaining source's server
+    // is saturated. Returns false once all sources have been claimed.
+    bool Claim(ClientContext &context, idx_t &source_idx);
+
+    // Claim the next runnable source without waiting; false when every remaining
+    // source's server is saturated or all sources have been claimed
+    bool TryClaim(idx_t &source_idx);
+
+    // Give back the server slot of a finished source
+    void Release(idx_t source_idx);
+
+private:
+    bool TryClaimLocked(idx_t &source_idx);
+
+    const vector<MSOLAPMultiSource> &sources;
+    idx_t max_per_server;
+
+    std::mutex lock;
+    std::condition_variable cv;
+    vector<bool> claimed;
+    idx_t first_unclaimed;
+    std::unordered_map<string, idx_t> active_per_server;
+};
+
+struct MSOLAPMultiBindData : public TableFunctionData {
+    vector<MSOLAPMultiSource> sources;
+    idx_t max_per_server;
+
+    vector<string> names;
+    vector<LogicalType> types;
+};
+
+// Every source is executed as soon as its server has a free slot, independently
+// of the scan threads; a thread streams whichever executing source has its result
+// ready and starts the next sources once it has drained one.
+struct MSOLAPMultiGlobalState : public GlobalTableFunctionState {
+    ClientContext &context;
+    const MSOLAPMultiBindData &bind_data;
+    MSOLAPMultiScheduler scheduler;
+    // Reader of every source, opened when the source is started
+    vector<unique_ptr<MSOLAPRowsetReader>> readers;
+
+    MSOLAPMultiGlobalState(ClientContext &context, const MSOLAPMultiBindData &bind_data);
+    ~MSOLAPMultiGlobalState() override;
+
+    // Open every source whose server has a free slot
+    void StartSources();
+
+    // Hand an executing source to a scan thread, preferring one whose query has
+    // completed. Returns false once every source has been handed out.
+    bool Next(idx_t &source_idx);
+
+    // Close a drained (or abandoned) source and give back its server slot
+    void Finish(idx_t source_idx);
+
+    idx_t MaxThreads() const override {
+        return bind_data.sources.size();
+    }
+
+private:
+    std::mutex lock;
+    // Started sources no thread streams yet, in start order
+    vector<idx_t> started;
+    idx_t handed_out = 0;
+};
+
+struct MSOLAPMultiLocalState : public LocalTableFunctionState {
+    MSOLAPMultiGlobalState &global_state;
+    idx_t source_idx;
+    bool has_source;
+
+    explicit MSOLAPMultiLocalState(MSOLAPMultiGlobalState &global_state)
+        : global_state(global_state), source_idx(0), has_source(false) {}
+
+    ~MSOLAPMultiLocalState() {
+        if (has_source) {
+            global_state.Finish(source_idx);
+        }
+    }
+};
+
+class MSOLAPMultiFunction : public TableFunction {
+public:
+    MSOLAPMultiFunction();
+};
+
+} // namespace duckdb
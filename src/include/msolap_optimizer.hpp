@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_optimizer.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/optimizer/optimizer_extension.hpp"
+
+namespace duckdb {
+
+class LogicalGet;
+struct MSOLAPBindData;
+
+// Plan rewrites that move work on an msolap() or msolap_table() scan into its DAX
+// query, so only the result of that work crosses the wire. Runs after DuckDB's own
+// optimizers: filters and projections are already pushed into the scan. A
+// rewritten query replaces the bind data's dax_query and is listed in its pushdowns.
+class MSOLAPOptimizer {
+public:
+    // Add the rules to the database's optimizer extensions
+    static void Register(DBConfig &config);
+
+    static void Optimize(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan);
+
+    // Bind data of an msolap() or msolap_table() scan whose query can be wrapped,
+    // nullptr otherwise
+    static MSOLAPBindData *GetRewritableScan(LogicalOperator &op);
+
+    // Replace the scan's query; the execution started at bind time and the result
+    // cache entry belong to the original query and are dropped
+    static void RewriteQuery(MSOLAPBindData &bind_data, const string &dax_query, const vector<string> &descriptions);
+
+    // Table expression of the scan's query with its table filters applied. Fails
+    // unless every filter translates exactly: the rewrite's result isn't re-checked.
+    static bool FilteredTable(ClientContext &context, LogicalGet &get, const MSOLAPBindData &bind_data,
+                              string &table, vector<string> &descriptions);
+
+    // Make the scan produce the given result columns (in order) without filters
+    static void ReplaceColumns(LogicalGet &get, MSOLAPBindData &bind_data, const vector<string> &names,
+                               const vector<string> &references, const vector<LogicalType> &types);
+
+private:
+    // USING SAMPLE / TABLESAMPLE directly over a scan becomes DAX SAMPLE
+    static bool PushSample(ClientContext &context, unique_ptr<LogicalOperator> &op);
+    // An ungrouped aggregate of only COUNT(*) and COUNT(DISTINCT column) over a scan
+    // becomes a single row of COUNTROWS / DISTINCTCOUNTNOBLANK
+    static bool PushCount(ClientContext &context, unique_ptr<LogicalOperator> &op);
+    // SELECT DISTINCT and GROUP BY without aggregates over a scan: the scan returns
+    // only the distinct combinations (SUMMARIZE / DISTINCT), DuckDB still dedups them
+    static bool PushDistinct(ClientContext &context, unique_ptr<LogicalOperator> &op);
+    // A constant LIMIT / OFFSET over an unfiltered msolap_table() scan: the scan
+    // returns only the first rows (TOPN), DuckDB still applies the limit
+    static bool PushLimit(ClientContext &context, unique_ptr<LogicalOperator> &op);
+};
+
+} // namespace duckdb
@@ -0,0 +1,40 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_parameters.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+// A named DAX query parameter (referenced as @name in the query text)
+struct MSOLAPParameter {
+    string name;
+    // Normalized to BOOLEAN, BIGINT, DOUBLE, TIMESTAMP or VARCHAR
+    Value value;
+};
+
+// Converts the params := {...} struct into provider parameters. Has no OLE DB
+// dependencies, test/cpp/test_msolap_parameters.cpp runs it against DuckDB alone;
+// binding the values as VARIANTs happens in MSOLAPConnection.
+class MSOLAPParameters {
+public:
+    // Build the parameter list from a STRUCT value; names may be given with or without '@'
+    static vector<MSOLAPParameter> FromStruct(const Value &params);
+
+    // Name as referenced in the query without the leading '@'; throws for empty names
+    static string NormalizeName(const string &name);
+
+    // Cast a value to the type it is sent to the server as
+    static Value NormalizeValue(const string &name, const Value &value);
+
+    // Human readable "@a = 1, @b = 'x'" form for EXPLAIN output
+    static string ToString(const vector<MSOLAPParameter> &parameters);
+};
+
+} // namespace duckdb
@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_query_log.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_server_timings.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace duckdb {
+
+// Number of scans kept in the in-memory query log
+static constexpr idx_t MSOLAP_QUERY_LOG_CAPACITY = 1024;
+
+// Timings and counters of a single msolap scan, plain fields without locking. The
+// open and the fetches update them on pool workers and the scanning thread
+// converts and logs; the future of each pool task orders the two. Read them only
+// after waiting for the task that may still be writing (WaitOpen, the pending fetch).
+struct MSOLAPScanMetrics {
+    timestamp_t start_time;
+    double connect_seconds;
+    double execute_seconds;
+    double first_row_seconds;
+    double fetch_seconds;
+    double convert_seconds;
+    idx_t rows;
+    idx_t bytes;
+    idx_t batches;
+    bool first_row_seen;
+    string status;
+    // Storage / formula engine split reported by the server (server_timings := true)
+    MSOLAPServerTimings server_timings;
+
+    MSOLAPScanMetrics()
+        : start_time(Timestamp::GetCurrentTimestamp()), connect_seconds(0), execute_seconds(0),
+          first_row_seconds(0), fetch_seconds(0), convert_seconds(0), rows(0), bytes(0), batches(0),
+          first_row_seen(false), status("running") {}
+};
+
+struct MSOLAPQueryLogEntry {
+    idx_t query_id;
+    // Data source and catalog only, see MSOLAPConnectionString::Description
+    string connection_string;
+    string dax_query;
+    MSOLAPScanMetrics metrics;
+};
+
+// Bounded ring of the most recent scans. Writers claim a slot with an atomic
+// counter and publish the entry with an atomic shared_ptr store, so recording
+// never blocks on readers of msolap_query_log().
+class MSOLAPQueryLog {
+public:
+    static MSOLAPQueryLog &Get();
+
+    // Record a finished scan; appends a JSON line to log_file when it is not empty
+    void Record(const string &connection_string, const string &dax_query, const MSOLAPScanMetrics &metrics,
+                const string &log_file);
+
+    // Copy of the entries currently in the ring, oldest first
+    std::vector<std::shared_ptr<const MSOLAPQueryLogEntry>> Snapshot() const;
+
+private:
+    MSOLAPQueryLog();
+
+    void AppendToFile(const string &log_file, const MSOLAPQueryLogEntry &entry);
+
+    std::atomic<idx_t> next_query_id;
+    std::vector<std::shared_ptr<const MSOLAPQueryLogEntry>> slots;
+    std::mutex file_lock;
+};
+
+class MSOLAPQueryLogFunction : public TableFunction {
+public:
+    MSOLAPQueryLogFunction();
+};
+
+} // namespace duckdb
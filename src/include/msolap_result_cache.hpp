@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_result_cache.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/main/appender.hpp"
+#include <mutex>
+#include <unordered_map>
+
+namespace duckdb {
+
+// Default upper bound for the total size of cached result files (4 GB)
+static constexpr idx_t MSOLAP_DEFAULT_CACHE_SIZE_LIMIT = 4ULL * 1024ULL * 1024ULL * 1024ULL;
+
+// One cached result, stored as <key>.parquet in the cache directory
+struct MSOLAPCacheEntry {
+    string key;
+    string data_source;
+    string dax_query;
+    // Refresh state of the model when the result was read, empty for a pin without data
+    string refresh;
+    idx_t rows = 0;
+    idx_t bytes = 0;
+    timestamp_t last_used;
+    // Pinned entries are never evicted to make room
+    bool pinned = false;
+};
+
+// Opt-in persistent cache of msolap() results (msolap_cache_directory). Entries are
+// keyed by a hash of connection string and DAX text and only served while the
+// model's refresh state, read with one MDSCHEMA_CUBES query, is unchanged. The
+// total size is kept under msolap_cache_size_limit by evicting the least recently
+// used unpinned entries. The index is a small text file next to the results.
+class MSOLAPResultCache {
+public:
+    static MSOLAPResultCache &Get();
+
+    // Cache directory from the settings, false when caching is off
+    static bool GetDirectory(ClientContext &context, string &directory);
+
+    // Stable key of a (connection string, DAX query) pair
+    static string Key(const string &connection_string, const string &dax_query);
+
+    // Refresh state of the model behind a connection string (one metadata query)
+    static string GetRefreshState(ClientContext &context, const string &connection_string);
+
+    // Path of a valid cached result, marked as used; empty when there is none. On a
+    // miss the model's refresh state is kept for the scan that stores the result.
+    string Lookup(ClientContext &context, const string &directory, const string &connection_string,
+                  const string &dax_query);
+
+    // Refresh state read by the last missed Lookup of key
+    bool TakeRefreshState(const string &key, string &refresh);
+
+    // Register a result file written to path, then evict down to the size limit
+    void Insert(ClientContext &context, const string &directory, MSOLAPCacheEntry entry, const string &path);
+
+    // Pin or unpin a query, also before it is cached; returns whether it was cached
+    bool SetPinned(ClientContext &context, const string &directory, const string &connection_string,
+                   const string &dax_query, bool pinned);
+
+    // Copy of all entries
+    vector<MSOLAPCacheEntry> Entries(ClientContext &context, const string &directory);
+
+    static string ResultPath(FileSystem &fs, const string &directory, const string &key);
+
+private:
+    // Load the index of directory if another one (or none) is loaded
+    void LoadIndex(FileSystem &fs, const string &directory);
+    void SaveIndex(FileSystem &fs);
+    void Evict(FileSystem &fs, idx_t size_limit);
+
+    std::mutex lock;
+    string loaded_directory;
+    std::unordered_map<string, MSOLAPCacheEntry> entries;
+    std::unordered_map<string, string> pending_refresh;
+};
+
+// Collects the rows of a cache miss in a temporary table and writes them to the
+// cache directory as Parquet once the scan has read the whole result. Dropped
+// without a trace when the scan stops early or fails.
+class MSOLAPCacheWriter {
+public:
+    MSOLAPCacheWriter(ClientContext &context, string directory, MSOLAPCacheEntry entry, const vector<string> &names,
+                      const vector<LogicalType> &types);
+    ~MSOLAPCacheWriter();
+
+    void Append(DataChunk &chunk);
+
+    // Write the result file and register it; errors are swallowed
+    void Commit();
+
+private:
+    ClientContext &context;
+    string directory;
+    MSOLAPCacheEntry entry;
+    string table_name;
+    unique_ptr<Connection> connection;
+    unique_ptr<Appender> appender;
+};
+
+class MSOLAPCacheFunction : public TableFunction {
+public:
+    MSOLAPCacheFunction();
+};
+
+// msolap_cache_pin(conn, dax) / msolap_cache_unpin(conn, dax)
+ScalarFunction MSOLAPCachePinFunction(bool pin);
+
+} // namespace duckdb
@@ -0,0 +1,292 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_rowset_reader.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_utils.hpp"
+#include "msolap_connection.hpp"
+#include "msolap_query_log.hpp"
+#include "msolap_parameters.hpp"
+#include "msolap_session.hpp"
+#include "msolap_server_trace.hpp"
+#include "msolap_watchdog.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace duckdb {
+
+// Default memory budget for a single GetNextRows batch (64 MB)
+static constexpr idx_t MSOLAP_DEFAULT_FETCH_MEMORY_LIMIT = 64ULL * 1024ULL * 1024ULL;
+// Share of DuckDB's memory_limit in use above which scans shrink their batches
+static constexpr double MSOLAP_MEMORY_PRESSURE_RATIO = 0.9;
+// Smallest batch a scan shrinks to under memory pressure
+static constexpr idx_t MSOLAP_MIN_FETCH_SIZE = 16;
+
+// Adaptive sizing of the cRows argument passed to IRowset::GetNextRows.
+// The batch size doubles while rows/second keeps improving and is capped so
+// that the HROW array plus the provider's row cache stay within a memory budget.
+struct MSOLAPFetchSizer {
+    idx_t current_size;
+    idx_t max_size;
+    double best_throughput;
+    bool growing;
+
+    // Largest size requested so far, surfaced through the scan's profiling info
+    idx_t largest_size;
+    // Number of times the size was cut because of memory pressure
+    idx_t throttled;
+
+    MSOLAPFetchSizer() : current_size(STANDARD_VECTOR_SIZE), max_size(STANDARD_VECTOR_SIZE),
+                         best_throughput(0), growing(true), largest_size(0), throttled(0) {}
+
+    // Set the starting batch size and derive the cap from the memory budget
+    void Initialize(idx_t initial_size, idx_t memory_limit, idx_t bytes_per_row);
+
+    // Record a completed GetNextRows call and pick the size for the next one
+    void Update(idx_t rows_obtained, double elapsed_seconds);
+
+    // Halve the size and stop growing; false once MSOLAP_MIN_FETCH_SIZE is reached
+    bool Shrink();
+};
+
+// Watches a running command from a helper thread and calls ICommand::Cancel when
+// DuckDB interrupts the query or the client-side msolap_query_timeout expires.
+// Execute and GetNextRows block the scanning thread, so the cancel has to come
+// from somewhere else (see MSOLAPWatchdog).
+class MSOLAPQueryWatchdog {
+public:
+    MSOLAPQueryWatchdog() : command(nullptr) {}
+
+    // Start watching a command; timeout_ms of 0 disables the client-side timeout
+    void Start(ICommand *command, ClientContext &context, idx_t timeout_ms);
+
+    // Stop the helper thread, the command is no longer touched afterwards
+    void Stop() {
+        watchdog.Stop();
+    }
+
+    // Cancel the command right away (early teardown)
+    void Cancel() {
+        watchdog.Cancel();
+    }
+
+    bool Interrupted() const {
+        return watchdog.Interrupted();
+    }
+    bool TimedOut() const {
+        return watchdog.TimedOut();
+    }
+
+    // Throw the appropriate error if the command was cancelled by the watchdog
+    void CheckCancelled() const;
+
+private:
+    ICommand *command;
+    MSOLAPWatchdog watchdog;
+};
+
+// Rows copied out of the provider by one fetch request: row_size bytes per row in
+// the bound ColumnData layout, VARIANTs owned until converted or cleared. The
+// buffer comes from DuckDB's buffer manager and counts against memory_limit.
+struct MSOLAPRowBatch {
+    BufferHandle buffer;
+    BYTE* data = nullptr;
+    idx_t capacity = 0;
+    idx_t row_count = 0;
+    idx_t position = 0;
+    bool end_of_rowset = false;
+};
+
+// Executes one DAX query and streams its rowset into DataChunks. Owns the
+// connection, command, accessor and the reusable fetch buffers, and records the
+// scan's telemetry into msolap_query_log() when it is closed.
+//
+// All provider calls but ICommand::Cancel run on MSOLAPConnection::WorkerPool();
+// the closing thread and the watchdog cancel directly, since a cancel queued on a
+// busy pool would wait for the Execute or fetch it interrupts. Open only queues the
+// connect and execute there, so the server starts working while the caller goes
+// on. While Read converts one batch on the DuckDB thread the pool already fetches
+// the next one.
+class MSOLAPRowsetReader {
+public:
+    MSOLAPRowsetReader();
+    ~MSOLAPRowsetReader();
+
+    MSOLAPRowsetReader(const MSOLAPRowsetReader &) = delete;
+    MSOLAPRowsetReader &operator=(const MSOLAPRowsetReader &) = delete;
+
+    // Start connecting, executing the query and binding the projected result
+    // columns on the worker pool, followed by the first fetch. Returns right away,
+    // errors surface from WaitOpen or Read. Parameterized queries run as prepared
+    // commands on a pooled session of the client. See Project for projection.
+    void Open(ClientContext &context, const string &connection_string, const string &dax_query,
+              const vector<MSOLAPParameter> &parameters = vector<MSOLAPParameter>(),
+              const vector<idx_t> &projection = vector<idx_t>());
+
+    // Bind only the projected result columns from the next fetch on; must be called
+    // before the first Read. projection[k] is the result column Read writes to
+    // output column k, DConstants::INVALID_INDEX makes output column k a NULL
+    // constant (a virtual column such as the row id of COUNT(*)) and an empty
+    // projection binds every column. Columns that aren't bound are
+    // never materialized by GetData.
+    void Project(const vector<idx_t> &projection);
+
+    // Read a rowset executed by someone else (one result of an IMultipleResults
+    // batch), taking ownership of it. Like Open, but without a command of its own
+    // and without a query log entry; the owner of the batch records the round trip.
+    void Attach(ClientContext &context, IRowset *rowset, const string &connection_string, const string &dax_query);
+
+    // Block until the query is executing and names/types/references are set
+    void WaitOpen();
+
+    // Kinds of the values in the first batch for the flagged columns, without
+    // consuming it. Waits for the first fetch; EMPTY for unflagged or blank columns.
+    vector<MSOLAPValueKind> SampleValueKinds(const vector<bool> &columns);
+
+    // Convert up to STANDARD_VECTOR_SIZE rows into output columns starting at column_offset.
+    // Returns the number of rows written, 0 once the rowset is exhausted.
+    idx_t Read(DataChunk &output, idx_t column_offset = 0);
+
+    // Cancel the command if it was not drained, release everything and log the scan
+    void Close();
+
+    bool Finished() const {
+        return done;
+    }
+
+    // Whether the open started by Open has completed (executed or failed), waiting
+    // up to wait_ms for it
+    bool Opened(idx_t wait_ms = 0) const {
+        return opened.valid() &&
+               opened.wait_for(std::chrono::milliseconds(wait_ms)) == std::future_status::ready;
+    }
+
+    // Connect and execute a query only to learn its result schema
+    static void Describe(ClientContext &context, const string &connection_string, const string &dax_query,
+                         vector<string> &names, vector<LogicalType> &types,
+                         const vector<MSOLAPParameter> &parameters = vector<MSOLAPParameter>(),
+                         vector<string> *references = nullptr, vector<bool> *variants = nullptr);
+
+    // Describe a model table expression through a query that returns no rows, so the
+    // server doesn't evaluate the table
+    static void DescribeTable(ClientContext &context, const string &connection_string,
+                              const string &table_expression, vector<string> &names, vector<LogicalType> &types,
+                              vector<string> *references = nullptr);
+
+    // Client-side timeout in milliseconds, 0 when disabled
+    static idx_t GetQueryTimeout(ClientContext &context);
+
+public:
+    string connection_string;
+    // The DAX text actually sent to the server
+    string dax_query;
+
+    // Result schema, set once the query is executing
+    vector<string> names;
+    vector<LogicalType> types;
+    vector<string> references;
+    // Which columns the provider reports as DBTYPE_VARIANT
+    vector<bool> variant_columns;
+
+    // Kind each column was inferred as, checked for every value Read converts so
+    // a later value that doesn't fit fails instead of being truncated. Empty or
+    // EMPTY for columns without inferred type.
+    vector<MSOLAPValueKind> column_kinds;
+
+    // Trace the execution on the server and record its storage / formula engine
+    // timings in metrics.server_timings; set before Open
+    bool server_timings;
+
+    MSOLAPFetchSizer fetch_sizer;
+    MSOLAPScanMetrics metrics;
+
+    // Whether a pooled session / an already prepared command was used
+    bool session_reused;
+    bool command_reused;
+
+private:
+    // Connect (or borrow a pooled session) and execute the query
+    void Execute(ClientContext &context, const vector<MSOLAPParameter> &parameters);
+    // Execute and bind every result column (runs on the worker pool)
+    void OpenRowset(ClientContext &context, const vector<MSOLAPParameter> &parameters);
+    // Fetch rows and copy them into batch (runs on the worker pool)
+    void FetchBatch(MSOLAPRowBatch &batch);
+    // Queue the fetch of next_batch on the worker pool
+    void StartFetch();
+    // Wait for the queued fetch and make it the current batch
+    void TakeBatch();
+    // Size the next fetch and make sure batch can hold it, shrinking under memory pressure
+    void ReserveBatch(MSOLAPRowBatch &batch);
+    // Bind the projected columns and create the accessor (runs on the worker pool)
+    void CreateAccessor();
+    // Move rows fetched with the bound columns old_bound into the current layout
+    void CompactBatch(MSOLAPRowBatch &batch, const vector<idx_t> &old_bound, DWORD old_row_size);
+    // Free the VARIANTs of rows that were fetched but never converted
+    void ClearBatch(MSOLAPRowBatch &batch);
+    // Convert one value to the output column's type, throwing a descriptive error if it doesn't fit
+    Value ConvertValue(idx_t col, VARIANT &var, const LogicalType &type);
+    // Release all provider objects (runs on the worker pool)
+    void ReleaseRowset();
+    // Record the scan in the query log, once
+    void LogQuery();
+
+    MSOLAPConnection connection;
+    // Pooled session used instead of connection for parameterized queries
+    unique_ptr<MSOLAPSession> session;
+    MSOLAPSessionCache* session_cache;
+    ICommand* command;
+    IRowset* rowset;
+    IAccessor* accessor;
+    HACCESSOR haccessor;
+    DBBINDING* bindings;
+    // Ordinal of every result column
+    vector<DBORDINAL> ordinals;
+    // Requested projection, and for every accessor slot the result column bound
+    // there (ascending) and the output column it is written to
+    vector<idx_t> projection;
+    vector<idx_t> bound_columns;
+    vector<idx_t> output_columns;
+    // Number of bound columns
+    DBORDINAL column_count;
+    DWORD row_size;
+    bool done;
+
+    // Scan buffers are allocated here so they show up in duckdb_memory()
+    BufferManager* buffer_manager;
+    // Reusable HROW array, only touched by FetchBatch
+    BufferHandle row_handles_buffer;
+    HROW* row_handles;
+    idx_t row_handles_capacity;
+    // Batch being converted and the one the pool is filling in the meantime
+    MSOLAPRowBatch current_batch;
+    MSOLAPRowBatch next_batch;
+    // Completes with the first fetch, so it also carries the open
+    std::future<void> pending_fetch;
+    std::promise<void> open_promise;
+    std::shared_future<void> opened;
+    bool end_of_rowset;
+
+    // Close can run while the pool is still executing the command
+    std::mutex execute_lock;
+    bool close_requested;
+
+    MSOLAPQueryWatchdog watchdog;
+    // Server trace of a server_timings scan, null when tracing is off or failed
+    unique_ptr<MSOLAPServerTrace> trace;
+    std::chrono::steady_clock::time_point scan_start;
+    string log_file;
+    bool logged;
+};
+
+} // namespace duckdb
@@ -11,60 +11,77 @@
 #include "duckdb.hpp"
 #include "msolap_utils.hpp"
 #include "msolap_connection.hpp"
+#include "msolap_rowset_reader.hpp"
+#include "msolap_result_cache.hpp"
+#include "msolap_filter_pushdown.hpp"
+#include "duckdb/execution/expression_executor.hpp"
 #include <memory>
+#include <mutex>
 
 namespace duckdb {
 
 struct MSOLAPBindData : public TableFunctionData {
     std::string connection_string;
     std::string dax_query;
+    // Named parameters bound to @name references in dax_query
+    vector<MSOLAPParameter> parameters;
     
     std::vector<std::string> names;
     std::vector<LogicalType> types;
+    // Column names as reported by the provider (e.g. Sales[Amount]), used to reference them in DAX
+    std::vector<std::string> column_references;
+    // Kinds the DBTYPE_VARIANT columns were typed as from the first batch, EMPTY
+    // for the other columns; every scanned value is checked against them
+    std::vector<MSOLAPValueKind> column_kinds;
+    // columns := {...} gave the schema, the server was not contacted at bind time
+    bool declared_schema = false;
+    // server_timings := true, trace the query on the server (see MSOLAPServerTrace)
+    bool server_timings = false;
+
+    // Rewrites applied to dax_query by pushdown, reported in EXPLAIN ANALYZE
+    std::vector<std::string> pushdowns;
+
+    // The execution started at bind is handed to the first scan of the unchanged
+    // query instead of executing it again. Bind waits for it to learn the schema,
+    // except when the columns are declared.
+    mutable std::mutex bind_reader_lock;
+    mutable unique_ptr<MSOLAPRowsetReader> bind_reader;
+
+    // Set when a cache miss should store the result (msolap_cache_directory)
+    std::string cache_directory;
+    MSOLAPCacheEntry cache_entry;
+
+    unique_ptr<MSOLAPRowsetReader> TakeBindReader() const {
+        std::lock_guard<std::mutex> guard(bind_reader_lock);
+        return std::move(bind_reader);
+    }
 };
 
 struct MSOLAPLocalState : public LocalTableFunctionState {
-    MSOLAPConnection connection;
-    IRowset* rowset;
-    IAccessor* accessor;
-    HACCESSOR haccessor;
-    DBBINDING* bindings;
-    BYTE* row_data;
-    DWORD row_size;
-    bool done;
-    
-    MSOLAPLocalState() : rowset(nullptr), accessor(nullptr), haccessor(NULL), 
-                        bindings(nullptr), row_data(nullptr), row_size(0), done(false) {}
-    
-    ~MSOLAPLocalState() {
-        // Clean up resources
-        if (row_data) {
-            delete[] row_data;
-            row_data = nullptr;
-        }
-        
-        if (bindings) {
-            CoTaskMemFree(bindings);
-            bindings = nullptr;
-        }
-        
-        if (accessor && haccessor) {
-            accessor->ReleaseAccessor(haccessor, NULL);
-            haccessor = NULL;
-        }
-        
-        if (accessor) {
-            MSOLAPUtils::SafeRelease(&accessor);
-        }
-        
-        if (rowset) {
-            MSOLAPUtils::SafeRelease(&rowset);
-        }
-    }
+    unique_ptr<MSOLAPRowsetReader> reader;
+    // Whether the reader is the execution started at bind time
+    bool executed_at_bind = false;
+    // Copies the complete result into the result cache
+    unique_ptr<MSOLAPCacheWriter> cache_writer;
+    // Every result column, read for the cache when the scan projects none of them
+    DataChunk cache_chunk;
+    // Re-check of the pushed filters
+    MSOLAPLocalFilter filter;
 };
 
 struct MSOLAPGlobalState : public GlobalTableFunctionState {
     idx_t max_threads;
+    // dax_query with the scan's filters and runtime join keys applied
+    std::string dax_query;
+    std::vector<std::string> pushdowns;
+    unique_ptr<Expression> filter;
+    // Result column of every output column (input.column_ids), INVALID_INDEX for
+    // virtual columns; full_projection when that is every column in order
+    std::vector<idx_t> projection;
+    bool full_projection = true;
+    // Bind-time execution of dax_query, taken by the (single) local state
+    std::mutex reader_lock;
+    unique_ptr<MSOLAPRowsetReader> reader;
     
     explicit MSOLAPGlobalState(idx_t max_threads) : max_threads(max_threads) {}
     
@@ -78,4 +95,4 @@ public:
     MSOLAPScanFunction();
 };
 
-} // namespace duckdb
\ No newline at end of file
+} // namespace duckdb
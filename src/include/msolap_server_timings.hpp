@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_server_timings.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace duckdb {
+
+// Trace events the server timings are computed from
+enum class MSOLAPTraceEventClass : uint8_t { OTHER, QUERY_END, VERTIPAQ_SE_QUERY_END, VERTIPAQ_SE_QUERY_CACHE_MATCH };
+
+// Event subclass of storage engine queries the engine issues for itself
+static constexpr int64_t MSOLAP_TRACE_SUBCLASS_INTERNAL = 10;
+
+// One event of a server trace, as delivered by a Subscribe rowset or recorded from one
+struct MSOLAPTraceEvent {
+    MSOLAPTraceEventClass event_class = MSOLAPTraceEventClass::OTHER;
+    int64_t subclass = 0;
+    // Milliseconds since the epoch, -1 when the event has no StartTime
+    int64_t start_ms = -1;
+    int64_t duration_ms = 0;
+    int64_t cpu_ms = 0;
+    std::string text;
+    // Shared by all events of one request, empty on servers that don't report it
+    std::string request_id;
+};
+
+// Where the server spent the time of one query: the QueryEnd duration split into
+// storage engine (VertiPaq scans, overlapping scans counted once) and formula
+// engine (the rest).
+struct MSOLAPServerTimings {
+    // Whether the QueryEnd of the query was seen
+    bool captured = false;
+    double total_ms = 0;
+    double se_ms = 0;
+    double fe_ms = 0;
+    double se_cpu_ms = 0;
+    int64_t se_queries = 0;
+    int64_t se_cache_hits = 0;
+    // Why there are no timings (no permission to trace, QueryEnd never arrived)
+    std::string error;
+
+    // Aggregate the events of the query whose text contains marker (the first
+    // QueryEnd when marker is empty). Storage engine events belong to it when they
+    // carry its RequestID, or without RequestIDs when they start within it.
+    static MSOLAPServerTimings Compute(const std::vector<MSOLAPTraceEvent> &events, const std::string &marker);
+};
+
+// Turns trace rows into events. Columns are matched by name (EventClass, Duration,
+// ...), so the Subscribe rowset of the provider and an XMLA rowset recorded from
+// a trace go through the same code.
+struct MSOLAPTraceParser {
+    // Event from the (column name, value) pairs of one row
+    static MSOLAPTraceEvent FromColumns(const std::vector<std::pair<std::string, std::string>> &columns);
+
+    // Event class from its number ("83") or name ("VertiPaqSEQueryEnd", "VertiPaq SE Query End")
+    static MSOLAPTraceEventClass ParseEventClass(const std::string &value);
+
+    // "2024-05-01T10:00:00.123" (or with a space) as milliseconds since the epoch, -1 if malformed
+    static int64_t ParseTimestamp(const std::string &value);
+
+    // Events of every <row> of an XMLA rowset payload
+    static std::vector<MSOLAPTraceEvent> ParseRowsetXml(const std::string &xml);
+};
+
+} // namespace duckdb
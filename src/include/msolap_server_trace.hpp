@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_server_trace.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_connection.hpp"
+#include "msolap_server_timings.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace duckdb {
+
+// How long Finish waits for the QueryEnd event after the rows were read
+static constexpr idx_t MSOLAP_TRACE_FINISH_TIMEOUT_MS = 2000;
+// How long Start waits for the Subscribe command to come back before the query runs
+static constexpr idx_t MSOLAP_TRACE_SUBSCRIBE_TIMEOUT_MS = 1000;
+
+// Server trace of QueryEnd, VertiPaqSEQueryEnd and VertiPaqSEQueryCacheMatch events
+// around one query (msolap(..., server_timings := true)). Start creates the trace
+// with an XMLA Create command and subscribes to it from a helper thread, because
+// the Subscribe rowset blocks in GetNextRows until events arrive; the pool must
+// not lose a worker to it. The query is recognized among the events of other
+// sessions by Marker(), a DAX comment the reader puts in front of its text.
+//
+// Tracing needs administrator rights on the database; without them Start fails
+// and the scan runs untraced.
+class MSOLAPServerTrace {
+public:
+    MSOLAPServerTrace();
+    ~MSOLAPServerTrace();
+
+    MSOLAPServerTrace(const MSOLAPServerTrace &) = delete;
+    MSOLAPServerTrace &operator=(const MSOLAPServerTrace &) = delete;
+
+    // Create the trace and wait until the subscription delivers events. Runs on a
+    // thread with COM initialized (the worker pool).
+    void Start(const string &connection_string);
+
+    // Comment line to put in front of the traced query
+    string Marker() const;
+
+    // Wait up to timeout_ms for the QueryEnd of the marked query, delete the trace
+    // and aggregate what arrived. Idempotent, later calls return the same timings.
+    MSOLAPServerTimings Finish(idx_t timeout_ms);
+
+private:
+    // Create the trace, with or without the RequestID column
+    void Create(bool request_ids);
+    // Helper thread: subscribe and collect events until the trace is deleted
+    void Run(const string &connection_string);
+    // Delete the trace, which ends the subscription (runs on the worker pool)
+    void Delete();
+
+    string trace_id;
+    // Text of the marker comment, searched for in the QueryEnd events
+    string tag;
+    // Connection that creates and deletes the trace
+    MSOLAPConnection control;
+    bool created;
+
+    std::thread thread;
+    std::mutex lock;
+    std::condition_variable cv;
+    bool subscribed;
+    bool ended;
+    bool query_end_seen;
+    string error;
+    vector<MSOLAPTraceEvent> events;
+    // Subscribe command, cancelled to unblock the helper thread
+    ICommand *subscription;
+
+    bool finished;
+    MSOLAPServerTimings timings;
+};
+
+} // namespace duckdb
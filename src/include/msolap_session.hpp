@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_session.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/main/client_context_state.hpp"
+#include "msolap_connection.hpp"
+#include <mutex>
+#include <unordered_map>
+
+namespace duckdb {
+
+// Maximum number of prepared commands kept per server session
+static constexpr idx_t MSOLAP_PREPARED_COMMAND_CACHE_SIZE = 64;
+
+// An open server session plus the commands already prepared on it, keyed by
+// query text. Only one scan uses a session at a time.
+class MSOLAPSession {
+public:
+    explicit MSOLAPSession(MSOLAPConnection connection);
+    ~MSOLAPSession();
+
+    // Prepared command for the query text; prepares a new one on a cache miss
+    ICommand* GetPreparedCommand(const string &dax_query, bool &reused);
+
+    // Hand a command obtained from GetPreparedCommand back for later executions
+    void ReturnPreparedCommand(const string &dax_query, ICommand *command);
+
+    MSOLAPConnection connection;
+
+private:
+    std::unordered_map<string, ICommand*> prepared_commands;
+};
+
+// Per DuckDB client pool of idle MSOLAP sessions, keyed by connection string
+class MSOLAPSessionCache : public ClientContextState {
+public:
+    ~MSOLAPSessionCache() override;
+
+    static MSOLAPSessionCache &Get(ClientContext &context);
+
+    // Take an idle session for the connection string or connect a new one
+    unique_ptr<MSOLAPSession> Acquire(const string &connection_string, bool &reused);
+
+    // Put a session back into the pool once its scan is done with it
+    void Release(const string &connection_string, unique_ptr<MSOLAPSession> session);
+
+private:
+    std::mutex lock;
+    std::unordered_map<string, vector<unique_ptr<MSOLAPSession>>> idle_sessions;
+};
+
+} // namespace duckdb
@@ -0,0 +1,39 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_sync.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+// Table every sync run is recorded in; the last successful run per target also
+// holds the high watermark the next run continues from
+static constexpr const char *MSOLAP_SYNC_LOG_TABLE = "msolap_sync_log";
+
+struct MSOLAPSyncBindData : public TableFunctionData {
+    std::string connection_string;
+    // Model table as given, e.g. Sales or 'Internet Sales'
+    std::string table;
+    // Local table the rows are appended to, created on the first run
+    std::string target;
+    // Model column, e.g. Sales[ModifiedDate]
+    std::string watermark;
+    // Watermark units (days for date/time columns) re-pulled for late-arriving rows
+    int64_t lookback = 0;
+};
+
+// msolap_sync(conn, 'Table', target := 'local_table', watermark := 'Table[ModifiedDate]'
+//             [, lookback := N]): appends the rows of a model table beyond the last
+// synced watermark to a local table and returns a summary of the run
+class MSOLAPSyncFunction : public TableFunction {
+public:
+    MSOLAPSyncFunction();
+};
+
+} // namespace duckdb
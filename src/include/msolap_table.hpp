@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_table.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_scanner.hpp"
+#include <atomic>
+
+namespace duckdb {
+
+// Rows a partition of a parallel msolap_table scan should hold at least
+static constexpr idx_t MSOLAP_TABLE_PARTITION_ROWS = 1000000;
+// Default number of partitions (concurrent queries) of one msolap_table scan
+static constexpr idx_t MSOLAP_TABLE_DEFAULT_MAX_THREADS = 4;
+
+// dax_query is "EVALUATE <table>" until a plan rewrite (MSOLAPOptimizer) replaces
+// it; every scan generates its own query from it
+struct MSOLAPTableBindData : public MSOLAPBindData {
+    // Model table as given, e.g. Sales or 'Internet Sales'
+    std::string table_name;
+    // Rows of the table (COUNTROWS at bind time)
+    idx_t cardinality = 0;
+    // Integer column the table is split on for parallel scans, INVALID_INDEX if none
+    idx_t partition_column = DConstants::INVALID_INDEX;
+    int64_t partition_min = 0;
+    int64_t partition_max = 0;
+    idx_t max_threads = MSOLAP_TABLE_DEFAULT_MAX_THREADS;
+
+    // Whether scans can be split: the table has an integer key and its query wasn't
+    // replaced by a plan rewrite
+    bool Partitionable() const;
+
+    // The query of one scan: the projected result columns of the rows of the
+    // filtered table (CALCULATETABLE arguments or a FILTER predicate)
+    string BuildQuery(const vector<idx_t> &columns, const string &filtered_table) const;
+
+    // Predicate selecting partition index of count, by ranges of the partition
+    // column; the first one also holds the rows where it is BLANK
+    string PartitionFilter(idx_t index, idx_t count) const;
+};
+
+struct MSOLAPTableGlobalState : public GlobalTableFunctionState {
+    // One query per partition, claimed by the local states in order
+    vector<string> queries;
+    std::atomic<idx_t> next_query;
+    // Result column of every output column, INVALID_INDEX for virtual columns
+    vector<idx_t> projection;
+    vector<string> pushdowns;
+    unique_ptr<Expression> filter;
+
+    MSOLAPTableGlobalState() : next_query(0) {}
+
+    idx_t MaxThreads() const override {
+        return queries.size();
+    }
+};
+
+struct MSOLAPTableLocalState : public LocalTableFunctionState {
+    // Reader of the partition being scanned, or of the last one once it drained
+    unique_ptr<MSOLAPRowsetReader> reader;
+    bool scanning = false;
+    // Partitions, rows and bytes this thread has scanned, for EXPLAIN ANALYZE
+    idx_t partitions = 0;
+    idx_t rows = 0;
+    idx_t bytes = 0;
+    // Re-check of the pushed filters
+    MSOLAPLocalFilter filter;
+};
+
+// msolap_table(conn, 'Table' [, partition_column := 'Table[Key]'] [, max_threads := N]):
+// scans a model table without hand-written DAX. The schema comes from the model;
+// each scan sends only the columns DuckDB reads (SELECTCOLUMNS) and the pushed
+// filters (CALCULATETABLE), and large tables are split into ranges of an integer
+// key scanned by concurrent queries.
+class MSOLAPTableFunction : public TableFunction {
+public:
+    MSOLAPTableFunction();
+};
+
+} // namespace duckdb
@@ -0,0 +1,53 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_type_inference.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+namespace duckdb {
+
+// What a single DBTYPE_VARIANT value holds, ordered within each family from
+// narrow to wide. Maps to BOOLEAN, BIGINT, DECIMAL(38,4), DOUBLE, DATE,
+// TIMESTAMP and VARCHAR columns.
+enum class MSOLAPValueKind : uint8_t {
+    // Blank, fits any column
+    EMPTY,
+    BOOLEAN,
+    INTEGER,
+    // Currency or fixed decimal with at most 4 digits after the point
+    DECIMAL,
+    DOUBLE,
+    // Date without a time of day
+    DATE,
+    TIMESTAMP,
+    STRING
+};
+
+// Types DBTYPE_VARIANT result columns (measures, ADDCOLUMNS expressions) from the
+// values they hold. The narrowest kind that holds both: numbers widen INTEGER ->
+// DECIMAL -> DOUBLE, dates to TIMESTAMP, and anything mixed across families is a
+// STRING.
+struct MSOLAPTypeInference {
+    static MSOLAPValueKind Combine(MSOLAPValueKind left, MSOLAPValueKind right);
+
+    // Whether a value of kind value can be stored in a column typed as column
+    static bool Fits(MSOLAPValueKind column, MSOLAPValueKind value) {
+        return Combine(column, value) == column;
+    }
+
+    // Kind of the column after sampling, blank columns stay strings
+    static MSOLAPValueKind Finalize(MSOLAPValueKind kind) {
+        return kind == MSOLAPValueKind::EMPTY ? MSOLAPValueKind::STRING : kind;
+    }
+
+    // SQL name of the column type of a kind, for error messages
+    static const char *TypeName(MSOLAPValueKind kind);
+};
+
+} // namespace duckdb
@@ -14,6 +14,7 @@
 #include <oledberr.h>
 #include <comdef.h>
 #include "duckdb/common/windows_util.hpp"
+#include "msolap_type_inference.hpp"
 
 namespace duckdb {
 
@@ -25,9 +26,18 @@ public:
     
     // Convert VARIANT to DuckDB Value
     static Value ConvertVariantToValue(VARIANT* pVar);
+
+    // Convert a normalized parameter Value (see MSOLAPParameters) to a VARIANT
+    static void ConvertValueToVariant(const Value &value, VARIANT* pVar);
     
     // Get DuckDB LogicalType from DBTYPE
     static LogicalType GetLogicalTypeFromDBTYPE(DBTYPE type);
+
+    // What a VARIANT holds, for typing DBTYPE_VARIANT columns
+    static MSOLAPValueKind GetVariantKind(const VARIANT &var);
+
+    // Column type of an inferred kind
+    static LogicalType GetLogicalTypeFromValueKind(MSOLAPValueKind kind);
     
     // Get error message from HRESULT
     static std::string GetErrorMessage(HRESULT hr);
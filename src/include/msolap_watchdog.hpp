@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_watchdog.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace duckdb {
+
+// Interval at which the watchdog checks for an interrupt or an expired timeout,
+// the upper bound of how late a cancel can come
+static constexpr uint64_t MSOLAP_WATCHDOG_POLL_MS = 50;
+
+// Calls a cancel function once from a helper thread when an interrupt flag is
+// raised or a timeout expires. The blocking call being watched runs on another
+// thread and can't check either itself. MSOLAPQueryWatchdog uses it to cancel
+// ICommands.
+class MSOLAPWatchdog {
+public:
+    MSOLAPWatchdog();
+    ~MSOLAPWatchdog();
+
+    MSOLAPWatchdog(const MSOLAPWatchdog &) = delete;
+    MSOLAPWatchdog &operator=(const MSOLAPWatchdog &) = delete;
+
+    // Start watching; timeout_ms of 0 disables the timeout. interrupted has to
+    // outlive the watch (until Stop).
+    void Start(std::function<void()> cancel, const std::atomic<bool> &interrupted, uint64_t timeout_ms);
+
+    // Stop the helper thread, cancel is no longer called afterwards
+    void Stop();
+
+    // Call cancel right away unless it was called already (early teardown)
+    void Cancel();
+
+    bool Interrupted() const {
+        return interrupted;
+    }
+    bool TimedOut() const {
+        return timed_out;
+    }
+    uint64_t TimeoutMs() const {
+        return timeout_ms;
+    }
+
+private:
+    void Run();
+
+    std::function<void()> cancel;
+    const std::atomic<bool> *interrupt_flag;
+    uint64_t timeout_ms;
+    std::chrono::steady_clock::time_point deadline;
+
+    std::thread thread;
+    std::mutex lock;
+    std::condition_variable cv;
+    bool stopping;
+    std::atomic<bool> cancelled;
+    std::atomic<bool> interrupted;
+    std::atomic<bool> timed_out;
+};
+
+} // namespace duckdb
@@ -0,0 +1,173 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_worker_pool.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace duckdb {
+
+// Bounded multi-producer/multi-consumer queue. Every cell carries a sequence
+// number telling producers and consumers whose turn it is, so pushing and
+// popping is a single CAS on the respective position without any lock.
+// Only depends on the standard library so it can be built and benchmarked
+// on any platform.
+template <class T>
+class MSOLAPTaskQueue {
+public:
+    // capacity is rounded up to a power of two
+    explicit MSOLAPTaskQueue(size_t capacity) : enqueue_pos(0), dequeue_pos(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        mask = size - 1;
+        cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MSOLAPTaskQueue(const MSOLAPTaskQueue &) = delete;
+    MSOLAPTaskQueue &operator=(const MSOLAPTaskQueue &) = delete;
+
+    // Returns false when the queue is full; item is left untouched then
+    bool TryPush(T &item) {
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(item);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false when the queue is empty
+    bool TryPop(T &item) {
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(cell->data);
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    // Producers and consumers hammer different positions, keep them on separate cache lines
+    alignas(64) std::atomic<size_t> enqueue_pos;
+    alignas(64) std::atomic<size_t> dequeue_pos;
+};
+
+// Fixed set of threads owned by the extension that run submitted tasks. The
+// MSOLAP pool initializes COM as MTA on each worker (see
+// MSOLAPConnection::WorkerPool), so provider objects created by one task can be
+// used by any later task without apartment marshalling, and blocking provider
+// calls never run on DuckDB's scheduler threads.
+class MSOLAPWorkerPool {
+public:
+    using Task = std::function<void()>;
+
+    // thread_start/thread_stop run on every worker before its first and after its last task
+    MSOLAPWorkerPool(size_t thread_count, std::function<void()> thread_start = nullptr,
+                     std::function<void()> thread_stop = nullptr, size_t queue_capacity = 1024);
+    ~MSOLAPWorkerPool();
+
+    MSOLAPWorkerPool(const MSOLAPWorkerPool &) = delete;
+    MSOLAPWorkerPool &operator=(const MSOLAPWorkerPool &) = delete;
+
+    // Queue a task; waits for a free slot if the queue is full
+    void Submit(Task task);
+
+    // Run f on a worker and return a future for its result (or exception)
+    template <class F>
+    auto Async(F &&f) -> std::future<decltype(f())> {
+        using R = decltype(f());
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        auto result = task->get_future();
+        if (OnWorkerThread()) {
+            // Tasks submitting tasks would wait for themselves once all workers are busy
+            (*task)();
+        } else {
+            Submit([task]() { (*task)(); });
+        }
+        return result;
+    }
+
+    // Run f on a worker and wait for it, rethrowing its exception on the caller
+    template <class F>
+    auto Run(F &&f) -> decltype(f()) {
+        return Async(std::forward<F>(f)).get();
+    }
+
+    size_t ThreadCount() const {
+        return threads.size();
+    }
+
+    // Whether the calling thread is a worker of any pool
+    static bool OnWorkerThread();
+
+private:
+    void WorkerLoop();
+
+    MSOLAPTaskQueue<Task> queue;
+    std::vector<std::thread> threads;
+    std::function<void()> thread_start;
+    std::function<void()> thread_stop;
+
+    // Idle workers sleep on the condition variable; producers only take the
+    // mutex to wake them when somebody is actually sleeping
+    std::atomic<size_t> pending;
+    std::atomic<size_t> sleeping;
+    std::atomic<bool> stopping;
+    std::mutex sleep_lock;
+    std::condition_variable sleep_cv;
+};
+
+} // namespace duckdb
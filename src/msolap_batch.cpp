@@ -0,0 +1,315 @@
+#include "msolap_batch.hpp"
+#include "msolap_connection.hpp"
+#include "msolap_query_log.hpp"
+#include "msolap_rowset_reader.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+#include <chrono>
+#include <stdexcept>
+
+namespace duckdb {
+
+MSOLAPBatchExecution::MSOLAPBatchExecution(ClientContext &context_p, const string &connection_string_p,
+                                           const string &dax_query_p)
+    : context(context_p), connection_string(connection_string_p), dax_query(dax_query_p),
+      start(std::chrono::steady_clock::now()) {
+    Value log_file_setting;
+    if (context.TryGetCurrentSetting("msolap_query_log_file", log_file_setting) && !log_file_setting.IsNull()) {
+        log_file = log_file_setting.ToString();
+    }
+    try {
+        MSOLAPConnection::WorkerPool().Run([&]() {
+            auto phase_start = std::chrono::steady_clock::now();
+            connection = MSOLAPConnection::Connect(connection_string);
+            auto phase_end = std::chrono::steady_clock::now();
+            metrics.connect_seconds = std::chrono::duration<double>(phase_end - phase_start).count();
+
+            command = connection.CreateCommand(dax_query);
+            watchdog.Start(command, context, MSOLAPRowsetReader::GetQueryTimeout(context));
+            results = connection.ExecuteMultiple(command);
+            metrics.execute_seconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - phase_end).count();
+        });
+    } catch (std::exception &e) {
+        Fail(e);
+    }
+}
+
+MSOLAPBatchExecution::~MSOLAPBatchExecution() {
+    if (!finished) {
+        Finish(watchdog.Interrupted() ? "interrupted" : watchdog.TimedOut() ? "timed out" : "stopped early");
+    }
+}
+
+unique_ptr<MSOLAPRowsetReader> MSOLAPBatchExecution::NextResult() {
+    try {
+        while (true) {
+            IRowset* rowset = nullptr;
+            HRESULT hr = S_OK;
+            MSOLAPConnection::WorkerPool().Run([&]() {
+                DBROWCOUNT rows_affected = 0;
+                hr = results->GetResult(NULL, DBRESULTFLAG_DEFAULT, IID_IRowset, &rows_affected,
+                                        (IUnknown**)&rowset);
+            });
+            if (hr == DB_S_NORESULT) {
+                return nullptr;
+            }
+            if (FAILED(hr)) {
+                throw std::runtime_error("Failed to get result " + std::to_string(result_count) + ": " +
+                                         MSOLAPUtils::GetErrorMessage(hr));
+            }
+            if (!rowset) {
+                // A statement without rows
+                continue;
+            }
+            result_count++;
+            result_open_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            auto reader = make_uniq<MSOLAPRowsetReader>();
+            reader->Attach(context, rowset, connection_string, dax_query);
+            reader->WaitOpen();
+            return reader;
+        }
+    } catch (std::exception &e) {
+        Fail(e);
+    }
+}
+
+void MSOLAPBatchExecution::AddMetrics(const MSOLAPRowsetReader &reader) {
+    if (!metrics.first_row_seen && reader.metrics.first_row_seen) {
+        metrics.first_row_seen = true;
+        metrics.first_row_seconds = result_open_seconds + reader.metrics.first_row_seconds;
+    }
+    metrics.fetch_seconds += reader.metrics.fetch_seconds;
+    metrics.convert_seconds += reader.metrics.convert_seconds;
+    metrics.rows += reader.metrics.rows;
+    metrics.bytes += reader.metrics.bytes;
+    metrics.batches += reader.metrics.batches;
+}
+
+void MSOLAPBatchExecution::Finish(const string &status) {
+    if (finished) {
+        return;
+    }
+    finished = true;
+    if (status != "completed") {
+        // From this thread, like a closing scan: the server stops evaluating the rest
+        watchdog.Cancel();
+    }
+    watchdog.Stop();
+    metrics.status = status;
+    try {
+        MSOLAPQueryLog::Get().Record(connection_string, dax_query, metrics, log_file);
+    } catch (...) {
+        // Telemetry must never fail the query
+    }
+    try {
+        MSOLAPConnection::WorkerPool().Run([&]() {
+            MSOLAPUtils::SafeRelease(&results);
+            MSOLAPUtils::SafeRelease(&command);
+            connection.Close();
+        });
+    } catch (...) {
+    }
+}
+
+void MSOLAPBatchExecution::Fail(const std::exception &error) {
+    Finish(watchdog.Interrupted() ? "interrupted" : watchdog.TimedOut() ? "timed out" : "failed");
+    watchdog.CheckCancelled();
+    throw std::runtime_error("msolap_batch failed: " + string(error.what()));
+}
+
+// Learn the schema of every result from one execution, typing variant columns like
+// msolap(). Only each result's first batch is fetched, the execution is cancelled
+// after the last result.
+static void MSOLAPBatchDescribe(ClientContext &context, MSOLAPBatchBindData &bind_data) {
+    MSOLAPBatchExecution execution(context, bind_data.connection_string, bind_data.dax_query);
+    while (true) {
+        auto reader = execution.NextResult();
+        if (!reader) {
+            break;
+        }
+        MSOLAPBatchResult result;
+        try {
+            result.names = reader->names;
+            result.types = reader->types;
+            auto kinds = reader->SampleValueKinds(reader->variant_columns);
+            result.column_kinds.assign(result.types.size(), MSOLAPValueKind::EMPTY);
+            for (idx_t i = 0; i < result.types.size(); i++) {
+                if (i < reader->variant_columns.size() && reader->variant_columns[i]) {
+                    auto kind = MSOLAPTypeInference::Finalize(kinds[i]);
+                    result.types[i] = MSOLAPUtils::GetLogicalTypeFromValueKind(kind);
+                    if (kind != MSOLAPValueKind::STRING) {
+                        result.column_kinds[i] = kind;
+                    }
+                }
+            }
+            reader->Close();
+        } catch (std::exception &e) {
+            execution.Fail(e);
+        }
+        bind_data.results.push_back(std::move(result));
+    }
+    execution.Finish("stopped early");
+}
+
+// Name for a new output column that doesn't collide with an existing one
+static string MSOLAPBatchUniqueName(const vector<string> &names, const string &name) {
+    auto candidate = name;
+    for (idx_t suffix = 1;; suffix++) {
+        bool taken = false;
+        for (auto &existing : names) {
+            taken = taken || StringUtil::CIEquals(existing, candidate);
+        }
+        if (!taken) {
+            return candidate;
+        }
+        candidate = name + "_" + std::to_string(suffix);
+    }
+}
+
+static unique_ptr<FunctionData> MSOLAPBatchBind(ClientContext &context, TableFunctionBindInput &input,
+                                                vector<LogicalType> &return_types, vector<string> &names) {
+    auto result = make_uniq<MSOLAPBatchBindData>();
+    result->connection_string = input.inputs[0].GetValue<string>();
+    result->dax_query = input.inputs[1].GetValue<string>();
+
+    MSOLAPBatchDescribe(context, *result);
+    if (result->results.empty()) {
+        throw std::runtime_error("msolap_batch: the DAX query returned no result sets");
+    }
+
+    // Union by name: columns of the same name share an output column of a common type
+    names.push_back("result_index");
+    return_types.push_back(LogicalType::INTEGER);
+    for (auto &batch_result : result->results) {
+        vector<bool> used(names.size(), false);
+        for (idx_t col = 0; col < batch_result.names.size(); col++) {
+            auto &type = batch_result.types[col];
+            idx_t output = 1;
+            while (output < names.size() &&
+                   (used[output] || !StringUtil::CIEquals(names[output], batch_result.names[col]))) {
+                output++;
+            }
+            if (output < names.size()) {
+                LogicalType combined;
+                if (!LogicalType::TryGetMaxLogicalType(context, return_types[output], type, combined)) {
+                    combined = LogicalType::VARCHAR;
+                }
+                return_types[output] = combined;
+            } else {
+                names.push_back(MSOLAPBatchUniqueName(names, batch_result.names[col]));
+                return_types.push_back(type);
+                used.push_back(false);
+            }
+            used[output] = true;
+            batch_result.output_columns.push_back(output);
+        }
+    }
+    result->types = return_types;
+    return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> MSOLAPBatchInit(ClientContext &context, TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<MSOLAPBatchBindData>();
+    auto result = make_uniq<MSOLAPBatchGlobalState>();
+    // Every scan executes the batch, the rows are never older than the scan
+    result->execution = make_uniq<MSOLAPBatchExecution>(context, bind_data.connection_string, bind_data.dax_query);
+    return std::move(result);
+}
+
+// Reader of the next result, checked against the schema bind saw
+static void MSOLAPBatchNextResult(ClientContext &context, const MSOLAPBatchBindData &bind_data,
+                                  MSOLAPBatchGlobalState &state) {
+    state.reader = state.execution->NextResult();
+    if (!state.reader) {
+        if (state.result_index != bind_data.results.size()) {
+            state.execution->Fail(std::runtime_error("the batch returned " + std::to_string(state.result_index) +
+                                                     " result sets, " + std::to_string(bind_data.results.size()) +
+                                                     " when it was bound"));
+        }
+        return;
+    }
+    if (state.result_index >= bind_data.results.size()) {
+        state.execution->Fail(std::runtime_error("the batch returned more than the " +
+                                                 std::to_string(bind_data.results.size()) +
+                                                 " result sets it had when it was bound"));
+    }
+    auto &batch_result = bind_data.results[state.result_index];
+    if (state.reader->names.size() != batch_result.names.size()) {
+        state.execution->Fail(std::runtime_error(
+            "result " + std::to_string(state.result_index) + " has " + std::to_string(state.reader->names.size()) +
+            " columns, it had " + std::to_string(batch_result.names.size()) + " when the batch was bound"));
+    }
+    state.reader->column_kinds = batch_result.column_kinds;
+    state.chunk.Destroy();
+    state.chunk.Initialize(context, batch_result.types);
+}
+
+static void MSOLAPBatchScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+    auto &bind_data = data.bind_data->Cast<MSOLAPBatchBindData>();
+    auto &state = data.global_state->Cast<MSOLAPBatchGlobalState>();
+
+    while (true) {
+        if (!state.reader) {
+            MSOLAPBatchNextResult(context, bind_data, state);
+            if (!state.reader) {
+                state.execution->Finish("completed");
+                output.SetCardinality(0);
+                return;
+            }
+        }
+        auto &batch_result = bind_data.results[state.result_index];
+        state.chunk.Reset();
+        idx_t count;
+        try {
+            count = state.reader->Read(state.chunk);
+        } catch (std::exception &e) {
+            state.execution->Fail(e);
+        }
+        if (count == 0) {
+            state.reader->Close();
+            state.execution->AddMetrics(*state.reader);
+            state.reader.reset();
+            state.result_index++;
+            continue;
+        }
+        state.chunk.SetCardinality(count);
+
+        output.data[0].Reference(Value::INTEGER((int32_t)state.result_index));
+        for (idx_t i = 1; i < output.ColumnCount(); i++) {
+            // Columns of the other results
+            output.data[i].SetVectorType(VectorType::CONSTANT_VECTOR);
+            ConstantVector::SetNull(output.data[i], true);
+        }
+        for (idx_t col = 0; col < batch_result.output_columns.size(); col++) {
+            auto &target = output.data[batch_result.output_columns[col]];
+            if (target.GetType() == state.chunk.data[col].GetType()) {
+                target.Reference(state.chunk.data[col]);
+            } else {
+                target.SetVectorType(VectorType::FLAT_VECTOR);
+                VectorOperations::Cast(context, state.chunk.data[col], target, count);
+            }
+        }
+        output.SetCardinality(count);
+        return;
+    }
+}
+
+static InsertionOrderPreservingMap<string> MSOLAPBatchToString(TableFunctionToStringInput &input) {
+    InsertionOrderPreservingMap<string> result;
+    auto &bind_data = input.bind_data->Cast<MSOLAPBatchBindData>();
+
+    result["Connection"] = bind_data.connection_string;
+    result["Query"] = bind_data.dax_query;
+    result["Result Sets"] = std::to_string(bind_data.results.size());
+
+    return result;
+}
+
+MSOLAPBatchFunction::MSOLAPBatchFunction()
+    : TableFunction("msolap_batch", {LogicalType::VARCHAR, LogicalType::VARCHAR}, MSOLAPBatchScan, MSOLAPBatchBind,
+                    MSOLAPBatchInit) {
+    to_string = MSOLAPBatchToString;
+}
+
+} // namespace duckdb
@@ -0,0 +1,95 @@
+#include "msolap_cellset.hpp"
+#include <unordered_set>
+
+namespace duckdb {
+
+MSOLAPCellsetLayout::MSOLAPCellsetLayout(std::vector<MSOLAPCellsetAxis> axes_p) : axes(std::move(axes_p)) {
+    row_strides.resize(axes.size(), 0);
+    size_t stride = 1;
+    for (size_t axis = 1; axis < axes.size(); axis++) {
+        row_strides[axis] = stride;
+        stride *= axes[axis].TupleCount();
+        for (size_t dimension = 0; dimension < axes[axis].dimension_names.size(); dimension++) {
+            member_columns.emplace_back(axis, dimension);
+        }
+    }
+}
+
+size_t MSOLAPCellsetLayout::RowCount() const {
+    size_t rows = 1;
+    for (size_t axis = 1; axis < axes.size(); axis++) {
+        rows *= axes[axis].TupleCount();
+    }
+    // A cellset with an empty COLUMNS axis has no cells at all
+    if (!axes.empty() && axes[0].TupleCount() == 0) {
+        return 0;
+    }
+    return rows;
+}
+
+size_t MSOLAPCellsetLayout::MemberColumnCount() const {
+    return member_columns.size();
+}
+
+size_t MSOLAPCellsetLayout::ValueColumnCount() const {
+    return axes.empty() ? 1 : axes[0].TupleCount();
+}
+
+std::vector<std::string> MSOLAPCellsetLayout::ColumnNames() const {
+    std::vector<std::string> names;
+    for (auto &column : member_columns) {
+        names.push_back(axes[column.first].dimension_names[column.second]);
+    }
+    if (axes.empty()) {
+        names.push_back("Value");
+    } else {
+        auto &columns_axis = axes[0];
+        size_t dimensions = columns_axis.dimension_names.size();
+        for (size_t tuple = 0; tuple < columns_axis.TupleCount(); tuple++) {
+            std::string name;
+            bool has_caption = false;
+            for (size_t dimension = 0; dimension < dimensions; dimension++) {
+                if (dimension > 0) {
+                    name += " | ";
+                }
+                auto &caption = columns_axis.members[tuple * dimensions + dimension];
+                name += caption;
+                has_caption = has_caption || !caption.empty();
+            }
+            names.push_back(has_caption ? name : "Column" + std::to_string(tuple));
+        }
+    }
+
+    // Captions repeat (e.g. the same measure under two years), keep the first as is
+    std::unordered_set<std::string> seen;
+    for (auto &name : names) {
+        if (seen.insert(name).second) {
+            continue;
+        }
+        size_t suffix = 1;
+        while (!seen.insert(name + "_" + std::to_string(suffix)).second) {
+            suffix++;
+        }
+        name += "_" + std::to_string(suffix);
+    }
+    return names;
+}
+
+const std::string &MSOLAPCellsetLayout::Member(size_t row, size_t column) const {
+    auto &member_column = member_columns[column];
+    auto &axis = axes[member_column.first];
+    size_t tuple = (row / row_strides[member_column.first]) % axis.TupleCount();
+    return axis.members[tuple * axis.dimension_names.size() + member_column.second];
+}
+
+size_t MSOLAPCellsetLayout::CellOrdinal(size_t row, size_t column) const {
+    // Ordinal = sum(tuple[a] * product of the tuple counts of the axes before a), with
+    // rows enumerating axes 1..n in the same order this collapses to row * |axis 0| + column
+    return row * ValueColumnCount() + column;
+}
+
+size_t MSOLAPCellsetLayout::CellCount() const {
+    return RowCount() * ValueColumnCount();
+}
+
+} // namespace duckdb
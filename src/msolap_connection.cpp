@@ -9,6 +9,8 @@
 
 #include "msolap_connection.hpp"
 #include "msolap_utils.hpp"
+#include "duckdb/common/operator/cast_operators.hpp"
+#include "duckdb/common/string_util.hpp"
 #include <stdexcept>
 
 namespace duckdb {
@@ -28,15 +30,15 @@ MSOLAPConnection::MSOLAPConnection(MSOLAPConnection &&other) noexcept
     : pIDBInitialize(nullptr), pIDBCreateCommand(nullptr) {
     std::swap(pIDBInitialize, other.pIDBInitialize);
     std::swap(pIDBCreateCommand, other.pIDBCreateCommand);
-    std::swap(server_name, other.server_name);
-    std::swap(database_name, other.database_name);
+    std::swap(init_properties, other.init_properties);
+    std::swap(provider_string, other.provider_string);
 }
 
 MSOLAPConnection &MSOLAPConnection::operator=(MSOLAPConnection &&other) noexcept {
     std::swap(pIDBInitialize, other.pIDBInitialize);
     std::swap(pIDBCreateCommand, other.pIDBCreateCommand);
-    std::swap(server_name, other.server_name);
-    std::swap(database_name, other.database_name);
+    std::swap(init_properties, other.init_properties);
+    std::swap(provider_string, other.provider_string);
     return *this;
 }
 
@@ -44,62 +46,168 @@ void MSOLAPConnection::InitializeCOM() {
     static thread_local ComInitializer initializer;
 }
 
-void MSOLAPConnection::ParseConnectionString(const std::string &connection_string) {
-    // Simple parsing of connection string
-    // Format expected: "Data Source=localhost:61324;Catalog=0ec50266-bdf5-4582-bc8c-82584866bcb7"
-
-    std::map<std::string, std::string> properties;
-
-    size_t pos = 0;
-    std::string token;
-    std::string str = connection_string;
+MSOLAPWorkerPool &MSOLAPConnection::WorkerPool() {
+    // Provider calls mostly wait on the network, so allow more of them than cores.
+    // Never destroyed: joining threads from a static destructor at DLL unload
+    // would deadlock on the loader lock.
+    static auto pool = new MSOLAPWorkerPool(
+        MinValue<idx_t>(MaxValue<idx_t>(std::thread::hardware_concurrency() * 2, 8), 64),
+        []() { InitializeCOM(); });
+    return *pool;
+}
 
-    while ((pos = str.find(';')) != std::string::npos) {
-        token = str.substr(0, pos);
+void MSOLAPConnection::ParseConnectionString(const std::string &connection_string) {
+    // Format: "Data Source=localhost:61324;Catalog=0ec50266-bdf5-4582-bc8c-82584866bcb7;Transport Compression=Compressed"
+    MSOLAPConnectionString parsed;
+    try {
+        parsed = MSOLAPConnectionString::Parse(connection_string);
+    } catch (std::invalid_argument &e) {
+        throw std::runtime_error("Invalid connection string: " + string(e.what()));
+    }
+    init_properties = parsed.InitProperties();
+    provider_string = parsed.ProviderString();
+}
 
-        // Find key-value separator
-        size_t sep_pos = token.find('=');
-        if (sep_pos != std::string::npos) {
-            std::string key = token.substr(0, sep_pos);
-            std::string value = token.substr(sep_pos + 1);
-            properties[key] = value;
+std::string MSOLAPConnection::GetDataSource(const std::string &connection_string) {
+    std::string value;
+    try {
+        auto parsed = MSOLAPConnectionString::Parse(connection_string);
+        if (parsed.TryGet("Data Source", value) || parsed.TryGet("DataSource", value)) {
+            return StringUtil::Lower(value);
         }
+    } catch (std::invalid_argument &) {
+        // Reported when connecting
+    }
+    return "localhost";
+}
 
-        str.erase(0, pos + 1);
+static DBPROPID MSOLAPInitPropertyId(MSOLAPInitProperty property) {
+    switch (property) {
+    case MSOLAPInitProperty::DATA_SOURCE:
+        return DBPROP_INIT_DATASOURCE;
+    case MSOLAPInitProperty::CATALOG:
+        return DBPROP_INIT_CATALOG;
+    case MSOLAPInitProperty::LOCATION:
+        return DBPROP_INIT_LOCATION;
+    case MSOLAPInitProperty::USER_ID:
+        return DBPROP_AUTH_USERID;
+    case MSOLAPInitProperty::PASSWORD:
+        return DBPROP_AUTH_PASSWORD;
+    case MSOLAPInitProperty::INTEGRATED_SECURITY:
+        return DBPROP_AUTH_INTEGRATED;
+    case MSOLAPInitProperty::PERSIST_SECURITY_INFO:
+        return DBPROP_AUTH_PERSIST_SENSITIVE_AUTHINFO;
+    case MSOLAPInitProperty::CONNECT_TIMEOUT:
+        return DBPROP_INIT_TIMEOUT;
+    case MSOLAPInitProperty::LOCALE_IDENTIFIER:
+        return DBPROP_INIT_LCID;
+    default:
+        throw std::runtime_error("Unknown initialization property");
     }
+}
 
-    // Handle the last token after the last semicolon
-    if (!str.empty()) {
-        size_t sep_pos = str.find('=');
-        if (sep_pos != std::string::npos) {
-            std::string key = str.substr(0, sep_pos);
-            std::string value = str.substr(sep_pos + 1);
-            properties[key] = value;
+// Typed VARIANT for a property value as written in the connection string
+static void MSOLAPInitPropertyValue(MSOLAPInitProperty property, const std::string &value, VARIANT &result) {
+    switch (property) {
+    case MSOLAPInitProperty::CONNECT_TIMEOUT:
+    case MSOLAPInitProperty::LOCALE_IDENTIFIER: {
+        int32_t number;
+        if (!TryCast::Operation<string_t, int32_t>(string_t(value), number)) {
+            throw std::runtime_error("Connection string property expects a number, got \"" + value + "\"");
         }
+        result.vt = VT_I4;
+        result.lVal = number;
+        break;
+    }
+    case MSOLAPInitProperty::PERSIST_SECURITY_INFO: {
+        auto lower = StringUtil::Lower(value);
+        result.vt = VT_BOOL;
+        result.boolVal = lower == "true" || lower == "yes" ? VARIANT_TRUE : VARIANT_FALSE;
+        break;
     }
+    default:
+        result.vt = VT_BSTR;
+        result.bstrVal = SysAllocString(WindowsUtil::UTF8ToUnicode(value.c_str()).c_str());
+        break;
+    }
+}
 
-    // Extract server and database
-    auto server_it = properties.find("Data Source");
-    if (server_it != properties.end()) {
-        server_name = WindowsUtil::UTF8ToUnicode(server_it->second.c_str());
-    } else {
-        server_name = L"localhost";
+void MSOLAPConnection::SetInitProperties(IDBProperties *properties) {
+    vector<DBPROP> props;
+    auto add_property = [&](DBPROPID id, DBPROPOPTIONS options) -> VARIANT & {
+        DBPROP prop;
+        ZeroMemory(&prop, sizeof(prop));
+        prop.dwPropertyID = id;
+        prop.dwOptions = options;
+        props.push_back(prop);
+        return props.back().vValue;
+    };
+    auto clear_values = [&]() {
+        for (auto &prop : props) {
+            VariantClear(&prop.vValue);
+        }
+    };
+
+    try {
+        bool has_data_source = false;
+        bool has_catalog = false;
+        for (auto &property : init_properties) {
+            has_data_source = has_data_source || property.first == MSOLAPInitProperty::DATA_SOURCE;
+            has_catalog = has_catalog || property.first == MSOLAPInitProperty::CATALOG;
+            MSOLAPInitPropertyValue(property.first, property.second,
+                                    add_property(MSOLAPInitPropertyId(property.first), DBPROPOPTIONS_REQUIRED));
+        }
+        if (!has_data_source) {
+            auto &value = add_property(DBPROP_INIT_DATASOURCE, DBPROPOPTIONS_REQUIRED);
+            value.vt = VT_BSTR;
+            value.bstrVal = SysAllocString(L"localhost");
+        }
+        if (!has_catalog) {
+            auto &value = add_property(DBPROP_INIT_CATALOG, DBPROPOPTIONS_REQUIRED);
+            value.vt = VT_BSTR;
+            value.bstrVal = SysAllocString(L"");
+        }
+
+        // Read-only mode
+        auto &mode = add_property(DBPROP_INIT_MODE, DBPROPOPTIONS_REQUIRED);
+        mode.vt = VT_I4;
+        mode.lVal = DB_MODE_READ;
+
+        // The provider reads its own settings (compression, packet size, timeouts,
+        // application name, roles, ...) from the provider string
+        if (!provider_string.empty()) {
+            auto &value = add_property(DBPROP_INIT_PROVIDERSTRING, DBPROPOPTIONS_REQUIRED);
+            value.vt = VT_BSTR;
+            value.bstrVal = SysAllocString(WindowsUtil::UTF8ToUnicode(provider_string.c_str()).c_str());
+        }
+    } catch (...) {
+        clear_values();
+        throw;
     }
 
-    auto db_it = properties.find("Catalog");
-    if (db_it != properties.end()) {
-        database_name = WindowsUtil::UTF8ToUnicode(db_it->second.c_str());
-    } else {
-        database_name = L"";
+    DBPROPSET prop_set;
+    prop_set.guidPropertySet = DBPROPSET_DBINIT;
+    prop_set.cProperties = (ULONG)props.size();
+    prop_set.rgProperties = props.data();
+    HRESULT hr = properties->SetProperties(1, &prop_set);
+    clear_values();
+
+    if (FAILED(hr) || hr == DB_S_ERRORSOCCURRED) {
+        // Name the properties the provider refused
+        string rejected;
+        for (auto &prop : props) {
+            if (prop.dwStatus != DBPROPSTATUS_OK) {
+                rejected += (rejected.empty() ? "" : ", ") + std::to_string(prop.dwPropertyID);
+            }
+        }
+        throw std::runtime_error("Failed to set connection properties: " + MSOLAPUtils::GetErrorMessage(hr) +
+                                 (rejected.empty() ? "" : " (rejected property ids: " + rejected + ")"));
     }
 }
 
 MSOLAPConnection MSOLAPConnection::Connect(const std::string &connection_string) {
     MSOLAPConnection connection;
 
-    // Initialize COM
-    InitializeCOM();
-
     // Parse connection string
     connection.ParseConnectionString(connection_string);
 
@@ -120,46 +228,12 @@ MSOLAPConnection MSOLAPConnection::Connect(const std::string &connection_string)
     }
 
     // Set the properties for the connection
-    DBPROP dbProps[3];
-    DBPROPSET dbPropSet;
-
-    // Initialize the property structures
-    ZeroMemory(dbProps, sizeof(dbProps));
-
-    // Set the Data Source property
-    dbProps[0].dwPropertyID = DBPROP_INIT_DATASOURCE;
-    dbProps[0].dwOptions = DBPROPOPTIONS_REQUIRED;
-    dbProps[0].vValue.vt = VT_BSTR;
-    dbProps[0].vValue.bstrVal = SysAllocString(connection.server_name.c_str());
-
-    // Set the Catalog property (database name)
-    dbProps[1].dwPropertyID = DBPROP_INIT_CATALOG;
-    dbProps[1].dwOptions = DBPROPOPTIONS_REQUIRED;
-    dbProps[1].vValue.vt = VT_BSTR;
-    dbProps[1].vValue.bstrVal = SysAllocString(connection.database_name.c_str());
-
-    // Set the Mode property to read-only
-    dbProps[2].dwPropertyID = DBPROP_INIT_MODE;
-    dbProps[2].dwOptions = DBPROPOPTIONS_REQUIRED;
-    dbProps[2].vValue.vt = VT_I4;
-    dbProps[2].vValue.lVal = DB_MODE_READ; // Read-only mode
-
-    // Set up the property set
-    dbPropSet.guidPropertySet = DBPROPSET_DBINIT;
-    dbPropSet.cProperties = 3;
-    dbPropSet.rgProperties = dbProps;
-
-    // Set the initialization properties
-    hr = pIDBProperties->SetProperties(1, &dbPropSet);
-
-    // Free the BSTR allocations
-    SysFreeString(dbProps[0].vValue.bstrVal);
-    SysFreeString(dbProps[1].vValue.bstrVal);
-
-    if (FAILED(hr)) {
+    try {
+        connection.SetInitProperties(pIDBProperties);
+    } catch (...) {
         MSOLAPUtils::SafeRelease(&pIDBProperties);
         MSOLAPUtils::SafeRelease(&connection.pIDBInitialize);
-        throw std::runtime_error("Failed to set connection properties: " + MSOLAPUtils::GetErrorMessage(hr));
+        throw;
     }
 
     // Initialize the data source
@@ -189,7 +263,7 @@ MSOLAPConnection MSOLAPConnection::Connect(const std::string &connection_string)
     return connection;
 }
 
-IRowset* MSOLAPConnection::ExecuteQuery(const std::string &dax_query) {
+ICommand* MSOLAPConnection::CreateCommand(const std::string &dax_query) {
     if (!IsOpen()) {
         throw std::runtime_error("Connection is not open");
     }
@@ -246,11 +320,138 @@ IRowset* MSOLAPConnection::ExecuteQuery(const std::string &dax_query) {
         MSOLAPUtils::SafeRelease(&pICommandProperties);
     }
 
+    MSOLAPUtils::SafeRelease(&pICommandText);
+    return pICommand;
+}
+
+IRowset* MSOLAPConnection::ExecuteCommand(ICommand *command) {
     // Execute the command
     IRowset* pIRowset = NULL;
-    hr = pICommand->Execute(NULL, IID_IRowset, NULL, NULL, (IUnknown**)&pIRowset);
-    MSOLAPUtils::SafeRelease(&pICommandText);
-    MSOLAPUtils::SafeRelease(&pICommand);
+    HRESULT hr = command->Execute(NULL, IID_IRowset, NULL, NULL, (IUnknown**)&pIRowset);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Query execution failed: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+
+    return pIRowset;
+}
+
+IMDDataset* MSOLAPConnection::ExecuteDataset(ICommand *command) {
+    IMDDataset* pIMDDataset = NULL;
+    HRESULT hr = command->Execute(NULL, IID_IMDDataset, NULL, NULL, (IUnknown**)&pIMDDataset);
+    if (FAILED(hr)) {
+        throw std::runtime_error("MDX execution failed: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+
+    return pIMDDataset;
+}
+
+IMultipleResults* MSOLAPConnection::ExecuteMultiple(ICommand *command) {
+    IMultipleResults* pIMultipleResults = NULL;
+    HRESULT hr = command->Execute(NULL, IID_IMultipleResults, NULL, NULL, (IUnknown**)&pIMultipleResults);
+    if (FAILED(hr)) {
+        throw std::runtime_error("DAX batch execution failed: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+
+    return pIMultipleResults;
+}
+
+ICommand* MSOLAPConnection::PrepareCommand(const std::string &dax_query) {
+    ICommand* pICommand = CreateCommand(dax_query);
+
+    ICommandPrepare* pICommandPrepare = NULL;
+    HRESULT hr = pICommand->QueryInterface(IID_ICommandPrepare, (void**)&pICommandPrepare);
+    if (FAILED(hr)) {
+        // Provider can't prepare, the command still works unprepared
+        return pICommand;
+    }
+
+    hr = pICommandPrepare->Prepare(0);
+    MSOLAPUtils::SafeRelease(&pICommandPrepare);
+    if (FAILED(hr)) {
+        MSOLAPUtils::SafeRelease(&pICommand);
+        throw std::runtime_error("Failed to prepare command: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+
+    return pICommand;
+}
+
+IRowset* MSOLAPConnection::ExecuteCommand(ICommand *command, const vector<MSOLAPParameter> &parameters) {
+    if (parameters.empty()) {
+        return ExecuteCommand(command);
+    }
+
+    // Describe the parameters by name, all of them are passed as VARIANT
+    ICommandWithParameters* pICommandWithParameters = NULL;
+    HRESULT hr = command->QueryInterface(IID_ICommandWithParameters, (void**)&pICommandWithParameters);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Provider does not support command parameters: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+
+    DBCOUNTITEM cParams = parameters.size();
+    std::vector<DB_UPARAMS> ordinals(cParams);
+    std::vector<DBPARAMBINDINFO> bind_info(cParams);
+    std::vector<std::wstring> wnames(cParams);
+    std::vector<DBBINDING> param_bindings(cParams);
+    for (DBCOUNTITEM i = 0; i < cParams; i++) {
+        wnames[i] = WindowsUtil::UTF8ToUnicode(parameters[i].name.c_str());
+        ordinals[i] = i + 1;
+
+        ZeroMemory(&bind_info[i], sizeof(DBPARAMBINDINFO));
+        bind_info[i].pwszDataSourceType = (LPOLESTR)L"DBTYPE_VARIANT";
+        bind_info[i].pwszName = (LPOLESTR)wnames[i].c_str();
+        bind_info[i].ulParamSize = sizeof(VARIANT);
+        bind_info[i].dwFlags = DBPARAMFLAGS_ISINPUT;
+
+        ZeroMemory(&param_bindings[i], sizeof(DBBINDING));
+        param_bindings[i].iOrdinal = i + 1;
+        param_bindings[i].obValue = i * sizeof(VARIANT);
+        param_bindings[i].dwPart = DBPART_VALUE;
+        param_bindings[i].dwMemOwner = DBMEMOWNER_CLIENTOWNED;
+        param_bindings[i].eParamIO = DBPARAMIO_INPUT;
+        param_bindings[i].cbMaxLen = sizeof(VARIANT);
+        param_bindings[i].wType = DBTYPE_VARIANT;
+    }
+
+    hr = pICommandWithParameters->SetParameterInfo(cParams, ordinals.data(), bind_info.data());
+    MSOLAPUtils::SafeRelease(&pICommandWithParameters);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to set parameter info: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+
+    // Parameter accessor over an array of VARIANTs
+    IAccessor* pIAccessor = NULL;
+    hr = command->QueryInterface(IID_IAccessor, (void**)&pIAccessor);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to get parameter IAccessor: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+
+    HACCESSOR hAccessor = NULL;
+    hr = pIAccessor->CreateAccessor(DBACCESSOR_PARAMETERDATA, cParams, param_bindings.data(),
+                                    cParams * sizeof(VARIANT), &hAccessor, NULL);
+    if (FAILED(hr)) {
+        MSOLAPUtils::SafeRelease(&pIAccessor);
+        throw std::runtime_error("Failed to create parameter accessor: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+
+    std::vector<VARIANT> values(cParams);
+    for (DBCOUNTITEM i = 0; i < cParams; i++) {
+        VariantInit(&values[i]);
+        MSOLAPUtils::ConvertValueToVariant(parameters[i].value, &values[i]);
+    }
+
+    DBPARAMS dbParams;
+    dbParams.pData = values.data();
+    dbParams.cParamSets = 1;
+    dbParams.hAccessor = hAccessor;
+
+    IRowset* pIRowset = NULL;
+    hr = command->Execute(NULL, IID_IRowset, &dbParams, NULL, (IUnknown**)&pIRowset);
+
+    for (auto &value : values) {
+        VariantClear(&value);
+    }
+    pIAccessor->ReleaseAccessor(hAccessor, NULL);
+    MSOLAPUtils::SafeRelease(&pIAccessor);
 
     if (FAILED(hr)) {
         throw std::runtime_error("Query execution failed: " + MSOLAPUtils::GetErrorMessage(hr));
@@ -259,7 +460,20 @@ IRowset* MSOLAPConnection::ExecuteQuery(const std::string &dax_query) {
     return pIRowset;
 }
 
-bool MSOLAPConnection::GetColumnInfo(IRowset *rowset, std::vector<std::string> &names, std::vector<LogicalType> &types) {
+IRowset* MSOLAPConnection::ExecuteQuery(const std::string &dax_query) {
+    ICommand* pICommand = CreateCommand(dax_query);
+    try {
+        IRowset* pIRowset = ExecuteCommand(pICommand);
+        MSOLAPUtils::SafeRelease(&pICommand);
+        return pIRowset;
+    } catch (...) {
+        MSOLAPUtils::SafeRelease(&pICommand);
+        throw;
+    }
+}
+
+bool MSOLAPConnection::GetColumnInfo(IRowset *rowset, std::vector<std::string> &names, std::vector<LogicalType> &types,
+                                     std::vector<std::string> *references, std::vector<bool> *variants) {
     if (!rowset) {
         return false;
     }
@@ -285,6 +499,12 @@ bool MSOLAPConnection::GetColumnInfo(IRowset *rowset, std::vector<std::string> &
     // Process column information
     names.clear();
     types.clear();
+    if (references) {
+        references->clear();
+    }
+    if (variants) {
+        variants->clear();
+    }
 
     for (DBORDINAL i = 0; i < cColumns; i++) {
         std::string column_name;
@@ -296,7 +516,14 @@ bool MSOLAPConnection::GetColumnInfo(IRowset *rowset, std::vector<std::string> &
         }
 
         names.push_back(column_name);
+        if (references) {
+            references->push_back(pColumnInfo[i].pwszName ? WindowsUtil::UnicodeToUTF8(pColumnInfo[i].pwszName)
+                                                          : std::string());
+        }
         types.push_back(MSOLAPUtils::GetLogicalTypeFromDBTYPE(pColumnInfo[i].wType));
+        if (variants) {
+            variants->push_back(pColumnInfo[i].wType == DBTYPE_VARIANT);
+        }
     }
 
     // Clean up
@@ -0,0 +1,241 @@
+#include "msolap_connection_string.hpp"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace duckdb {
+
+static std::string MSOLAPLowerKeyword(const std::string &keyword) {
+    std::string result;
+    for (char c : keyword) {
+        result += (char)std::tolower((unsigned char)c);
+    }
+    return result;
+}
+
+static bool MSOLAPIsSpace(char c) {
+    return std::isspace((unsigned char)c) != 0;
+}
+
+static std::string MSOLAPTrim(const std::string &str) {
+    size_t begin = 0;
+    size_t end = str.size();
+    while (begin < end && MSOLAPIsSpace(str[begin])) {
+        begin++;
+    }
+    while (end > begin && MSOLAPIsSpace(str[end - 1])) {
+        end--;
+    }
+    return str.substr(begin, end - begin);
+}
+
+MSOLAPConnectionString MSOLAPConnectionString::Parse(const std::string &connection_string) {
+    MSOLAPConnectionString result;
+    size_t pos = 0;
+    size_t length = connection_string.size();
+    while (pos < length) {
+        // Keyword, up to a single '='
+        std::string keyword;
+        bool has_separator = false;
+        while (pos < length) {
+            char c = connection_string[pos];
+            if (c == '=') {
+                if (pos + 1 < length && connection_string[pos + 1] == '=') {
+                    keyword += '=';
+                    pos += 2;
+                    continue;
+                }
+                has_separator = true;
+                pos++;
+                break;
+            }
+            if (c == ';') {
+                break;
+            }
+            keyword += c;
+            pos++;
+        }
+        keyword = MSOLAPTrim(keyword);
+        if (!has_separator) {
+            if (!keyword.empty()) {
+                throw std::invalid_argument("Connection string entry \"" + keyword + "\" has no '='");
+            }
+            // Empty entry (";;" or a trailing ';')
+            pos++;
+            continue;
+        }
+        if (keyword.empty()) {
+            throw std::invalid_argument("Connection string contains a value without a keyword");
+        }
+
+        // Value, quoted or up to the next ';'
+        while (pos < length && MSOLAPIsSpace(connection_string[pos])) {
+            pos++;
+        }
+        std::string value;
+        if (pos < length && (connection_string[pos] == '"' || connection_string[pos] == '\'')) {
+            char quote = connection_string[pos++];
+            bool closed = false;
+            while (pos < length) {
+                char c = connection_string[pos++];
+                if (c == quote) {
+                    if (pos < length && connection_string[pos] == quote) {
+                        value += quote;
+                        pos++;
+                        continue;
+                    }
+                    closed = true;
+                    break;
+                }
+                value += c;
+            }
+            if (!closed) {
+                throw std::invalid_argument("Unterminated quoted value for \"" + keyword + "\"");
+            }
+            while (pos < length && MSOLAPIsSpace(connection_string[pos])) {
+                pos++;
+            }
+            if (pos < length && connection_string[pos] != ';') {
+                throw std::invalid_argument("Unexpected characters after the quoted value of \"" + keyword + "\"");
+            }
+        } else {
+            size_t end = connection_string.find(';', pos);
+            end = end == std::string::npos ? length : end;
+            value = MSOLAPTrim(connection_string.substr(pos, end - pos));
+            pos = end;
+        }
+        pos++;
+
+        auto lower = MSOLAPLowerKeyword(keyword);
+        auto existing = std::find_if(result.properties.begin(), result.properties.end(),
+                                     [&](const MSOLAPConnectionProperty &property) {
+                                         return MSOLAPLowerKeyword(property.keyword) == lower;
+                                     });
+        if (existing != result.properties.end()) {
+            existing->value = value;
+        } else {
+            result.properties.push_back({keyword, value});
+        }
+    }
+    return result;
+}
+
+bool MSOLAPConnectionString::TryGet(const std::string &keyword, std::string &value) const {
+    auto lower = MSOLAPLowerKeyword(keyword);
+    for (auto &property : properties) {
+        if (MSOLAPLowerKeyword(property.keyword) == lower) {
+            value = property.value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Keywords (and their synonyms) the provider also exposes as DBPROPSET_DBINIT properties
+static bool MSOLAPLookupInitProperty(const std::string &keyword, MSOLAPInitProperty &result) {
+    static const std::pair<const char *, MSOLAPInitProperty> keywords[] = {
+        {"data source", MSOLAPInitProperty::DATA_SOURCE},
+        {"datasource", MSOLAPInitProperty::DATA_SOURCE},
+        {"catalog", MSOLAPInitProperty::CATALOG},
+        {"initial catalog", MSOLAPInitProperty::CATALOG},
+        {"database", MSOLAPInitProperty::CATALOG},
+        {"location", MSOLAPInitProperty::LOCATION},
+        {"user id", MSOLAPInitProperty::USER_ID},
+        {"uid", MSOLAPInitProperty::USER_ID},
+        {"password", MSOLAPInitProperty::PASSWORD},
+        {"pwd", MSOLAPInitProperty::PASSWORD},
+        {"integrated security", MSOLAPInitProperty::INTEGRATED_SECURITY},
+        {"persist security info", MSOLAPInitProperty::PERSIST_SECURITY_INFO},
+        {"connect timeout", MSOLAPInitProperty::CONNECT_TIMEOUT},
+        {"locale identifier", MSOLAPInitProperty::LOCALE_IDENTIFIER},
+    };
+    auto lower = MSOLAPLowerKeyword(keyword);
+    for (auto &entry : keywords) {
+        if (lower == entry.first) {
+            result = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::pair<MSOLAPInitProperty, std::string>> MSOLAPConnectionString::InitProperties() const {
+    std::vector<std::pair<MSOLAPInitProperty, std::string>> result;
+    for (auto &property : properties) {
+        MSOLAPInitProperty id;
+        if (!MSOLAPLookupInitProperty(property.keyword, id)) {
+            continue;
+        }
+        // Synonyms map to the same property, the last one written wins
+        auto existing = std::find_if(result.begin(), result.end(),
+                                     [&](const std::pair<MSOLAPInitProperty, std::string> &entry) {
+                                         return entry.first == id;
+                                     });
+        if (existing != result.end()) {
+            existing->second = property.value;
+        } else {
+            result.emplace_back(id, property.value);
+        }
+    }
+    return result;
+}
+
+std::string MSOLAPConnectionString::ProviderString() const {
+    std::string result;
+    for (auto &property : properties) {
+        MSOLAPInitProperty id;
+        if (MSOLAPLookupInitProperty(property.keyword, id) || MSOLAPLowerKeyword(property.keyword) == "provider") {
+            continue;
+        }
+        std::string keyword;
+        for (char c : property.keyword) {
+            keyword += c;
+            if (c == '=') {
+                keyword += '=';
+            }
+        }
+        if (!result.empty()) {
+            result += ';';
+        }
+        result += keyword + "=" + QuoteValue(property.value);
+    }
+    return result;
+}
+
+std::string MSOLAPConnectionString::Description() const {
+    std::string data_source;
+    std::string catalog;
+    for (auto &property : InitProperties()) {
+        if (property.first == MSOLAPInitProperty::DATA_SOURCE) {
+            data_source = property.second;
+        } else if (property.first == MSOLAPInitProperty::CATALOG) {
+            catalog = property.second;
+        }
+    }
+    std::string result = "Data Source=" + QuoteValue(data_source);
+    if (!catalog.empty()) {
+        result += ";Catalog=" + QuoteValue(catalog);
+    }
+    return result;
+}
+
+std::string MSOLAPConnectionString::QuoteValue(const std::string &value) {
+    bool needs_quotes = value.find_first_of(";\"'") != std::string::npos ||
+                        (!value.empty() && (MSOLAPIsSpace(value.front()) || MSOLAPIsSpace(value.back())));
+    if (!needs_quotes) {
+        return value;
+    }
+    // Prefer the quote that doesn't occur in the value, double it otherwise
+    char quote = value.find('"') == std::string::npos ? '"' : value.find('\'') == std::string::npos ? '\'' : '"';
+    std::string result(1, quote);
+    for (char c : value) {
+        result += c;
+        if (c == quote) {
+            result += quote;
+        }
+    }
+    result += quote;
+    return result;
+}
+
+} // namespace duckdb
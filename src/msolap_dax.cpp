@@ -0,0 +1,129 @@
+#include "msolap_dax.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/date.hpp"
+#include "duckdb/common/types/time.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+
+namespace duckdb {
+
+string MSOLAPDax::QuoteString(const string &str) {
+    return "\"" + StringUtil::Replace(str, "\"", "\"\"") + "\"";
+}
+
+string MSOLAPDax::ToLiteral(const Value &value) {
+    if (value.IsNull()) {
+        return "BLANK()";
+    }
+    switch (value.type().id()) {
+    case LogicalTypeId::BOOLEAN:
+        return BooleanValue::Get(value) ? "TRUE()" : "FALSE()";
+    case LogicalTypeId::TINYINT:
+    case LogicalTypeId::SMALLINT:
+    case LogicalTypeId::INTEGER:
+    case LogicalTypeId::BIGINT:
+    case LogicalTypeId::UTINYINT:
+    case LogicalTypeId::USMALLINT:
+    case LogicalTypeId::UINTEGER:
+    case LogicalTypeId::UBIGINT:
+    case LogicalTypeId::HUGEINT:
+    case LogicalTypeId::DECIMAL:
+        return value.ToString();
+    case LogicalTypeId::FLOAT:
+    case LogicalTypeId::DOUBLE: {
+        // Avoid exponent notation, DAX doesn't accept it in literals
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%.17g", value.GetValue<double>());
+        string result = buffer;
+        if (result.find_first_of("eEnN") != string::npos) {
+            return "VALUE(" + QuoteString(result) + ")";
+        }
+        return result;
+    }
+    case LogicalTypeId::DATE: {
+        int32_t year, month, day;
+        Date::Convert(value.GetValue<date_t>(), year, month, day);
+        return "DATE(" + to_string(year) + ", " + to_string(month) + ", " + to_string(day) + ")";
+    }
+    case LogicalTypeId::TIMESTAMP:
+    case LogicalTypeId::TIMESTAMP_SEC:
+    case LogicalTypeId::TIMESTAMP_MS:
+    case LogicalTypeId::TIMESTAMP_NS: {
+        date_t date;
+        dtime_t time;
+        Timestamp::Convert(value.DefaultCastAs(LogicalType::TIMESTAMP).GetValue<timestamp_t>(), date, time);
+        int32_t year, month, day, hour, minute, second, micros;
+        Date::Convert(date, year, month, day);
+        Time::Convert(time, hour, minute, second, micros);
+        return "DATE(" + to_string(year) + ", " + to_string(month) + ", " + to_string(day) + ") + TIME(" +
+               to_string(hour) + ", " + to_string(minute) + ", " + to_string(second) + ")";
+    }
+    default:
+        return QuoteString(value.ToString());
+    }
+}
+
+string MSOLAPDax::TableConstructor(const vector<string> &literals) {
+    return "{" + StringUtil::Join(literals, ", ") + "}";
+}
+
+string MSOLAPDax::TableExpression(const string &dax_query) {
+    string trimmed = dax_query;
+    StringUtil::Trim(trimmed);
+    if (StringUtil::StartsWith(StringUtil::Upper(trimmed.substr(0, 8)), "EVALUATE")) {
+        trimmed = trimmed.substr(8);
+        StringUtil::Trim(trimmed);
+    }
+    return trimmed;
+}
+
+string MSOLAPDax::ColumnReference(const string &column_name) {
+    auto bracket = column_name.find('[');
+    if (bracket == string::npos) {
+        return "[" + StringUtil::Replace(column_name, "]", "]]") + "]";
+    }
+    if (bracket == 0) {
+        return column_name;
+    }
+    string table = column_name.substr(0, bracket);
+    if (table.size() >= 2 && table.front() == '\'' && table.back() == '\'') {
+        return column_name;
+    }
+    return "'" + StringUtil::Replace(table, "'", "''") + "'" + column_name.substr(bracket);
+}
+
+bool MSOLAPDax::IsTableName(const string &table_expression) {
+    if (table_expression.empty()) {
+        return false;
+    }
+    if (table_expression.size() >= 2 && table_expression.front() == '\'' && table_expression.back() == '\'') {
+        // Quoted name, embedded quotes have to be doubled
+        string inner = StringUtil::Replace(table_expression.substr(1, table_expression.size() - 2), "''", "");
+        return inner.find('\'') == string::npos;
+    }
+    for (char c : table_expression) {
+        if (!StringUtil::CharacterIsAlpha(c) && !StringUtil::CharacterIsDigit(c) && c != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+string MSOLAPDax::TableReference(const string &table_name) {
+    if (IsTableName(table_name)) {
+        return table_name;
+    }
+    return "'" + StringUtil::Replace(table_name, "'", "''") + "'";
+}
+
+bool MSOLAPDax::IsSimpleEvaluate(const string &dax_query) {
+    string upper = StringUtil::Upper(dax_query);
+    StringUtil::Trim(upper);
+    if (!StringUtil::StartsWith(upper, "EVALUATE")) {
+        return false;
+    }
+    // More than one EVALUATE, DEFINE blocks or an ORDER BY clause can't be wrapped
+    return upper.find("EVALUATE", 8) == string::npos && upper.find("DEFINE") == string::npos &&
+           upper.find("ORDER BY") == string::npos && upper.find("START AT") == string::npos;
+}
+
+} // namespace duckdb
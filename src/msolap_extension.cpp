@@ -2,8 +2,19 @@
 
 #include "msolap_extension.hpp"
 #include "msolap_scanner.hpp"
+#include "msolap_query_log.hpp"
+#include "msolap_multi.hpp"
+#include "msolap_batch.hpp"
+#include "msolap_lateral.hpp"
+#include "msolap_mdx.hpp"
+#include "msolap_sync.hpp"
+#include "msolap_table.hpp"
+#include "msolap_result_cache.hpp"
+#include "msolap_filter_pushdown.hpp"
+#include "msolap_optimizer.hpp"
 #include "msolap_utils.hpp"
 #include "duckdb/main/extension_util.hpp"
+#include "duckdb/main/config.hpp"
 #include "duckdb/parser/parsed_data/create_table_function_info.hpp"
 
 namespace duckdb {
@@ -12,6 +23,74 @@ static void LoadInternal(DatabaseInstance &instance) {
     // Register MSOLAP table function
     MSOLAPScanFunction msolap_scan_fun;
     ExtensionUtil::RegisterFunction(instance, msolap_scan_fun);
+
+    // Register concurrent multi-source table function
+    MSOLAPMultiFunction msolap_multi_fun;
+    ExtensionUtil::RegisterFunction(instance, msolap_multi_fun);
+
+    // Register multi-statement DAX batch table function
+    MSOLAPBatchFunction msolap_batch_fun;
+    ExtensionUtil::RegisterFunction(instance, msolap_batch_fun);
+
+    // Register batched per-key table in-out function
+    MSOLAPLateralFunction msolap_lateral_fun;
+    ExtensionUtil::RegisterFunction(instance, msolap_lateral_fun);
+
+    // Register model table scan generating its own DAX
+    MSOLAPTableFunction msolap_table_fun;
+    ExtensionUtil::RegisterFunction(instance, msolap_table_fun);
+
+    // Register incremental table sync
+    MSOLAPSyncFunction msolap_sync_fun;
+    ExtensionUtil::RegisterFunction(instance, msolap_sync_fun);
+
+    // Register MDX cellset table function
+    MSOLAPMdxFunction msolap_mdx_fun;
+    ExtensionUtil::RegisterFunction(instance, msolap_mdx_fun);
+
+    // Register persistent result cache functions
+    MSOLAPCacheFunction msolap_cache_fun;
+    ExtensionUtil::RegisterFunction(instance, msolap_cache_fun);
+    ExtensionUtil::RegisterFunction(instance, MSOLAPCachePinFunction(true));
+    ExtensionUtil::RegisterFunction(instance, MSOLAPCachePinFunction(false));
+
+    // Register query telemetry table function
+    MSOLAPQueryLogFunction msolap_query_log_fun;
+    ExtensionUtil::RegisterFunction(instance, msolap_query_log_fun);
+
+    // Register settings
+    auto &config = DBConfig::GetConfig(instance);
+    config.AddExtensionOption("msolap_fetch_size",
+                              "Initial number of rows requested per GetNextRows call, grown adaptively",
+                              LogicalType::UBIGINT, Value::UBIGINT(STANDARD_VECTOR_SIZE));
+    config.AddExtensionOption("msolap_fetch_memory_limit",
+                              "Maximum bytes of row data a single GetNextRows call may materialize",
+                              LogicalType::UBIGINT, Value::UBIGINT(MSOLAP_DEFAULT_FETCH_MEMORY_LIMIT));
+    config.AddExtensionOption("msolap_query_timeout",
+                              "Cancel MSOLAP queries that run longer than this many seconds (0 disables)",
+                              LogicalType::UBIGINT, Value::UBIGINT(0));
+    config.AddExtensionOption("msolap_execute_at_bind",
+                              "Keep the query executed to learn the result schema running and scan its rows",
+                              LogicalType::BOOLEAN, Value::BOOLEAN(true));
+    config.AddExtensionOption("msolap_join_key_threshold",
+                              "Largest IN list of join keys pushed into the DAX query (0 disables key pushdown); DuckDB only "
+                              "derives key lists up to dynamic_or_filter_threshold rows, raise both to push more keys",
+                              LogicalType::UBIGINT, Value::UBIGINT(MSOLAP_DEFAULT_JOIN_KEY_THRESHOLD));
+    config.AddExtensionOption("msolap_cache_directory",
+                              "Directory of the persistent msolap result cache (empty disables)",
+                              LogicalType::VARCHAR, Value(""));
+    config.AddExtensionOption("msolap_cache_size_limit",
+                              "Maximum total bytes of cached results, least recently used ones are evicted",
+                              LogicalType::UBIGINT, Value::UBIGINT(MSOLAP_DEFAULT_CACHE_SIZE_LIMIT));
+    config.AddExtensionOption("msolap_query_log_file",
+                              "Append a JSON line per msolap scan to this file (empty disables)",
+                              LogicalType::VARCHAR, Value(""));
+    config.AddExtensionOption("msolap_sample_pushdown",
+                              "Turn USING SAMPLE / TABLESAMPLE on msolap scans into DAX SAMPLE (approximate sampling)",
+                              LogicalType::BOOLEAN, Value::BOOLEAN(true));
+
+    // Register plan rewrites into DAX
+    MSOLAPOptimizer::Register(config);
 }
 
 void MsolapExtension::Load(DuckDB &db) {
@@ -0,0 +1,263 @@
+#include "msolap_filter_pushdown.hpp"
+#include "msolap_dax.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include "duckdb/planner/expression/bound_conjunction_expression.hpp"
+#include "duckdb/planner/expression/bound_reference_expression.hpp"
+#include "duckdb/planner/filter/conjunction_filter.hpp"
+#include "duckdb/planner/filter/constant_filter.hpp"
+#include "duckdb/planner/filter/dynamic_filter.hpp"
+#include "duckdb/planner/filter/in_filter.hpp"
+#include "duckdb/planner/filter/null_filter.hpp"
+#include "duckdb/planner/filter/optional_filter.hpp"
+
+namespace duckdb {
+
+MSOLAPFilterPushdown::MSOLAPFilterPushdown(const vector<string> &column_references, const vector<LogicalType> &types,
+                                           idx_t key_threshold, bool exact)
+    : column_references(column_references), types(types), key_threshold(key_threshold), exact(exact) {
+}
+
+static string MSOLAPComparisonOperator(ExpressionType comparison) {
+    switch (comparison) {
+    case ExpressionType::COMPARE_EQUAL:
+        return "=";
+    case ExpressionType::COMPARE_NOTEQUAL:
+        return "<>";
+    case ExpressionType::COMPARE_LESSTHAN:
+        return "<";
+    case ExpressionType::COMPARE_GREATERTHAN:
+        return ">";
+    case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+        return "<=";
+    case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+        return ">=";
+    default:
+        return "";
+    }
+}
+
+bool MSOLAPFilterPushdown::CanPushLiteral(const LogicalType &type, const Value &constant) {
+    if (constant.IsNull()) {
+        return false;
+    }
+    switch (type.id()) {
+    case LogicalTypeId::TIMESTAMP: {
+        // DATE() + TIME() literals have second precision
+        auto micros = Timestamp::GetEpochMicroSeconds(constant.DefaultCastAs(LogicalType::TIMESTAMP).GetValue<timestamp_t>());
+        return micros % Interval::MICROS_PER_SEC == 0;
+    }
+    case LogicalTypeId::BOOLEAN:
+    case LogicalTypeId::TINYINT:
+    case LogicalTypeId::SMALLINT:
+    case LogicalTypeId::INTEGER:
+    case LogicalTypeId::BIGINT:
+    case LogicalTypeId::UTINYINT:
+    case LogicalTypeId::USMALLINT:
+    case LogicalTypeId::UINTEGER:
+    case LogicalTypeId::UBIGINT:
+    case LogicalTypeId::HUGEINT:
+    case LogicalTypeId::DECIMAL:
+    case LogicalTypeId::FLOAT:
+    case LogicalTypeId::DOUBLE:
+    case LogicalTypeId::DATE:
+    case LogicalTypeId::VARCHAR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool MSOLAPFilterPushdown::CanPushComparison(const LogicalType &type, const Value &constant,
+                                             ExpressionType comparison) {
+    if (MSOLAPComparisonOperator(comparison).empty() || !CanPushLiteral(type, constant)) {
+        return false;
+    }
+    // String comparisons are case-insensitive in DAX: only equality yields a superset
+    if (type.id() == LogicalTypeId::VARCHAR) {
+        return comparison == ExpressionType::COMPARE_EQUAL;
+    }
+    return true;
+}
+
+bool MSOLAPFilterPushdown::Translate(const TableFilter &filter, const string &column, const LogicalType &type) {
+    switch (filter.filter_type) {
+    case TableFilterType::CONSTANT_COMPARISON: {
+        auto &constant_filter = filter.Cast<ConstantFilter>();
+        if (!CanPushComparison(type, constant_filter.constant, constant_filter.comparison_type)) {
+            return false;
+        }
+        string literal = MSOLAPDax::ToLiteral(constant_filter.constant);
+        string predicate = column + " " + MSOLAPComparisonOperator(constant_filter.comparison_type) + " " + literal;
+        if (exact) {
+            // BLANK compares like 0 or "", and = ignores case
+            predicate = "NOT ISBLANK(" + column + ") && " +
+                        (type.id() == LogicalTypeId::VARCHAR ? "EXACT(" + column + ", " + literal + ")" : predicate);
+        }
+        conditions.push_back({predicate, predicate});
+        pushdowns.push_back(predicate);
+        return true;
+    }
+    case TableFilterType::IN_FILTER: {
+        auto &in_filter = filter.Cast<InFilter>();
+        if (in_filter.values.empty() || in_filter.values.size() > key_threshold ||
+            (exact && type.id() == LogicalTypeId::VARCHAR)) {
+            return false;
+        }
+        vector<string> literals;
+        for (auto &value : in_filter.values) {
+            if (!CanPushLiteral(type, value)) {
+                return false;
+            }
+            literals.push_back(MSOLAPDax::ToLiteral(value));
+        }
+        string keys = MSOLAPDax::TableConstructor(literals);
+        string predicate = column + " IN " + keys;
+        if (exact) {
+            predicate = "NOT ISBLANK(" + column + ") && " + predicate;
+        }
+        conditions.push_back({predicate, "TREATAS(" + keys + ", " + column + ")"});
+        pushdowns.push_back(column + " IN " + to_string(literals.size()) + " keys");
+        return true;
+    }
+    case TableFilterType::IS_NULL: {
+        string predicate = "ISBLANK(" + column + ")";
+        conditions.push_back({predicate, predicate});
+        pushdowns.push_back(predicate);
+        return true;
+    }
+    case TableFilterType::IS_NOT_NULL: {
+        string predicate = "NOT ISBLANK(" + column + ")";
+        conditions.push_back({predicate, predicate});
+        pushdowns.push_back(predicate);
+        return true;
+    }
+    case TableFilterType::CONJUNCTION_AND: {
+        // Pushing a subset of the children is fine, the rest is checked locally
+        bool pushed = false;
+        bool complete = true;
+        for (auto &child : filter.Cast<ConjunctionAndFilter>().child_filters) {
+            bool translated = Translate(*child, column, type);
+            pushed = translated || pushed;
+            complete = translated && complete;
+        }
+        return exact ? complete : pushed;
+    }
+    case TableFilterType::OPTIONAL_FILTER: {
+        auto &optional_filter = filter.Cast<OptionalFilter>();
+        bool translated = optional_filter.child_filter && Translate(*optional_filter.child_filter, column, type);
+        // The filter it stands in for is applied elsewhere in the plan anyway
+        return translated || exact;
+    }
+    case TableFilterType::DYNAMIC_FILTER: {
+        auto &filter_data = filter.Cast<DynamicFilter>().filter_data;
+        if (!filter_data) {
+            return false;
+        }
+        lock_guard<mutex> guard(filter_data->lock);
+        return filter_data->initialized && Translate(*filter_data->filter, column, type);
+    }
+    default:
+        return false;
+    }
+}
+
+bool MSOLAPFilterPushdown::AddFilters(const TableFilterSet &filters, const vector<column_t> &column_ids) {
+    bool complete = true;
+    for (auto &entry : filters.filters) {
+        if (entry.first >= column_ids.size() || column_ids[entry.first] >= column_references.size()) {
+            complete = false;
+            continue;
+        }
+        auto column_index = column_ids[entry.first];
+        complete = Translate(*entry.second, MSOLAPDax::ColumnReference(column_references[column_index]),
+                             types[column_index]) &&
+                   complete;
+    }
+    return complete;
+}
+
+string MSOLAPFilterPushdown::Rewrite(const string &dax_query, const vector<string> &predicates) const {
+    if ((conditions.empty() && predicates.empty()) || !MSOLAPDax::IsSimpleEvaluate(dax_query)) {
+        return dax_query;
+    }
+    string table = MSOLAPDax::TableExpression(dax_query);
+    if (MSOLAPDax::IsTableName(table)) {
+        // Plain table scan: filter arguments let the storage engine apply the keys
+        vector<string> arguments;
+        for (auto &condition : conditions) {
+            arguments.push_back(condition.table_filter);
+        }
+        arguments.insert(arguments.end(), predicates.begin(), predicates.end());
+        return "EVALUATE CALCULATETABLE(" + table + ", " + StringUtil::Join(arguments, ", ") + ")";
+    }
+    // Arbitrary table expression: filter its rows without changing its filter context
+    vector<string> row_predicates;
+    for (auto &condition : conditions) {
+        row_predicates.push_back("(" + condition.predicate + ")");
+    }
+    for (auto &predicate : predicates) {
+        row_predicates.push_back("(" + predicate + ")");
+    }
+    return "EVALUATE FILTER(" + table + ", " + StringUtil::Join(row_predicates, " && ") + ")";
+}
+
+idx_t MSOLAPFilterPushdown::KeyThreshold(ClientContext &context) {
+    Value setting;
+    if (context.TryGetCurrentSetting("msolap_join_key_threshold", setting) && !setting.IsNull()) {
+        return setting.GetValue<idx_t>();
+    }
+    return MSOLAP_DEFAULT_JOIN_KEY_THRESHOLD;
+}
+
+unique_ptr<Expression> MSOLAPFilterPushdown::LocalFilter(const TableFilterSet &filters,
+                                                         const vector<column_t> &column_ids,
+                                                         const vector<LogicalType> &types) {
+    vector<unique_ptr<Expression>> children;
+    for (auto &entry : filters.filters) {
+        // Virtual columns (the row id) have no result column to re-check, like in AddFilters
+        if (entry.first >= column_ids.size() || column_ids[entry.first] >= types.size()) {
+            continue;
+        }
+        // The output chunk holds the projected columns, in column_ids order
+        BoundReferenceExpression column(types[column_ids[entry.first]], entry.first);
+        children.push_back(entry.second->ToExpression(column));
+    }
+    if (children.empty()) {
+        return nullptr;
+    }
+    if (children.size() == 1) {
+        return std::move(children[0]);
+    }
+    auto result = make_uniq<BoundConjunctionExpression>(ExpressionType::CONJUNCTION_AND);
+    result->children = std::move(children);
+    return std::move(result);
+}
+
+void MSOLAPLocalFilter::Initialize(ClientContext &context, const Expression *filter_p) {
+    if (!filter_p) {
+        return;
+    }
+    filter = filter_p->Copy();
+    executor = make_uniq<ExpressionExecutor>(context, *filter);
+    selection.Initialize(STANDARD_VECTOR_SIZE);
+}
+
+bool MSOLAPLocalFilter::Apply(DataChunk &output) {
+    if (!executor || output.size() == 0) {
+        return true;
+    }
+    // The server applies the pushed filters with DAX semantics, keep what DuckDB would
+    idx_t selected = executor->SelectExpression(output, selection);
+    if (selected == output.size()) {
+        return true;
+    }
+    if (selected > 0) {
+        output.Slice(selection, selected);
+        return true;
+    }
+    output.Reset();
+    return false;
+}
+
+} // namespace duckdb
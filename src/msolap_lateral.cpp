@@ -0,0 +1,108 @@
+#include "msolap_lateral.hpp"
+#include "msolap_dax.hpp"
+#include <stdexcept>
+#include <unordered_set>
+
+namespace duckdb {
+
+string MSOLAPLateralBindData::BuildQuery(const vector<string> &key_literals) const {
+    // GENERATE iterates the keys, CALCULATETABLE turns each key row into a filter
+    // on key_column, so the result carries the key next to the template's columns
+    return "EVALUATE GENERATE(TREATAS(" + MSOLAPDax::TableConstructor(key_literals) + ", " + key_column +
+           "), CALCULATETABLE(" + dax_template + "))";
+}
+
+static unique_ptr<FunctionData> MSOLAPLateralBind(ClientContext &context, TableFunctionBindInput &input,
+                                                  vector<LogicalType> &return_types, vector<string> &names) {
+    auto result = make_uniq<MSOLAPLateralBindData>();
+
+    if (input.input_table_types.empty()) {
+        throw std::runtime_error("msolap_lateral requires a subquery producing the keys as first argument");
+    }
+    if (input.input_table_types.size() != 1) {
+        throw std::runtime_error("msolap_lateral expects a subquery producing a single key column, it produces " +
+                                 std::to_string(input.input_table_types.size()));
+    }
+    result->connection_string = input.inputs[0].GetValue<string>();
+    result->dax_template = MSOLAPDax::TableExpression(input.inputs[1].GetValue<string>());
+    result->key_column = input.inputs[2].GetValue<string>();
+
+    // Same shape as the per-chunk query, with a key table that is guaranteed empty
+    string describe_query = "EVALUATE GENERATE(FILTER(VALUES(" + result->key_column + "), FALSE()), CALCULATETABLE(" +
+                            result->dax_template + "))";
+    MSOLAPRowsetReader::Describe(context, result->connection_string, describe_query, result->names, result->types);
+
+    if (result->names.empty()) {
+        throw std::runtime_error("No columns found in DAX query result");
+    }
+    names = result->names;
+    return_types = result->types;
+
+    return std::move(result);
+}
+
+static unique_ptr<LocalTableFunctionState> MSOLAPLateralInitLocalState(ExecutionContext &context,
+                                                                       TableFunctionInitInput &input,
+                                                                       GlobalTableFunctionState *global_state) {
+    return make_uniq<MSOLAPLateralLocalState>();
+}
+
+static OperatorResultType MSOLAPLateralInOut(ExecutionContext &context, TableFunctionInput &data,
+                                                DataChunk &input, DataChunk &output) {
+    auto &bind_data = data.bind_data->Cast<MSOLAPLateralBindData>();
+    auto &state = data.local_state->Cast<MSOLAPLateralLocalState>();
+
+    if (!state.executing) {
+        // Collect the distinct keys of this input chunk
+        vector<string> key_literals;
+        std::unordered_set<string> seen;
+        for (idx_t row = 0; row < input.size(); row++) {
+            Value key = input.data[0].GetValue(row);
+            if (key.IsNull()) {
+                continue;
+            }
+            string literal = MSOLAPDax::ToLiteral(key);
+            if (seen.insert(literal).second) {
+                key_literals.push_back(std::move(literal));
+            }
+        }
+        if (key_literals.empty()) {
+            output.SetCardinality(0);
+            return OperatorResultType::NEED_MORE_INPUT;
+        }
+
+        state.reader.Open(context.client, bind_data.connection_string, bind_data.BuildQuery(key_literals));
+        state.executing = true;
+    }
+
+    idx_t count = state.reader.Read(output);
+    if (count == 0) {
+        state.reader.Close();
+        state.executing = false;
+        output.SetCardinality(0);
+        return OperatorResultType::NEED_MORE_INPUT;
+    }
+    output.SetCardinality(count);
+    return OperatorResultType::HAVE_MORE_OUTPUT;
+}
+
+static InsertionOrderPreservingMap<string> MSOLAPLateralToString(TableFunctionToStringInput &input) {
+    InsertionOrderPreservingMap<string> result;
+    auto &bind_data = input.bind_data->Cast<MSOLAPLateralBindData>();
+
+    result["Connection"] = bind_data.connection_string;
+    result["Template"] = bind_data.dax_template;
+    result["Key"] = bind_data.key_column;
+
+    return result;
+}
+
+MSOLAPLateralFunction::MSOLAPLateralFunction()
+    : TableFunction("msolap_lateral",
+                    {LogicalType::TABLE, LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::VARCHAR}, nullptr,
+                    MSOLAPLateralBind, nullptr, MSOLAPLateralInitLocalState) {
+    in_out_function = MSOLAPLateralInOut;
+    to_string = MSOLAPLateralToString;
+}
+
+} // namespace duckdb
@@ -0,0 +1,434 @@
+#include "msolap_mdx.hpp"
+#include "msolap_utils.hpp"
+#include <chrono>
+#include <stdexcept>
+
+namespace duckdb {
+
+// Rows requested per GetNextRows call while reading an axis rowset
+static constexpr DBROWCOUNT MSOLAP_AXIS_FETCH_SIZE = 1024;
+
+//===--------------------------------------------------------------------===//
+// MSOLAPCellset
+//===--------------------------------------------------------------------===//
+
+MSOLAPCellset::MSOLAPCellset()
+    : logged(true), command(nullptr), dataset(nullptr), accessor(nullptr), haccessor(NULL) {
+}
+
+MSOLAPCellset::~MSOLAPCellset() {
+    Close();
+}
+
+// Caption columns of an axis rowset: "<dimension>.[MEMBER_CAPTION]", which is the
+// second column of each dimension's block after the leading TUPLE_ORDINAL
+static vector<DBORDINAL> MSOLAPCaptionOrdinals(const MDAXISINFO &info, DBCOLUMNINFO *columns, DBORDINAL column_count) {
+    vector<DBCOLUMNINFO *> data_columns;
+    for (DBORDINAL i = 0; i < column_count; i++) {
+        if (columns[i].iOrdinal != 0) {
+            data_columns.push_back(&columns[i]);
+        }
+    }
+
+    vector<DBORDINAL> ordinals;
+    DBORDINAL block_start = 1;
+    for (DBCOUNTITEM dimension = 0; dimension < info.cDimensions; dimension++) {
+        std::wstring caption_name = std::wstring(info.rgpwszDimensionNames[dimension]) + L".[MEMBER_CAPTION]";
+        DBCOLUMNINFO *caption = nullptr;
+        for (auto column : data_columns) {
+            if (column->pwszName && caption_name == column->pwszName) {
+                caption = column;
+                break;
+            }
+        }
+        if (!caption && block_start + 1 < data_columns.size()) {
+            caption = data_columns[block_start + 1];
+        }
+        if (!caption) {
+            throw std::runtime_error("MDX axis rowset has no caption column for dimension " +
+                                     WindowsUtil::UnicodeToUTF8(info.rgpwszDimensionNames[dimension]));
+        }
+        ordinals.push_back(caption->iOrdinal);
+        block_start += info.rgcColumns[dimension];
+    }
+    return ordinals;
+}
+
+// Read the member captions of every tuple on one axis
+static MSOLAPCellsetAxis MSOLAPReadAxis(IMDDataset *dataset, const MDAXISINFO &info) {
+    MSOLAPCellsetAxis axis;
+    for (DBCOUNTITEM dimension = 0; dimension < info.cDimensions; dimension++) {
+        axis.dimension_names.push_back(MSOLAPUtils::SanitizeColumnName(info.rgpwszDimensionNames[dimension]));
+    }
+    if (info.cDimensions == 0) {
+        return axis;
+    }
+
+    IRowset* axis_rowset = nullptr;
+    IColumnsInfo* columns_info = nullptr;
+    IAccessor* axis_accessor = nullptr;
+    HACCESSOR axis_haccessor = NULL;
+    DBCOLUMNINFO* column_info = nullptr;
+    WCHAR* strings_buffer = nullptr;
+    auto cleanup = [&]() {
+        if (axis_accessor && axis_haccessor) {
+            axis_accessor->ReleaseAccessor(axis_haccessor, NULL);
+        }
+        CoTaskMemFree(column_info);
+        CoTaskMemFree(strings_buffer);
+        MSOLAPUtils::SafeRelease(&axis_accessor);
+        MSOLAPUtils::SafeRelease(&columns_info);
+        MSOLAPUtils::SafeRelease(&axis_rowset);
+    };
+
+    try {
+        HRESULT hr = dataset->GetAxisRowset(NULL, info.iAxis, IID_IRowset, 0, NULL, (IUnknown**)&axis_rowset);
+        if (FAILED(hr)) {
+            throw std::runtime_error("Failed to get axis rowset: " + MSOLAPUtils::GetErrorMessage(hr));
+        }
+        hr = axis_rowset->QueryInterface(IID_IColumnsInfo, (void**)&columns_info);
+        if (FAILED(hr)) {
+            throw std::runtime_error("Failed to get IColumnsInfo: " + MSOLAPUtils::GetErrorMessage(hr));
+        }
+        DBORDINAL column_count = 0;
+        hr = columns_info->GetColumnInfo(&column_count, &column_info, &strings_buffer);
+        if (FAILED(hr)) {
+            throw std::runtime_error("Failed to get column info: " + MSOLAPUtils::GetErrorMessage(hr));
+        }
+
+        // Bind only the caption of each dimension
+        auto ordinals = MSOLAPCaptionOrdinals(info, column_info, column_count);
+        vector<DBBINDING> bindings(ordinals.size());
+        for (idx_t i = 0; i < ordinals.size(); i++) {
+            auto &binding = bindings[i];
+            memset(&binding, 0, sizeof(DBBINDING));
+            binding.iOrdinal = ordinals[i];
+            binding.obValue = i * sizeof(ColumnData) + offsetof(ColumnData, var);
+            binding.obLength = i * sizeof(ColumnData) + offsetof(ColumnData, dwLength);
+            binding.obStatus = i * sizeof(ColumnData) + offsetof(ColumnData, dwStatus);
+            binding.cbMaxLen = sizeof(VARIANT);
+            binding.eParamIO = DBPARAMIO_NOTPARAM;
+            binding.dwPart = DBPART_VALUE | DBPART_LENGTH | DBPART_STATUS;
+            binding.dwMemOwner = DBMEMOWNER_CLIENTOWNED;
+            binding.wType = DBTYPE_VARIANT;
+        }
+        hr = axis_rowset->QueryInterface(IID_IAccessor, (void**)&axis_accessor);
+        if (FAILED(hr)) {
+            throw std::runtime_error("Failed to get IAccessor: " + MSOLAPUtils::GetErrorMessage(hr));
+        }
+        hr = axis_accessor->CreateAccessor(DBACCESSOR_ROWDATA, bindings.size(), bindings.data(),
+                                           bindings.size() * sizeof(ColumnData), &axis_haccessor, NULL);
+        if (FAILED(hr)) {
+            throw std::runtime_error("Failed to create accessor: " + MSOLAPUtils::GetErrorMessage(hr));
+        }
+
+        // Tuples come in ordinal order
+        vector<ColumnData> row(bindings.size());
+        HROW row_handles[MSOLAP_AXIS_FETCH_SIZE];
+        while (true) {
+            DBCOUNTITEM obtained = 0;
+            HROW* rows = row_handles;
+            hr = axis_rowset->GetNextRows(0, 0, MSOLAP_AXIS_FETCH_SIZE, &obtained, &rows);
+            if (FAILED(hr)) {
+                throw std::runtime_error("Failed to read axis tuples: " + MSOLAPUtils::GetErrorMessage(hr));
+            }
+            for (DBCOUNTITEM i = 0; i < obtained; i++) {
+                memset(row.data(), 0, row.size() * sizeof(ColumnData));
+                HRESULT data_hr = axis_rowset->GetData(row_handles[i], axis_haccessor, row.data());
+                for (auto &member : row) {
+                    Value caption = SUCCEEDED(data_hr) && member.dwStatus == DBSTATUS_S_OK
+                                        ? MSOLAPUtils::ConvertVariantToValue(&member.var)
+                                        : Value();
+                    axis.members.push_back(caption.IsNull() ? string() : caption.ToString());
+                    VariantClear(&member.var);
+                }
+            }
+            if (obtained > 0) {
+                axis_rowset->ReleaseRows(obtained, row_handles, NULL, NULL, NULL);
+            }
+            if (hr == DB_S_ENDOFROWSET || obtained == 0) {
+                break;
+            }
+        }
+    } catch (...) {
+        cleanup();
+        throw;
+    }
+    cleanup();
+    return axis;
+}
+
+void MSOLAPCellset::ReadAxes() {
+    DBCOUNTITEM axis_count = 0;
+    MDAXISINFO* axis_info = nullptr;
+    HRESULT hr = dataset->GetAxisInfo(&axis_count, &axis_info);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to get axis info: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+
+    vector<MSOLAPCellsetAxis> axes;
+    try {
+        for (DBCOUNTITEM i = 0; i < axis_count; i++) {
+            // The slicer (WHERE) axis doesn't contribute rows or columns
+            if (axis_info[i].iAxis == MDAXIS_SLICERS) {
+                continue;
+            }
+            axes.push_back(MSOLAPReadAxis(dataset, axis_info[i]));
+        }
+    } catch (...) {
+        dataset->FreeAxisInfo(axis_count, axis_info);
+        throw;
+    }
+    dataset->FreeAxisInfo(axis_count, axis_info);
+    layout = make_uniq<MSOLAPCellsetLayout>(std::move(axes));
+}
+
+void MSOLAPCellset::Execute(ClientContext &context, const string &connection_string_p, const string &mdx_query_p) {
+    connection_string = connection_string_p;
+    mdx_query = mdx_query_p;
+    metrics = MSOLAPScanMetrics();
+    Value log_file_setting;
+    if (context.TryGetCurrentSetting("msolap_query_log_file", log_file_setting) && !log_file_setting.IsNull()) {
+        log_file = log_file_setting.ToString();
+    }
+    logged = false;
+
+    try {
+        MSOLAPConnection::WorkerPool().Run([&]() {
+            auto phase_start = std::chrono::steady_clock::now();
+            connection = MSOLAPConnection::Connect(connection_string);
+            auto phase_end = std::chrono::steady_clock::now();
+            metrics.connect_seconds = std::chrono::duration<double>(phase_end - phase_start).count();
+
+            phase_start = phase_end;
+            command = connection.CreateCommand(mdx_query);
+            watchdog.Start(command, context, MSOLAPRowsetReader::GetQueryTimeout(context));
+            dataset = connection.ExecuteDataset(command);
+            phase_end = std::chrono::steady_clock::now();
+            metrics.execute_seconds = std::chrono::duration<double>(phase_end - phase_start).count();
+
+            // Axes are small compared to the cells: read them completely, once
+            phase_start = phase_end;
+            ReadAxes();
+
+            // Cells are read through an accessor on the VALUE cell property (ordinal 1)
+            HRESULT hr = dataset->QueryInterface(IID_IAccessor, (void**)&accessor);
+            if (FAILED(hr)) {
+                throw std::runtime_error("Failed to get IAccessor: " + MSOLAPUtils::GetErrorMessage(hr));
+            }
+            DBBINDING binding;
+            memset(&binding, 0, sizeof(DBBINDING));
+            binding.iOrdinal = 1;
+            binding.obValue = offsetof(ColumnData, var);
+            binding.obLength = offsetof(ColumnData, dwLength);
+            binding.obStatus = offsetof(ColumnData, dwStatus);
+            binding.cbMaxLen = sizeof(VARIANT);
+            binding.eParamIO = DBPARAMIO_NOTPARAM;
+            binding.dwPart = DBPART_VALUE | DBPART_LENGTH | DBPART_STATUS;
+            binding.dwMemOwner = DBMEMOWNER_CLIENTOWNED;
+            binding.wType = DBTYPE_VARIANT;
+            hr = accessor->CreateAccessor(DBACCESSOR_ROWDATA, 1, &binding, sizeof(ColumnData), &haccessor, NULL);
+            if (FAILED(hr)) {
+                throw std::runtime_error("Failed to create cell accessor: " + MSOLAPUtils::GetErrorMessage(hr));
+            }
+            scan_start = std::chrono::steady_clock::now();
+            metrics.fetch_seconds += std::chrono::duration<double>(scan_start - phase_start).count();
+        });
+    } catch (std::exception &e) {
+        metrics.status = "failed";
+        watchdog.CheckCancelled();
+        throw std::runtime_error("MSOLAP MDX execution failed: " + string(e.what()));
+    }
+}
+
+void MSOLAPCellset::FetchCells(idx_t first, idx_t count, vector<ColumnData> &cells) {
+    cells.resize(count);
+    if (count == 0) {
+        return;
+    }
+    memset(cells.data(), 0, count * sizeof(ColumnData));
+    auto start = std::chrono::steady_clock::now();
+    HRESULT hr = MSOLAPConnection::WorkerPool().Run(
+        [&]() { return dataset->GetCellData(haccessor, first, first + count - 1, cells.data()); });
+    auto end = std::chrono::steady_clock::now();
+    if (FAILED(hr)) {
+        watchdog.CheckCancelled();
+        metrics.status = "failed";
+        throw std::runtime_error("Failed to get cell data: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+    metrics.fetch_seconds += std::chrono::duration<double>(end - start).count();
+    metrics.batches++;
+    if (!metrics.first_row_seen) {
+        metrics.first_row_seen = true;
+        metrics.first_row_seconds = std::chrono::duration<double>(end - scan_start).count();
+    }
+}
+
+vector<LogicalType> MSOLAPCellset::InferValueTypes(idx_t sample_rows) {
+    idx_t value_columns = layout->ValueColumnCount();
+    vector<LogicalType> types(value_columns, LogicalType::SQLNULL);
+    idx_t rows = MinValue<idx_t>(sample_rows, layout->RowCount());
+    vector<ColumnData> cells;
+    FetchCells(0, rows * value_columns, cells);
+    for (idx_t i = 0; i < cells.size(); i++) {
+        auto &type = types[i % value_columns];
+        if (type.id() == LogicalTypeId::SQLNULL && cells[i].dwStatus == DBSTATUS_S_OK &&
+            cells[i].var.vt != VT_EMPTY && cells[i].var.vt != VT_NULL) {
+            type = MSOLAPUtils::GetLogicalTypeFromDBTYPE((DBTYPE)cells[i].var.vt);
+        }
+        VariantClear(&cells[i].var);
+    }
+    for (auto &type : types) {
+        if (type.id() == LogicalTypeId::SQLNULL) {
+            // Empty in the sample, measures are numeric most of the time
+            type = LogicalType::DOUBLE;
+        }
+    }
+    return types;
+}
+
+void MSOLAPCellset::Release() {
+    if (accessor && haccessor) {
+        accessor->ReleaseAccessor(haccessor, NULL);
+        haccessor = NULL;
+    }
+    MSOLAPUtils::SafeRelease(&accessor);
+    MSOLAPUtils::SafeRelease(&dataset);
+    MSOLAPUtils::SafeRelease(&command);
+    connection.Close();
+}
+
+void MSOLAPCellset::Close() {
+    watchdog.Stop();
+    if (!logged) {
+        logged = true;
+        if (metrics.status == "running") {
+            metrics.status = watchdog.Interrupted() ? "interrupted" : watchdog.TimedOut() ? "timed out" : "completed";
+        }
+        try {
+            MSOLAPQueryLog::Get().Record(connection_string, mdx_query, metrics, log_file);
+        } catch (...) {
+            // Telemetry must never fail the query
+        }
+    }
+    try {
+        MSOLAPConnection::WorkerPool().Run([&]() { Release(); });
+    } catch (...) {
+        // Close also runs from destructors
+    }
+}
+
+//===--------------------------------------------------------------------===//
+// msolap_mdx() table function
+//===--------------------------------------------------------------------===//
+
+// Rows whose cells are sampled at bind time to type the value columns
+static constexpr idx_t MSOLAP_MDX_TYPE_SAMPLE_ROWS = 100;
+
+struct MSOLAPMdxGlobalState : public GlobalTableFunctionState {
+    MSOLAPCellset cellset;
+    idx_t row = 0;
+    vector<ColumnData> cells;
+};
+
+static unique_ptr<FunctionData> MSOLAPMdxBind(ClientContext &context, TableFunctionBindInput &input,
+                                              vector<LogicalType> &return_types, vector<string> &names) {
+    auto result = make_uniq<MSOLAPMdxBindData>();
+    result->connection_string = input.inputs[0].GetValue<string>();
+    result->mdx_query = input.inputs[1].GetValue<string>();
+
+    // The shape of a cellset is only known from its axes, so bind executes the statement
+    MSOLAPCellset cellset;
+    cellset.Execute(context, result->connection_string, result->mdx_query);
+    auto &layout = *cellset.layout;
+    result->names = layout.ColumnNames();
+    result->types = vector<LogicalType>(layout.MemberColumnCount(), LogicalType::VARCHAR);
+    auto value_types = cellset.InferValueTypes(MSOLAP_MDX_TYPE_SAMPLE_ROWS);
+    result->types.insert(result->types.end(), value_types.begin(), value_types.end());
+    cellset.Close();
+
+    if (result->names.empty()) {
+        throw std::runtime_error("MDX query returned no axes or cells");
+    }
+    names = result->names;
+    return_types = result->types;
+    return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> MSOLAPMdxInit(ClientContext &context, TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<MSOLAPMdxBindData>();
+    auto result = make_uniq<MSOLAPMdxGlobalState>();
+    result->cellset.Execute(context, bind_data.connection_string, bind_data.mdx_query);
+    auto &layout = *result->cellset.layout;
+    if (layout.MemberColumnCount() + layout.ValueColumnCount() != bind_data.types.size()) {
+        throw std::runtime_error("MDX result shape changed between bind and execution");
+    }
+    return std::move(result);
+}
+
+static void MSOLAPMdxScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+    auto &bind_data = data.bind_data->Cast<MSOLAPMdxBindData>();
+    auto &state = data.global_state->Cast<MSOLAPMdxGlobalState>();
+    auto &cellset = state.cellset;
+    auto &layout = *cellset.layout;
+
+    idx_t rows = MinValue<idx_t>(STANDARD_VECTOR_SIZE, layout.RowCount() - state.row);
+    if (rows == 0) {
+        cellset.Close();
+        output.SetCardinality(0);
+        return;
+    }
+
+    // The cells of consecutive rows are one ordinal range: a single GetCellData per chunk
+    idx_t member_columns = layout.MemberColumnCount();
+    idx_t value_columns = layout.ValueColumnCount();
+    cellset.FetchCells(layout.CellOrdinal(state.row, 0), rows * value_columns, state.cells);
+
+    auto convert_start = std::chrono::steady_clock::now();
+    for (idx_t row = 0; row < rows; row++) {
+        for (idx_t column = 0; column < member_columns; column++) {
+            output.SetValue(column, row, Value(layout.Member(state.row + row, column)));
+        }
+        for (idx_t column = 0; column < value_columns; column++) {
+            auto &cell = state.cells[row * value_columns + column];
+            Value value;
+            if (cell.dwStatus == DBSTATUS_S_OK) {
+                value = MSOLAPUtils::ConvertVariantToValue(&cell.var);
+                cellset.metrics.bytes += cell.var.vt == VT_BSTR && cell.var.bstrVal
+                                             ? SysStringByteLen(cell.var.bstrVal)
+                                             : sizeof(cell.var.llVal);
+                // Cells of one column may mix types (e.g. an error string in a numeric measure): fail
+                // rather than read a cell that does not fit the sampled type as NULL
+                auto &type = bind_data.types[member_columns + column];
+                Value cast_value;
+                if (!value.IsNull() && !value.DefaultTryCastAs(type, cast_value)) {
+                    for (auto &pending : state.cells) {
+                        VariantClear(&pending.var);
+                    }
+                    cellset.metrics.status = "failed";
+                    throw std::runtime_error("MSOLAP MDX column \"" + bind_data.names[member_columns + column] +
+                                             "\" was typed " + type.ToString() + " from the first " +
+                                             std::to_string(MSOLAP_MDX_TYPE_SAMPLE_ROWS) +
+                                             " rows of the cellset, but a later cell holds the " +
+                                             value.type().ToString() + " value " + value.ToString());
+                }
+                value = value.IsNull() ? value : cast_value;
+            }
+            VariantClear(&cell.var);
+            output.SetValue(member_columns + column, row, value);
+        }
+    }
+    cellset.metrics.convert_seconds +=
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - convert_start).count();
+    cellset.metrics.rows += rows;
+
+    state.row += rows;
+    output.SetCardinality(rows);
+}
+
+MSOLAPMdxFunction::MSOLAPMdxFunction()
+    : TableFunction("msolap_mdx", {LogicalType::VARCHAR, LogicalType::VARCHAR}, MSOLAPMdxScan, MSOLAPMdxBind,
+                    MSOLAPMdxInit) {
+}
+
+} // namespace duckdb
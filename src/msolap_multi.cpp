@@ -0,0 +1,310 @@
+#include "msolap_multi.hpp"
+#include "msolap_connection.hpp"
+#include "duckdb/common/string_util.hpp"
+#include <exception>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+namespace duckdb {
+
+MSOLAPMultiScheduler::MSOLAPMultiScheduler(const vector<MSOLAPMultiSource> &sources, idx_t max_per_server)
+    : sources(sources), max_per_server(MaxValue<idx_t>(max_per_server, 1)), claimed(sources.size(), false),
+      first_unclaimed(0) {
+}
+
+bool MSOLAPMultiScheduler::Claim(ClientContext &context, idx_t &source_idx) {
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        if (TryClaimLocked(source_idx)) {
+            return true;
+        }
+        if (first_unclaimed >= sources.size()) {
+            return false;
+        }
+        // Every remaining source targets a saturated server, wait for a slot
+        cv.wait_for(guard, std::chrono::milliseconds(100));
+        if (context.interrupted) {
+            throw InterruptException();
+        }
+    }
+}
+
+bool MSOLAPMultiScheduler::TryClaim(idx_t &source_idx) {
+    std::lock_guard<std::mutex> guard(lock);
+    return TryClaimLocked(source_idx);
+}
+
+bool MSOLAPMultiScheduler::TryClaimLocked(idx_t &source_idx) {
+    while (first_unclaimed < sources.size() && claimed[first_unclaimed]) {
+        first_unclaimed++;
+    }
+    // Take the first remaining source whose server still has a free slot
+    for (idx_t i = first_unclaimed; i < sources.size(); i++) {
+        if (claimed[i]) {
+            continue;
+        }
+        auto &active = active_per_server[sources[i].server];
+        if (active < max_per_server) {
+            active++;
+            claimed[i] = true;
+            source_idx = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void MSOLAPMultiScheduler::Release(idx_t source_idx) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        active_per_server[sources[source_idx].server]--;
+    }
+    cv.notify_all();
+}
+
+static unique_ptr<FunctionData> MSOLAPMultiBind(ClientContext &context, TableFunctionBindInput &input,
+                                                vector<LogicalType> &return_types, vector<string> &names) {
+    auto result = make_uniq<MSOLAPMultiBindData>();
+    result->max_per_server = MSOLAP_MULTI_DEFAULT_MAX_PER_SERVER;
+
+    for (auto &kv : input.named_parameters) {
+        if (kv.first == "max_per_server") {
+            result->max_per_server = kv.second.GetValue<idx_t>();
+        }
+    }
+
+    // Unpack the list of {conn, dax} structs
+    if (input.inputs[0].IsNull()) {
+        throw std::runtime_error("msolap_multi requires a list of {conn, dax} structs");
+    }
+    for (auto &entry : ListValue::GetChildren(input.inputs[0])) {
+        // A NULL element has no children to look at
+        if (entry.IsNull() || StructValue::GetChildren(entry)[0].IsNull() ||
+            StructValue::GetChildren(entry)[1].IsNull()) {
+            throw std::runtime_error("msolap_multi: conn and dax must not be NULL");
+        }
+        auto &fields = StructValue::GetChildren(entry);
+        MSOLAPMultiSource source;
+        source.connection_string = fields[0].GetValue<string>();
+        source.dax_query = fields[1].GetValue<string>();
+        source.server = MSOLAPConnection::GetDataSource(source.connection_string);
+        result->sources.push_back(std::move(source));
+    }
+    if (result->sources.empty()) {
+        throw std::runtime_error("msolap_multi requires at least one source");
+    }
+
+    // Discover all schemas concurrently, honouring the per-server cap
+    auto source_count = result->sources.size();
+    vector<vector<string>> source_names(source_count);
+    vector<vector<LogicalType>> source_types(source_count);
+    vector<std::exception_ptr> errors(source_count);
+    MSOLAPMultiScheduler scheduler(result->sources, result->max_per_server);
+
+    // Each describe holds a pool worker while it executes; the binding thread only
+    // waits for server slots
+    auto &pool = MSOLAPConnection::WorkerPool();
+    vector<std::future<void>> describes(source_count);
+    auto wait_describes = [&]() {
+        for (auto &describe : describes) {
+            if (describe.valid()) {
+                describe.wait();
+            }
+        }
+    };
+    try {
+        idx_t source_idx;
+        while (scheduler.Claim(context, source_idx)) {
+            describes[source_idx] = pool.Async([&, source_idx]() {
+                auto &source = result->sources[source_idx];
+                try {
+                    MSOLAPRowsetReader::Describe(context, source.connection_string, source.dax_query,
+                                                 source_names[source_idx], source_types[source_idx]);
+                } catch (...) {
+                    errors[source_idx] = std::current_exception();
+                }
+                scheduler.Release(source_idx);
+            });
+        }
+    } catch (...) {
+        // Interrupted: the running describes use this frame's state
+        wait_describes();
+        throw;
+    }
+    wait_describes();
+    if (context.interrupted) {
+        throw InterruptException();
+    }
+
+    for (idx_t i = 0; i < source_count; i++) {
+        if (!errors[i]) {
+            continue;
+        }
+        try {
+            std::rethrow_exception(errors[i]);
+        } catch (std::exception &e) {
+            throw std::runtime_error("msolap_multi source " + std::to_string(i) + ": " + e.what());
+        }
+    }
+
+    // All sources have to be union compatible with the first one
+    result->names = source_names[0];
+    result->types = source_types[0];
+    for (idx_t i = 1; i < source_count; i++) {
+        if (source_types[i].size() != result->types.size()) {
+            throw std::runtime_error("msolap_multi source " + std::to_string(i) + " returns " +
+                                     std::to_string(source_types[i].size()) + " columns, source 0 returns " +
+                                     std::to_string(result->types.size()));
+        }
+        for (idx_t col = 0; col < result->types.size(); col++) {
+            // Rows are unioned by position, a different name means a different column
+            if (!StringUtil::CIEquals(source_names[i][col], result->names[col])) {
+                throw std::runtime_error("msolap_multi source " + std::to_string(i) + " column " +
+                                         std::to_string(col + 1) + " is \"" + source_names[i][col] +
+                                         "\", source 0 names it \"" + result->names[col] + "\"");
+            }
+            LogicalType combined;
+            if (!LogicalType::TryGetMaxLogicalType(context, result->types[col], source_types[i][col], combined)) {
+                throw std::runtime_error("msolap_multi source " + std::to_string(i) + " column \"" +
+                                         source_names[i][col] + "\" of type " + source_types[i][col].ToString() +
+                                         " is not compatible with " + result->types[col].ToString());
+            }
+            result->types[col] = combined;
+        }
+    }
+    if (result->names.empty()) {
+        throw std::runtime_error("No columns found in DAX query result");
+    }
+
+    names.push_back("source_index");
+    return_types.push_back(LogicalType::INTEGER);
+    names.insert(names.end(), result->names.begin(), result->names.end());
+    return_types.insert(return_types.end(), result->types.begin(), result->types.end());
+
+    return std::move(result);
+}
+
+MSOLAPMultiGlobalState::MSOLAPMultiGlobalState(ClientContext &context, const MSOLAPMultiBindData &bind_data)
+    : context(context), bind_data(bind_data), scheduler(bind_data.sources, bind_data.max_per_server),
+      readers(bind_data.sources.size()) {
+}
+
+MSOLAPMultiGlobalState::~MSOLAPMultiGlobalState() {
+    // Sources started but never streamed (LIMIT, error) are cancelled
+    for (auto &reader : readers) {
+        if (reader) {
+            reader->Close();
+        }
+    }
+}
+
+void MSOLAPMultiGlobalState::StartSources() {
+    std::lock_guard<std::mutex> guard(lock);
+    idx_t source_idx;
+    while (scheduler.TryClaim(source_idx)) {
+        // Open returns right away, the pool connects and executes
+        auto &source = bind_data.sources[source_idx];
+        readers[source_idx] = make_uniq<MSOLAPRowsetReader>();
+        readers[source_idx]->Open(context, source.connection_string, source.dax_query);
+        started.push_back(source_idx);
+    }
+}
+
+bool MSOLAPMultiGlobalState::Next(idx_t &source_idx) {
+    while (true) {
+        StartSources();
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (handed_out == bind_data.sources.size()) {
+                return false;
+            }
+            for (idx_t i = 0; i < started.size(); i++) {
+                if (readers[started[i]]->Opened()) {
+                    source_idx = started[i];
+                    started.erase(started.begin() + i);
+                    handed_out++;
+                    return true;
+                }
+            }
+        }
+        // Nothing ready yet: the other threads stream the running sources, or the
+        // started ones are still executing
+        if (context.interrupted) {
+            throw InterruptException();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(MSOLAP_MULTI_POLL_MS));
+    }
+}
+
+void MSOLAPMultiGlobalState::Finish(idx_t source_idx) {
+    readers[source_idx]->Close();
+    // The next Next() starts the sources waiting for this server slot
+    scheduler.Release(source_idx);
+}
+
+static unique_ptr<GlobalTableFunctionState> MSOLAPMultiInitGlobalState(ClientContext &context,
+                                                                       TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<MSOLAPMultiBindData>();
+    auto result = make_uniq<MSOLAPMultiGlobalState>(context, bind_data);
+    // Execute up to max_per_server sources per server before any thread scans
+    result->StartSources();
+    return std::move(result);
+}
+
+static unique_ptr<LocalTableFunctionState> MSOLAPMultiInitLocalState(ExecutionContext &context,
+                                                                     TableFunctionInitInput &input,
+                                                                     GlobalTableFunctionState *global_state) {
+    return make_uniq<MSOLAPMultiLocalState>(global_state->Cast<MSOLAPMultiGlobalState>());
+}
+
+static void MSOLAPMultiScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+    auto &state = data.local_state->Cast<MSOLAPMultiLocalState>();
+    auto &gstate = state.global_state;
+
+    while (true) {
+        // Each thread streams one source at a time and picks the next when it drains
+        if (!state.has_source) {
+            if (!gstate.Next(state.source_idx)) {
+                output.SetCardinality(0);
+                return;
+            }
+            state.has_source = true;
+        }
+
+        idx_t count = gstate.readers[state.source_idx]->Read(output, 1);
+        if (count == 0) {
+            state.has_source = false;
+            gstate.Finish(state.source_idx);
+            continue;
+        }
+
+        auto source_index = FlatVector::GetData<int32_t>(output.data[0]);
+        for (idx_t i = 0; i < count; i++) {
+            source_index[i] = (int32_t)state.source_idx;
+        }
+        output.SetCardinality(count);
+        return;
+    }
+}
+
+static InsertionOrderPreservingMap<string> MSOLAPMultiToString(TableFunctionToStringInput &input) {
+    InsertionOrderPreservingMap<string> result;
+    auto &bind_data = input.bind_data->Cast<MSOLAPMultiBindData>();
+
+    result["Sources"] = std::to_string(bind_data.sources.size());
+    result["Max Per Server"] = std::to_string(bind_data.max_per_server);
+
+    return result;
+}
+
+MSOLAPMultiFunction::MSOLAPMultiFunction()
+    : TableFunction("msolap_multi",
+                    {LogicalType::LIST(LogicalType::STRUCT({{"conn", LogicalType::VARCHAR},
+                                                            {"dax", LogicalType::VARCHAR}}))},
+                    MSOLAPMultiScan, MSOLAPMultiBind, MSOLAPMultiInitGlobalState, MSOLAPMultiInitLocalState) {
+    named_parameters["max_per_server"] = LogicalType::UBIGINT;
+    to_string = MSOLAPMultiToString;
+}
+
+} // namespace duckdb
@@ -0,0 +1,410 @@
+#include "msolap_optimizer.hpp"
+#include "msolap_scanner.hpp"
+#include "msolap_table.hpp"
+#include "msolap_dax.hpp"
+#include "msolap_filter_pushdown.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/main/config.hpp"
+#include "duckdb/planner/expression/bound_aggregate_expression.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/operator/logical_aggregate.hpp"
+#include "duckdb/planner/operator/logical_distinct.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/planner/operator/logical_limit.hpp"
+#include "duckdb/planner/operator/logical_projection.hpp"
+#include "duckdb/planner/operator/logical_sample.hpp"
+#include <algorithm>
+
+namespace duckdb {
+
+void MSOLAPOptimizer::Register(DBConfig &config) {
+    OptimizerExtension extension;
+    extension.optimize_function = Optimize;
+    config.optimizer_extensions.push_back(std::move(extension));
+}
+
+MSOLAPBindData *MSOLAPOptimizer::GetRewritableScan(LogicalOperator &op) {
+    if (op.type != LogicalOperatorType::LOGICAL_GET) {
+        return nullptr;
+    }
+    auto &get = op.Cast<LogicalGet>();
+    // msolap_table's bind data is an MSOLAPBindData whose query is the bare table
+    if ((get.function.name != "msolap" && get.function.name != "msolap_table") || !get.bind_data) {
+        return nullptr;
+    }
+    auto &bind_data = get.bind_data->Cast<MSOLAPBindData>();
+    if (!MSOLAPDax::IsSimpleEvaluate(bind_data.dax_query) || bind_data.column_references.empty()) {
+        return nullptr;
+    }
+    return &bind_data;
+}
+
+void MSOLAPOptimizer::RewriteQuery(MSOLAPBindData &bind_data, const string &dax_query,
+                                   const vector<string> &descriptions) {
+    bind_data.dax_query = dax_query;
+    bind_data.pushdowns.insert(bind_data.pushdowns.end(), descriptions.begin(), descriptions.end());
+    bind_data.cache_directory.clear();
+    // Cancels the execution of the original query
+    bind_data.TakeBindReader();
+}
+
+bool MSOLAPOptimizer::FilteredTable(ClientContext &context, LogicalGet &get, const MSOLAPBindData &bind_data,
+                                    string &table, vector<string> &descriptions) {
+    string query = bind_data.dax_query;
+    if (!get.table_filters.filters.empty()) {
+        vector<column_t> column_ids;
+        for (auto &column : get.GetColumnIds()) {
+            column_ids.push_back(column.GetPrimaryIndex());
+        }
+        MSOLAPFilterPushdown pushdown(bind_data.column_references, bind_data.types,
+                                      MSOLAPFilterPushdown::KeyThreshold(context), true);
+        if (!pushdown.AddFilters(get.table_filters, column_ids)) {
+            return false;
+        }
+        query = pushdown.Rewrite(query);
+        descriptions.insert(descriptions.end(), pushdown.pushdowns.begin(), pushdown.pushdowns.end());
+    }
+    table = MSOLAPDax::TableExpression(query);
+    return true;
+}
+
+void MSOLAPOptimizer::ReplaceColumns(LogicalGet &get, MSOLAPBindData &bind_data, const vector<string> &names,
+                                     const vector<string> &references, const vector<LogicalType> &types) {
+    bind_data.names = names;
+    bind_data.column_references = references;
+    bind_data.types = types;
+    bind_data.column_kinds.assign(names.size(), MSOLAPValueKind::EMPTY);
+    // The new result is typed by the rewrite, not by a declaration
+    bind_data.declared_schema = false;
+
+    get.names = names;
+    get.returned_types = types;
+    get.projection_ids.clear();
+    get.table_filters.filters.clear();
+    get.ClearColumnIds();
+    for (idx_t i = 0; i < names.size(); i++) {
+        get.AddColumnId(i);
+    }
+}
+
+bool MSOLAPOptimizer::PushSample(ClientContext &context, unique_ptr<LogicalOperator> &op) {
+    if (op->type != LogicalOperatorType::LOGICAL_SAMPLE || op->children.size() != 1) {
+        return false;
+    }
+    // Off when DuckDB's exact sampling semantics are required
+    Value setting;
+    if (context.TryGetCurrentSetting("msolap_sample_pushdown", setting) && !setting.IsNull() &&
+        !setting.GetValue<bool>()) {
+        return false;
+    }
+    auto bind_data = GetRewritableScan(*op->children[0]);
+    // Filters on the scan apply before the sample; the server's superset of them
+    // re-checked locally would shrink the sample, so those samples stay local
+    if (!bind_data || !op->children[0]->Cast<LogicalGet>().table_filters.filters.empty()) {
+        return false;
+    }
+    auto &options = *op->Cast<LogicalSample>().sample_options;
+    if (options.sample_size.IsNull()) {
+        return false;
+    }
+
+    // SAMPLE picks rows spread evenly over the order of its first column, so
+    // REPEATABLE holds trivially: the same model state gives the same rows
+    string table = MSOLAPDax::TableExpression(bind_data->dax_query);
+    string order = MSOLAPDax::ColumnReference(bind_data->column_references[0]);
+    string query;
+    string description;
+    if (options.is_percentage) {
+        auto percentage = options.sample_size.GetValue<double>();
+        auto fraction = MSOLAPDax::ToLiteral(Value::DOUBLE(percentage / 100));
+        description = "SAMPLE " + options.sample_size.ToString() + "%";
+        if (MSOLAPDax::IsTableName(table)) {
+            // The row count of a model table comes from its metadata, without a scan
+            query = "EVALUATE SAMPLE(ROUNDUP(COUNTROWS(" + table + ") * " + fraction + ", 0), " + table + ", " +
+                    order + ")";
+        } else {
+            query = "EVALUATE VAR __msolap_sample = " + table + " RETURN SAMPLE(ROUNDUP(COUNTROWS(__msolap_sample) * " +
+                    fraction + ", 0), __msolap_sample, " + order + ")";
+        }
+    } else {
+        auto rows = options.sample_size.GetValue<int64_t>();
+        description = "SAMPLE " + to_string(rows) + " ROWS";
+        query = "EVALUATE SAMPLE(" + to_string(rows) + ", " + table + ", " + order + ")";
+    }
+    RewriteQuery(*bind_data, query, {description});
+
+    // The scan produces the sample itself, it takes the sample's place
+    op = std::move(op->children[0]);
+    return true;
+}
+
+// Whether DAX tells the values of a result column apart like DuckDB does. DAX
+// compares strings case-insensitively, "a" and "A" would be one distinct value.
+// Model columns store them as one value anyway, computed strings don't.
+static bool MSOLAPDistinctLikeDuckDB(const MSOLAPBindData &bind_data, idx_t column) {
+    auto &reference = bind_data.column_references[column];
+    bool model_column = reference.find('[') != string::npos && reference[0] != '[';
+    return bind_data.types[column].id() != LogicalTypeId::VARCHAR || model_column;
+}
+
+bool MSOLAPOptimizer::PushCount(ClientContext &context, unique_ptr<LogicalOperator> &op) {
+    if (op->type != LogicalOperatorType::LOGICAL_AGGREGATE_AND_GROUP_BY || op->children.size() != 1) {
+        return false;
+    }
+    auto &aggregate = op->Cast<LogicalAggregate>();
+    if (!aggregate.groups.empty() || aggregate.grouping_sets.size() > 1 || !aggregate.grouping_functions.empty() ||
+        aggregate.expressions.empty()) {
+        return false;
+    }
+    auto bind_data = GetRewritableScan(*op->children[0]);
+    if (!bind_data) {
+        return false;
+    }
+    auto &get = op->children[0]->Cast<LogicalGet>();
+    string table;
+    vector<string> descriptions;
+    if (!FilteredTable(context, get, *bind_data, table, descriptions)) {
+        return false;
+    }
+
+    // One ROW column per aggregate, BLANK (no rows) + 0 is 0
+    vector<string> columns;
+    vector<string> names;
+    vector<string> references;
+    vector<LogicalType> types;
+    auto &column_ids = get.GetColumnIds();
+    for (idx_t i = 0; i < aggregate.expressions.size(); i++) {
+        auto &expression = *aggregate.expressions[i];
+        if (expression.GetExpressionClass() != ExpressionClass::BOUND_AGGREGATE) {
+            return false;
+        }
+        auto &aggr = expression.Cast<BoundAggregateExpression>();
+        if (aggr.filter || aggr.order_bys) {
+            return false;
+        }
+        string count;
+        if (aggr.function.name == "count_star" && aggr.children.empty()) {
+            count = "COUNTROWS(" + table + ")";
+            descriptions.push_back("COUNTROWS");
+        } else if (aggr.function.name == "count" && aggr.IsDistinct() && aggr.children.size() == 1 &&
+                   aggr.children[0]->GetExpressionClass() == ExpressionClass::BOUND_COLUMN_REF) {
+            auto &binding = aggr.children[0]->Cast<BoundColumnRefExpression>().binding;
+            if (binding.table_index != get.table_index || binding.column_index >= column_ids.size() ||
+                column_ids[binding.column_index].GetPrimaryIndex() >= bind_data->column_references.size() ||
+                !MSOLAPDistinctLikeDuckDB(*bind_data, column_ids[binding.column_index].GetPrimaryIndex())) {
+                return false;
+            }
+            auto &reference = bind_data->column_references[column_ids[binding.column_index].GetPrimaryIndex()];
+            auto column = MSOLAPDax::ColumnReference(reference);
+            // COUNT(DISTINCT) skips NULLs, DISTINCTCOUNT would count BLANK as a value
+            if (MSOLAPDax::IsTableName(table)) {
+                count = "DISTINCTCOUNTNOBLANK(" + column + ")";
+            } else {
+                count = "COUNTROWS(FILTER(DISTINCT(SELECTCOLUMNS(" + table + ", \"__msolap_value\", " + column +
+                        ")), NOT ISBLANK([__msolap_value])))";
+            }
+            descriptions.push_back("COUNT(DISTINCT " + column + ")");
+        } else {
+            return false;
+        }
+        auto name = "count" + to_string(i);
+        columns.push_back(MSOLAPDax::QuoteString(name) + ", " + count + " + 0");
+        names.push_back(name);
+        references.push_back("[" + name + "]");
+        types.push_back(aggr.return_type);
+    }
+
+    ReplaceColumns(get, *bind_data, names, references, types);
+    RewriteQuery(*bind_data, "EVALUATE ROW(" + StringUtil::Join(columns, ", ") + ")", descriptions);
+
+    // The scan's single row takes the place of the aggregate's, under its bindings
+    vector<unique_ptr<Expression>> expressions;
+    for (idx_t i = 0; i < types.size(); i++) {
+        expressions.push_back(make_uniq<BoundColumnRefExpression>(types[i], ColumnBinding(get.table_index, i)));
+    }
+    auto projection = make_uniq<LogicalProjection>(aggregate.aggregate_index, std::move(expressions));
+    projection->children.push_back(std::move(op->children[0]));
+    op = std::move(projection);
+    return true;
+}
+
+bool MSOLAPOptimizer::PushDistinct(ClientContext &context, unique_ptr<LogicalOperator> &op) {
+    if (op->children.size() != 1) {
+        return false;
+    }
+    // The column references naming the distinct columns, rebound to the new result
+    vector<Expression *> expressions;
+    auto scan = op->children[0].get();
+    if (op->type == LogicalOperatorType::LOGICAL_AGGREGATE_AND_GROUP_BY) {
+        auto &aggregate = op->Cast<LogicalAggregate>();
+        if (aggregate.groups.empty() || !aggregate.expressions.empty() || aggregate.grouping_sets.size() > 1 ||
+            !aggregate.grouping_functions.empty()) {
+            return false;
+        }
+        for (auto &group : aggregate.groups) {
+            expressions.push_back(group.get());
+        }
+    } else if (op->type == LogicalOperatorType::LOGICAL_DISTINCT) {
+        auto &distinct = op->Cast<LogicalDistinct>();
+        if (distinct.distinct_type != DistinctType::DISTINCT || distinct.order_by) {
+            return false;
+        }
+        if (scan->type == LogicalOperatorType::LOGICAL_PROJECTION && scan->children.size() == 1) {
+            // The select list of SELECT DISTINCT
+            for (auto &expression : scan->expressions) {
+                expressions.push_back(expression.get());
+            }
+            scan = scan->children[0].get();
+        } else {
+            for (auto &target : distinct.distinct_targets) {
+                expressions.push_back(target.get());
+            }
+        }
+    } else {
+        return false;
+    }
+    auto bind_data = GetRewritableScan(*scan);
+    if (!bind_data || expressions.empty()) {
+        return false;
+    }
+    auto &get = scan->Cast<LogicalGet>();
+    auto &column_ids = get.GetColumnIds();
+
+    // Result columns of the original query in the new result, and every reference's position
+    vector<idx_t> columns;
+    vector<idx_t> positions;
+    for (auto expression : expressions) {
+        if (expression->GetExpressionClass() != ExpressionClass::BOUND_COLUMN_REF) {
+            return false;
+        }
+        auto &binding = expression->Cast<BoundColumnRefExpression>().binding;
+        if (binding.table_index != get.table_index || binding.column_index >= column_ids.size()) {
+            return false;
+        }
+        auto column = column_ids[binding.column_index].GetPrimaryIndex();
+        if (column >= bind_data->column_references.size()) {
+            return false;
+        }
+        if (!MSOLAPDistinctLikeDuckDB(*bind_data, column)) {
+            return false;
+        }
+        auto position = std::find(columns.begin(), columns.end(), column) - columns.begin();
+        if (position == (ptrdiff_t)columns.size()) {
+            columns.push_back(column);
+        }
+        positions.push_back(position);
+    }
+
+    string table;
+    vector<string> descriptions;
+    if (!FilteredTable(context, get, *bind_data, table, descriptions)) {
+        return false;
+    }
+    bool model_table = MSOLAPDax::IsTableName(MSOLAPDax::TableExpression(bind_data->dax_query));
+    vector<string> dax_columns;
+    vector<string> names;
+    vector<string> references;
+    vector<LogicalType> types;
+    vector<MSOLAPValueKind> kinds;
+    for (auto column : columns) {
+        auto dax_column = MSOLAPDax::ColumnReference(bind_data->column_references[column]);
+        names.push_back(bind_data->names[column]);
+        types.push_back(bind_data->types[column]);
+        kinds.push_back(bind_data->column_kinds[column]);
+        if (model_table) {
+            // SUMMARIZE and DISTINCT keep the model columns' names
+            dax_columns.push_back(dax_column);
+            references.push_back(bind_data->column_references[column]);
+        } else {
+            dax_columns.push_back(MSOLAPDax::QuoteString(names.back()) + ", " + dax_column);
+            references.push_back("[" + names.back() + "]");
+        }
+    }
+    string query;
+    if (model_table && columns.size() == 1 && MSOLAPDax::IsTableName(table)) {
+        query = "EVALUATE DISTINCT(" + dax_columns[0] + ")";
+    } else if (model_table) {
+        query = "EVALUATE SUMMARIZE(" + table + ", " + StringUtil::Join(dax_columns, ", ") + ")";
+    } else {
+        query = "EVALUATE DISTINCT(SELECTCOLUMNS(" + table + ", " + StringUtil::Join(dax_columns, ", ") + "))";
+    }
+    vector<string> distinct_columns;
+    for (auto column : columns) {
+        distinct_columns.push_back(MSOLAPDax::ColumnReference(bind_data->column_references[column]));
+    }
+    descriptions.push_back("DISTINCT " + StringUtil::Join(distinct_columns, ", "));
+
+    ReplaceColumns(get, *bind_data, names, references, types);
+    bind_data->column_kinds = kinds;
+    RewriteQuery(*bind_data, query, descriptions);
+    for (idx_t i = 0; i < expressions.size(); i++) {
+        expressions[i]->Cast<BoundColumnRefExpression>().binding = ColumnBinding(get.table_index, positions[i]);
+    }
+    return true;
+}
+
+bool MSOLAPOptimizer::PushLimit(ClientContext &context, unique_ptr<LogicalOperator> &op) {
+    if (op->type != LogicalOperatorType::LOGICAL_LIMIT || op->children.size() != 1) {
+        return false;
+    }
+    auto &limit = op->Cast<LogicalLimit>();
+    if (limit.limit_val.Type() != LimitNodeType::CONSTANT_VALUE ||
+        (limit.offset_val.Type() != LimitNodeType::UNSET && limit.offset_val.Type() != LimitNodeType::CONSTANT_VALUE)) {
+        return false;
+    }
+    auto scan = op->children[0].get();
+    if (scan->type == LogicalOperatorType::LOGICAL_PROJECTION && scan->children.size() == 1) {
+        scan = scan->children[0].get();
+    }
+    auto bind_data = GetRewritableScan(*scan);
+    // msolap() already executes its query at bind time, restarting it for fewer rows
+    // rarely pays off. Filters are re-checked locally, so the first rows on the
+    // server might not be the first rows DuckDB keeps.
+    if (!bind_data || scan->Cast<LogicalGet>().function.name != "msolap_table" ||
+        !scan->Cast<LogicalGet>().table_filters.filters.empty()) {
+        return false;
+    }
+    auto rows = limit.limit_val.GetConstantValue();
+    if (limit.offset_val.Type() == LimitNodeType::CONSTANT_VALUE) {
+        rows += limit.offset_val.GetConstantValue();
+    }
+
+    // Only the bare table, whose columns are still the ones partition_column indexes
+    string table = MSOLAPDax::TableExpression(bind_data->dax_query);
+    if (!MSOLAPDax::IsTableName(table)) {
+        return false;
+    }
+
+    // TOPN returns every row tied with the last one: ordering by the key column and
+    // then by every other column leaves only identical rows tied. The LIMIT stays to
+    // cut those.
+    auto &table_data = bind_data->Cast<MSOLAPTableBindData>();
+    vector<idx_t> order_columns;
+    if (table_data.partition_column != DConstants::INVALID_INDEX) {
+        order_columns.push_back(table_data.partition_column);
+    }
+    for (idx_t col = 0; col < table_data.column_references.size(); col++) {
+        if (col != table_data.partition_column) {
+            order_columns.push_back(col);
+        }
+    }
+    vector<string> order;
+    for (auto col : order_columns) {
+        order.push_back(MSOLAPDax::ColumnReference(table_data.column_references[col]) + ", ASC");
+    }
+    RewriteQuery(*bind_data,
+                 "EVALUATE TOPN(" + to_string(rows) + ", " + table + ", " + StringUtil::Join(order, ", ") + ")",
+                 {"TOPN " + to_string(rows)});
+    return true;
+}
+
+void MSOLAPOptimizer::Optimize(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
+    for (auto &child : plan->children) {
+        Optimize(input, child);
+    }
+    if (!PushSample(input.context, plan) && !PushCount(input.context, plan) && !PushLimit(input.context, plan)) {
+        PushDistinct(input.context, plan);
+    }
+}
+
+} // namespace duckdb
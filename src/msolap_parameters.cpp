@@ -0,0 +1,91 @@
+#include "msolap_parameters.hpp"
+#include "duckdb/common/string_util.hpp"
+#include <stdexcept>
+
+namespace duckdb {
+
+Value MSOLAPParameters::NormalizeValue(const string &name, const Value &value) {
+    switch (value.type().id()) {
+    case LogicalTypeId::SQLNULL:
+        return Value();
+    case LogicalTypeId::BOOLEAN:
+        return value.DefaultCastAs(LogicalType::BOOLEAN);
+    case LogicalTypeId::TINYINT:
+    case LogicalTypeId::SMALLINT:
+    case LogicalTypeId::INTEGER:
+    case LogicalTypeId::BIGINT:
+    case LogicalTypeId::UTINYINT:
+    case LogicalTypeId::USMALLINT:
+    case LogicalTypeId::UINTEGER:
+        return value.DefaultCastAs(LogicalType::BIGINT);
+    case LogicalTypeId::UBIGINT:
+    case LogicalTypeId::HUGEINT:
+    case LogicalTypeId::UHUGEINT: {
+        // DAX integers are 64 bit signed
+        Value result;
+        string error;
+        if (!value.DefaultTryCastAs(LogicalType::BIGINT, result, &error)) {
+            throw std::runtime_error("Parameter @" + name + " does not fit into a 64-bit DAX integer");
+        }
+        return result;
+    }
+    case LogicalTypeId::FLOAT:
+    case LogicalTypeId::DOUBLE:
+    case LogicalTypeId::DECIMAL:
+        return value.DefaultCastAs(LogicalType::DOUBLE);
+    case LogicalTypeId::DATE:
+    case LogicalTypeId::TIMESTAMP:
+    case LogicalTypeId::TIMESTAMP_SEC:
+    case LogicalTypeId::TIMESTAMP_MS:
+    case LogicalTypeId::TIMESTAMP_NS:
+        return value.DefaultCastAs(LogicalType::TIMESTAMP);
+    case LogicalTypeId::VARCHAR:
+        return value;
+    default:
+        throw std::runtime_error("Unsupported type " + value.type().ToString() + " for parameter @" + name);
+    }
+}
+
+string MSOLAPParameters::NormalizeName(const string &name) {
+    auto result = StringUtil::StartsWith(name, "@") ? name.substr(1) : name;
+    if (result.empty()) {
+        throw std::runtime_error("Parameter names must not be empty");
+    }
+    return result;
+}
+
+vector<MSOLAPParameter> MSOLAPParameters::FromStruct(const Value &params) {
+    vector<MSOLAPParameter> result;
+    if (params.IsNull()) {
+        return result;
+    }
+    if (params.type().id() != LogicalTypeId::STRUCT) {
+        throw std::runtime_error("params must be a struct, e.g. params := {'year': 2024}");
+    }
+
+    auto &child_types = StructType::GetChildTypes(params.type());
+    auto &children = StructValue::GetChildren(params);
+    for (idx_t i = 0; i < children.size(); i++) {
+        MSOLAPParameter parameter;
+        parameter.name = NormalizeName(child_types[i].first);
+        // 'year' and '@year' are the same parameter
+        for (auto &existing : result) {
+            if (StringUtil::CIEquals(existing.name, parameter.name)) {
+                throw std::runtime_error("Parameter @" + parameter.name + " is given twice");
+            }
+        }
+        parameter.value = NormalizeValue(parameter.name, children[i]);
+        result.push_back(std::move(parameter));
+    }
+    return result;
+}
+
+string MSOLAPParameters::ToString(const vector<MSOLAPParameter> &parameters) {
+    vector<string> parts;
+    for (auto &parameter : parameters) {
+        parts.push_back("@" + parameter.name + " = " + parameter.value.ToSQLString());
+    }
+    return StringUtil::Join(parts, ", ");
+}
+
+} // namespace duckdb
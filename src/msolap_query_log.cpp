@@ -0,0 +1,191 @@
+#include "msolap_query_log.hpp"
+#include "msolap_connection_string.hpp"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace duckdb {
+
+MSOLAPQueryLog::MSOLAPQueryLog() : next_query_id(0), slots(MSOLAP_QUERY_LOG_CAPACITY) {
+}
+
+MSOLAPQueryLog &MSOLAPQueryLog::Get() {
+    static MSOLAPQueryLog log;
+    return log;
+}
+
+// The log is shared by every database in the process and may be written to a
+// file, so it never holds the credentials of a connection string
+static string MSOLAPLogConnection(const string &connection_string) {
+    try {
+        return MSOLAPConnectionString::Parse(connection_string).Description();
+    } catch (std::invalid_argument &) {
+        return string();
+    }
+}
+
+void MSOLAPQueryLog::Record(const string &connection_string, const string &dax_query,
+                            const MSOLAPScanMetrics &metrics, const string &log_file) {
+    auto entry = std::make_shared<MSOLAPQueryLogEntry>();
+    entry->query_id = next_query_id.fetch_add(1);
+    entry->connection_string = MSOLAPLogConnection(connection_string);
+    entry->dax_query = dax_query;
+    entry->metrics = metrics;
+
+    // Overwrites the oldest entry once the ring is full
+    std::shared_ptr<const MSOLAPQueryLogEntry> published = entry;
+    std::atomic_store(&slots[entry->query_id % MSOLAP_QUERY_LOG_CAPACITY], published);
+
+    if (!log_file.empty()) {
+        AppendToFile(log_file, *entry);
+    }
+}
+
+std::vector<std::shared_ptr<const MSOLAPQueryLogEntry>> MSOLAPQueryLog::Snapshot() const {
+    std::vector<std::shared_ptr<const MSOLAPQueryLogEntry>> result;
+    result.reserve(slots.size());
+    for (auto &slot : slots) {
+        auto entry = std::atomic_load(&slot);
+        if (entry) {
+            result.push_back(std::move(entry));
+        }
+    }
+    std::sort(result.begin(), result.end(),
+              [](const std::shared_ptr<const MSOLAPQueryLogEntry> &a,
+                 const std::shared_ptr<const MSOLAPQueryLogEntry> &b) { return a->query_id < b->query_id; });
+    return result;
+}
+
+static string MSOLAPJSONEscape(const string &input) {
+    string result;
+    result.reserve(input.size() + 2);
+    for (char c : input) {
+        switch (c) {
+        case '"':
+            result += "\\\"";
+            break;
+        case '\\':
+            result += "\\\\";
+            break;
+        case '\n':
+            result += "\\n";
+            break;
+        case '\r':
+            result += "\\r";
+            break;
+        case '\t':
+            result += "\\t";
+            break;
+        default:
+            if ((unsigned char)c < 0x20) {
+                char buffer[8];
+                snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned char)c);
+                result += buffer;
+            } else {
+                result += c;
+            }
+        }
+    }
+    return result;
+}
+
+void MSOLAPQueryLog::AppendToFile(const string &log_file, const MSOLAPQueryLogEntry &entry) {
+    auto &m = entry.metrics;
+    string line = "{\"query_id\":" + to_string(entry.query_id) +
+                  ",\"start_time\":\"" + Timestamp::ToString(m.start_time) + "\"" +
+                  ",\"connection\":\"" + MSOLAPJSONEscape(entry.connection_string) + "\"" +
+                  ",\"query\":\"" + MSOLAPJSONEscape(entry.dax_query) + "\"" +
+                  ",\"status\":\"" + MSOLAPJSONEscape(m.status) + "\"" +
+                  ",\"connect_ms\":" + to_string(m.connect_seconds * 1000) +
+                  ",\"execute_ms\":" + to_string(m.execute_seconds * 1000) +
+                  ",\"first_row_ms\":" + to_string(m.first_row_seconds * 1000) +
+                  ",\"fetch_ms\":" + to_string(m.fetch_seconds * 1000) +
+                  ",\"convert_ms\":" + to_string(m.convert_seconds * 1000) +
+                  ",\"rows\":" + to_string(m.rows) +
+                  ",\"bytes\":" + to_string(m.bytes) +
+                  ",\"batches\":" + to_string(m.batches);
+    auto &timings = m.server_timings;
+    if (timings.captured) {
+        line += ",\"server_ms\":" + to_string(timings.total_ms) + ",\"se_ms\":" + to_string(timings.se_ms) +
+                ",\"fe_ms\":" + to_string(timings.fe_ms) + ",\"se_cpu_ms\":" + to_string(timings.se_cpu_ms) +
+                ",\"se_queries\":" + to_string(timings.se_queries) +
+                ",\"se_cache_hits\":" + to_string(timings.se_cache_hits);
+    }
+    line += "}\n";
+
+    std::lock_guard<std::mutex> guard(file_lock);
+    std::ofstream out(log_file, std::ios::out | std::ios::app | std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Failed to open msolap_query_log_file '" + log_file + "'");
+    }
+    out << line;
+}
+
+//===--------------------------------------------------------------------===//
+// msolap_query_log() table function
+//===--------------------------------------------------------------------===//
+
+struct MSOLAPQueryLogGlobalState : public GlobalTableFunctionState {
+    std::vector<std::shared_ptr<const MSOLAPQueryLogEntry>> entries;
+    idx_t offset = 0;
+};
+
+static unique_ptr<FunctionData> MSOLAPQueryLogBind(ClientContext &context, TableFunctionBindInput &input,
+                                                   vector<LogicalType> &return_types, vector<string> &names) {
+    names = {"query_id",   "start_time", "connection",  "query",      "status", "connect_ms", "execute_ms",
+             "first_row_ms", "fetch_ms", "convert_ms", "rows",       "bytes",  "batches",
+             "server_ms",  "se_ms",      "fe_ms",       "se_cpu_ms",  "se_queries", "se_cache_hits"};
+    return_types = {LogicalType::UBIGINT, LogicalType::TIMESTAMP, LogicalType::VARCHAR, LogicalType::VARCHAR,
+                    LogicalType::VARCHAR, LogicalType::DOUBLE,    LogicalType::DOUBLE,  LogicalType::DOUBLE,
+                    LogicalType::DOUBLE,  LogicalType::DOUBLE,    LogicalType::UBIGINT, LogicalType::UBIGINT,
+                    LogicalType::UBIGINT, LogicalType::DOUBLE,    LogicalType::DOUBLE,  LogicalType::DOUBLE,
+                    LogicalType::DOUBLE,  LogicalType::BIGINT,    LogicalType::BIGINT};
+    return make_uniq<TableFunctionData>();
+}
+
+static unique_ptr<GlobalTableFunctionState> MSOLAPQueryLogInit(ClientContext &context,
+                                                               TableFunctionInitInput &input) {
+    auto result = make_uniq<MSOLAPQueryLogGlobalState>();
+    result->entries = MSOLAPQueryLog::Get().Snapshot();
+    return std::move(result);
+}
+
+static void MSOLAPQueryLogScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+    auto &state = data.global_state->Cast<MSOLAPQueryLogGlobalState>();
+
+    idx_t count = 0;
+    while (state.offset < state.entries.size() && count < STANDARD_VECTOR_SIZE) {
+        auto &entry = *state.entries[state.offset++];
+        auto &m = entry.metrics;
+        output.SetValue(0, count, Value::UBIGINT(entry.query_id));
+        output.SetValue(1, count, Value::TIMESTAMP(m.start_time));
+        output.SetValue(2, count, Value(entry.connection_string));
+        output.SetValue(3, count, Value(entry.dax_query));
+        output.SetValue(4, count, Value(m.status));
+        output.SetValue(5, count, Value::DOUBLE(m.connect_seconds * 1000));
+        output.SetValue(6, count, Value::DOUBLE(m.execute_seconds * 1000));
+        output.SetValue(7, count, Value::DOUBLE(m.first_row_seconds * 1000));
+        output.SetValue(8, count, Value::DOUBLE(m.fetch_seconds * 1000));
+        output.SetValue(9, count, Value::DOUBLE(m.convert_seconds * 1000));
+        output.SetValue(10, count, Value::UBIGINT(m.rows));
+        output.SetValue(11, count, Value::UBIGINT(m.bytes));
+        output.SetValue(12, count, Value::UBIGINT(m.batches));
+        // Server timings only for traced scans
+        auto &timings = m.server_timings;
+        output.SetValue(13, count, timings.captured ? Value::DOUBLE(timings.total_ms) : Value(LogicalType::DOUBLE));
+        output.SetValue(14, count, timings.captured ? Value::DOUBLE(timings.se_ms) : Value(LogicalType::DOUBLE));
+        output.SetValue(15, count, timings.captured ? Value::DOUBLE(timings.fe_ms) : Value(LogicalType::DOUBLE));
+        output.SetValue(16, count, timings.captured ? Value::DOUBLE(timings.se_cpu_ms) : Value(LogicalType::DOUBLE));
+        output.SetValue(17, count, timings.captured ? Value::BIGINT(timings.se_queries) : Value(LogicalType::BIGINT));
+        output.SetValue(18, count,
+                        timings.captured ? Value::BIGINT(timings.se_cache_hits) : Value(LogicalType::BIGINT));
+        count++;
+    }
+    output.SetCardinality(count);
+}
+
+MSOLAPQueryLogFunction::MSOLAPQueryLogFunction()
+    : TableFunction("msolap_query_log", {}, MSOLAPQueryLogScan, MSOLAPQueryLogBind, MSOLAPQueryLogInit) {
+}
+
+} // namespace duckdb
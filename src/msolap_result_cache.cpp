@@ -0,0 +1,453 @@
+#include "msolap_result_cache.hpp"
+#include "msolap_connection.hpp"
+#include "msolap_rowset_reader.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/common/vector_operations/binary_executor.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace duckdb {
+
+static constexpr const char *MSOLAP_CACHE_INDEX_FILE = "msolap_cache_index.tsv";
+static constexpr const char *MSOLAP_CACHE_INDEX_HEADER = "msolap_cache_index\t1";
+
+// Refresh state of every cube (model and perspectives). Readable without admin
+// rights, unlike the TMSCHEMA rowsets.
+static constexpr const char *MSOLAP_REFRESH_QUERY =
+    "SELECT [CUBE_NAME], [LAST_SCHEMA_UPDATE], [LAST_DATA_UPDATE] FROM $SYSTEM.MDSCHEMA_CUBES";
+
+//===--------------------------------------------------------------------===//
+// Index file
+//===--------------------------------------------------------------------===//
+
+static string MSOLAPCacheEscape(const string &value) {
+    string result;
+    for (char c : value) {
+        switch (c) {
+        case '\\':
+            result += "\\\\";
+            break;
+        case '\t':
+            result += "\\t";
+            break;
+        case '\n':
+            result += "\\n";
+            break;
+        case '\r':
+            result += "\\r";
+            break;
+        default:
+            result += c;
+        }
+    }
+    return result;
+}
+
+static string MSOLAPCacheUnescape(const string &value) {
+    string result;
+    for (idx_t i = 0; i < value.size(); i++) {
+        if (value[i] != '\\' || i + 1 == value.size()) {
+            result += value[i];
+            continue;
+        }
+        char c = value[++i];
+        result += c == 't' ? '\t' : c == 'n' ? '\n' : c == 'r' ? '\r' : c;
+    }
+    return result;
+}
+
+static string MSOLAPCacheIndexPath(FileSystem &fs, const string &directory) {
+    return fs.JoinPath(directory, MSOLAP_CACHE_INDEX_FILE);
+}
+
+void MSOLAPResultCache::LoadIndex(FileSystem &fs, const string &directory) {
+    if (directory == loaded_directory) {
+        return;
+    }
+    entries.clear();
+    loaded_directory = directory;
+    if (!fs.DirectoryExists(directory)) {
+        fs.CreateDirectory(directory);
+    }
+    auto index_path = MSOLAPCacheIndexPath(fs, directory);
+    if (!fs.FileExists(index_path)) {
+        return;
+    }
+    auto handle = fs.OpenFile(index_path, FileFlags::FILE_FLAGS_READ);
+    auto size = handle->GetFileSize();
+    string content(size, '\0');
+    handle->Read((void *)content.data(), size);
+
+    auto lines = StringUtil::Split(content, '\n');
+    if (lines.empty() || lines[0] != MSOLAP_CACHE_INDEX_HEADER) {
+        // Unknown format, start over rather than guess
+        return;
+    }
+    for (idx_t i = 1; i < lines.size(); i++) {
+        auto fields = StringUtil::Split(lines[i], '\t');
+        if (fields.size() != 8) {
+            continue;
+        }
+        MSOLAPCacheEntry entry;
+        entry.key = fields[0];
+        entry.data_source = MSOLAPCacheUnescape(fields[1]);
+        entry.refresh = MSOLAPCacheUnescape(fields[2]);
+        entry.rows = std::stoull(fields[3]);
+        entry.bytes = std::stoull(fields[4]);
+        entry.last_used = timestamp_t(std::stoll(fields[5]));
+        entry.pinned = fields[6] == "1";
+        entry.dax_query = MSOLAPCacheUnescape(fields[7]);
+        entries[entry.key] = std::move(entry);
+    }
+}
+
+void MSOLAPResultCache::SaveIndex(FileSystem &fs) {
+    string content = MSOLAP_CACHE_INDEX_HEADER;
+    content += "\n";
+    for (auto &kv : entries) {
+        auto &entry = kv.second;
+        content += entry.key + "\t" + MSOLAPCacheEscape(entry.data_source) + "\t" + MSOLAPCacheEscape(entry.refresh) +
+                   "\t" + std::to_string(entry.rows) + "\t" + std::to_string(entry.bytes) + "\t" +
+                   std::to_string(entry.last_used.value) + "\t" + (entry.pinned ? "1" : "0") + "\t" +
+                   MSOLAPCacheEscape(entry.dax_query) + "\n";
+    }
+    // Write aside and move over, a crash never leaves a truncated index
+    auto index_path = MSOLAPCacheIndexPath(fs, loaded_directory);
+    auto temp_path = index_path + ".tmp";
+    {
+        auto handle = fs.OpenFile(temp_path, FileFlags::FILE_FLAGS_WRITE | FileFlags::FILE_FLAGS_FILE_CREATE_NEW);
+        handle->Write((void *)content.data(), content.size());
+        handle->Sync();
+    }
+    fs.TryRemoveFile(index_path);
+    fs.MoveFile(temp_path, index_path);
+}
+
+//===--------------------------------------------------------------------===//
+// MSOLAPResultCache
+//===--------------------------------------------------------------------===//
+
+MSOLAPResultCache &MSOLAPResultCache::Get() {
+    static MSOLAPResultCache cache;
+    return cache;
+}
+
+bool MSOLAPResultCache::GetDirectory(ClientContext &context, string &directory) {
+    Value setting;
+    if (!context.TryGetCurrentSetting("msolap_cache_directory", setting) || setting.IsNull()) {
+        return false;
+    }
+    directory = setting.ToString();
+    return !directory.empty();
+}
+
+string MSOLAPResultCache::Key(const string &connection_string, const string &dax_query) {
+    // Two FNV-1a hashes with different offset bases; stable across runs and platforms
+    string text = connection_string + '\0' + dax_query;
+    uint64_t first = 0xcbf29ce484222325ULL;
+    uint64_t second = 0x84222325cbf29ce4ULL;
+    for (unsigned char c : text) {
+        first = (first ^ c) * 0x100000001b3ULL;
+        second = (second ^ c) * 0x100000001b3ULL;
+    }
+    char key[33];
+    snprintf(key, sizeof(key), "%016llx%016llx", (unsigned long long)first, (unsigned long long)second);
+    return key;
+}
+
+string MSOLAPResultCache::ResultPath(FileSystem &fs, const string &directory, const string &key) {
+    return fs.JoinPath(directory, key + ".parquet");
+}
+
+string MSOLAPResultCache::GetRefreshState(ClientContext &context, const string &connection_string) {
+    MSOLAPRowsetReader reader;
+    reader.Open(context, connection_string, MSOLAP_REFRESH_QUERY);
+    reader.WaitOpen();
+
+    vector<string> cubes;
+    DataChunk chunk;
+    chunk.Initialize(Allocator::DefaultAllocator(), reader.types);
+    while (true) {
+        chunk.Reset();
+        idx_t count = reader.Read(chunk);
+        if (count == 0) {
+            break;
+        }
+        for (idx_t row = 0; row < count; row++) {
+            string cube;
+            for (idx_t col = 0; col < chunk.ColumnCount(); col++) {
+                cube += (col > 0 ? "|" : "") + chunk.GetValue(col, row).ToString();
+            }
+            cubes.push_back(cube);
+        }
+    }
+    reader.Close();
+    if (cubes.empty()) {
+        throw std::runtime_error("The model reported no cubes");
+    }
+    std::sort(cubes.begin(), cubes.end());
+    return StringUtil::Join(cubes, ";");
+}
+
+string MSOLAPResultCache::Lookup(ClientContext &context, const string &directory, const string &connection_string,
+                                 const string &dax_query) {
+    auto refresh = GetRefreshState(context, connection_string);
+
+    auto &fs = FileSystem::GetFileSystem(context);
+    auto key = Key(connection_string, dax_query);
+    std::lock_guard<std::mutex> guard(lock);
+    LoadIndex(fs, directory);
+    auto entry = entries.find(key);
+    auto path = ResultPath(fs, directory, key);
+    if (entry == entries.end() || entry->second.dax_query != dax_query || entry->second.refresh != refresh ||
+        !fs.FileExists(path)) {
+        pending_refresh[key] = refresh;
+        return string();
+    }
+    entry->second.last_used = Timestamp::GetCurrentTimestamp();
+    SaveIndex(fs);
+    return path;
+}
+
+bool MSOLAPResultCache::TakeRefreshState(const string &key, string &refresh) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto entry = pending_refresh.find(key);
+    if (entry == pending_refresh.end()) {
+        return false;
+    }
+    refresh = std::move(entry->second);
+    pending_refresh.erase(entry);
+    return true;
+}
+
+static idx_t MSOLAPCacheSizeLimit(ClientContext &context) {
+    Value setting;
+    if (context.TryGetCurrentSetting("msolap_cache_size_limit", setting) && !setting.IsNull()) {
+        return setting.GetValue<idx_t>();
+    }
+    return MSOLAP_DEFAULT_CACHE_SIZE_LIMIT;
+}
+
+void MSOLAPResultCache::Insert(ClientContext &context, const string &directory, MSOLAPCacheEntry entry,
+                               const string &path) {
+    auto &fs = FileSystem::GetFileSystem(context);
+    std::lock_guard<std::mutex> guard(lock);
+    LoadIndex(fs, directory);
+    auto existing = entries.find(entry.key);
+    if (existing != entries.end()) {
+        entry.pinned = existing->second.pinned;
+    }
+    auto target = ResultPath(fs, directory, entry.key);
+    fs.TryRemoveFile(target);
+    fs.MoveFile(path, target);
+    entry.last_used = Timestamp::GetCurrentTimestamp();
+    entries[entry.key] = entry;
+    Evict(fs, MSOLAPCacheSizeLimit(context));
+    SaveIndex(fs);
+}
+
+void MSOLAPResultCache::Evict(FileSystem &fs, idx_t size_limit) {
+    idx_t total = 0;
+    vector<MSOLAPCacheEntry *> candidates;
+    for (auto &kv : entries) {
+        total += kv.second.bytes;
+        if (!kv.second.pinned && !kv.second.refresh.empty()) {
+            candidates.push_back(&kv.second);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](MSOLAPCacheEntry *a, MSOLAPCacheEntry *b) {
+        return a->last_used < b->last_used;
+    });
+    for (auto candidate : candidates) {
+        if (total <= size_limit) {
+            break;
+        }
+        // A file still being read elsewhere can't be removed on Windows, try again next time
+        try {
+            fs.RemoveFile(ResultPath(fs, loaded_directory, candidate->key));
+        } catch (std::exception &) {
+            continue;
+        }
+        total -= candidate->bytes;
+        entries.erase(candidate->key);
+    }
+}
+
+bool MSOLAPResultCache::SetPinned(ClientContext &context, const string &directory, const string &connection_string,
+                                  const string &dax_query, bool pinned) {
+    auto &fs = FileSystem::GetFileSystem(context);
+    auto key = Key(connection_string, dax_query);
+    std::lock_guard<std::mutex> guard(lock);
+    LoadIndex(fs, directory);
+    auto existing = entries.find(key);
+    bool cached = existing != entries.end() && !existing->second.refresh.empty();
+    if (existing != entries.end()) {
+        existing->second.pinned = pinned;
+        if (!pinned && !cached) {
+            entries.erase(existing);
+        }
+    } else if (pinned) {
+        // Placeholder so the result is pinned as soon as it is cached
+        MSOLAPCacheEntry entry;
+        entry.key = key;
+        entry.data_source = MSOLAPConnection::GetDataSource(connection_string);
+        entry.dax_query = dax_query;
+        entry.last_used = Timestamp::GetCurrentTimestamp();
+        entry.pinned = true;
+        entries[key] = std::move(entry);
+    }
+    SaveIndex(fs);
+    return cached;
+}
+
+vector<MSOLAPCacheEntry> MSOLAPResultCache::Entries(ClientContext &context, const string &directory) {
+    auto &fs = FileSystem::GetFileSystem(context);
+    std::lock_guard<std::mutex> guard(lock);
+    LoadIndex(fs, directory);
+    vector<MSOLAPCacheEntry> result;
+    for (auto &kv : entries) {
+        result.push_back(kv.second);
+    }
+    std::sort(result.begin(), result.end(), [](const MSOLAPCacheEntry &a, const MSOLAPCacheEntry &b) {
+        return a.last_used > b.last_used;
+    });
+    return result;
+}
+
+//===--------------------------------------------------------------------===//
+// MSOLAPCacheWriter
+//===--------------------------------------------------------------------===//
+
+MSOLAPCacheWriter::MSOLAPCacheWriter(ClientContext &context, string directory_p, MSOLAPCacheEntry entry_p,
+                                     const vector<string> &names, const vector<LogicalType> &types)
+    : context(context), directory(std::move(directory_p)), entry(std::move(entry_p)) {
+    table_name = "msolap_cache_" + entry.key;
+    vector<string> columns;
+    for (idx_t i = 0; i < names.size(); i++) {
+        columns.push_back(KeywordHelper::WriteOptionallyQuoted(names[i]) + " " + types[i].ToString());
+    }
+    // A temporary table on its own connection spills to disk under memory pressure
+    // and disappears with the connection
+    connection = make_uniq<Connection>(*context.db);
+    auto result = connection->Query("CREATE TEMPORARY TABLE " + table_name + " (" +
+                                    StringUtil::Join(columns, ", ") + ")");
+    if (result->HasError()) {
+        throw std::runtime_error(result->GetError());
+    }
+    appender = make_uniq<Appender>(*connection, "temp", "main", table_name);
+}
+
+MSOLAPCacheWriter::~MSOLAPCacheWriter() {
+    try {
+        appender.reset();
+        connection.reset();
+    } catch (...) {
+        // A discarded result never fails the query
+    }
+}
+
+void MSOLAPCacheWriter::Append(DataChunk &chunk) {
+    appender->AppendDataChunk(chunk);
+    entry.rows += chunk.size();
+}
+
+void MSOLAPCacheWriter::Commit() {
+    try {
+        appender->Close();
+        auto &fs = FileSystem::GetFileSystem(context);
+        auto path = MSOLAPResultCache::ResultPath(fs, directory, entry.key) + ".tmp";
+        auto result = connection->Query("COPY " + table_name + " TO '" + StringUtil::Replace(path, "'", "''") +
+                                        "' (FORMAT parquet)");
+        if (result->HasError()) {
+            throw std::runtime_error(result->GetError());
+        }
+        entry.bytes = fs.OpenFile(path, FileFlags::FILE_FLAGS_READ)->GetFileSize();
+        MSOLAPResultCache::Get().Insert(context, directory, entry, path);
+    } catch (InterruptException &) {
+        throw;
+    } catch (std::exception &) {
+        // The cache is best effort, the query already has its rows
+    }
+    appender.reset();
+    connection.reset();
+}
+
+//===--------------------------------------------------------------------===//
+// msolap_cache() table function
+//===--------------------------------------------------------------------===//
+
+struct MSOLAPCacheGlobalState : public GlobalTableFunctionState {
+    vector<MSOLAPCacheEntry> entries;
+    idx_t offset = 0;
+};
+
+static unique_ptr<FunctionData> MSOLAPCacheBind(ClientContext &context, TableFunctionBindInput &input,
+                                                vector<LogicalType> &return_types, vector<string> &names) {
+    names = {"key", "data_source", "query", "cached", "pinned", "rows", "bytes", "last_used"};
+    return_types = {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::BOOLEAN,
+                    LogicalType::BOOLEAN, LogicalType::UBIGINT, LogicalType::UBIGINT, LogicalType::TIMESTAMP};
+    return make_uniq<TableFunctionData>();
+}
+
+static unique_ptr<GlobalTableFunctionState> MSOLAPCacheInit(ClientContext &context, TableFunctionInitInput &input) {
+    auto result = make_uniq<MSOLAPCacheGlobalState>();
+    string directory;
+    if (MSOLAPResultCache::GetDirectory(context, directory)) {
+        result->entries = MSOLAPResultCache::Get().Entries(context, directory);
+    }
+    return std::move(result);
+}
+
+static void MSOLAPCacheScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+    auto &state = data.global_state->Cast<MSOLAPCacheGlobalState>();
+
+    idx_t count = 0;
+    while (state.offset < state.entries.size() && count < STANDARD_VECTOR_SIZE) {
+        auto &entry = state.entries[state.offset++];
+        output.SetValue(0, count, Value(entry.key));
+        output.SetValue(1, count, Value(entry.data_source));
+        output.SetValue(2, count, Value(entry.dax_query));
+        output.SetValue(3, count, Value::BOOLEAN(!entry.refresh.empty()));
+        output.SetValue(4, count, Value::BOOLEAN(entry.pinned));
+        output.SetValue(5, count, Value::UBIGINT(entry.rows));
+        output.SetValue(6, count, Value::UBIGINT(entry.bytes));
+        output.SetValue(7, count, Value::TIMESTAMP(entry.last_used));
+        count++;
+    }
+    output.SetCardinality(count);
+}
+
+MSOLAPCacheFunction::MSOLAPCacheFunction()
+    : TableFunction("msolap_cache", {}, MSOLAPCacheScan, MSOLAPCacheBind, MSOLAPCacheInit) {
+}
+
+//===--------------------------------------------------------------------===//
+// msolap_cache_pin() / msolap_cache_unpin()
+//===--------------------------------------------------------------------===//
+
+template <bool PIN>
+static void MSOLAPCachePin(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto &context = state.GetContext();
+    string directory;
+    if (!MSOLAPResultCache::GetDirectory(context, directory)) {
+        throw std::runtime_error("Set msolap_cache_directory to use the result cache");
+    }
+    BinaryExecutor::Execute<string_t, string_t, bool>(
+        args.data[0], args.data[1], result, args.size(), [&](string_t connection_string, string_t dax_query) {
+            return MSOLAPResultCache::Get().SetPinned(context, directory, connection_string.GetString(),
+                                                      dax_query.GetString(), PIN);
+        });
+}
+
+ScalarFunction MSOLAPCachePinFunction(bool pin) {
+    ScalarFunction function(pin ? "msolap_cache_pin" : "msolap_cache_unpin",
+                            {LogicalType::VARCHAR, LogicalType::VARCHAR}, LogicalType::BOOLEAN,
+                            pin ? MSOLAPCachePin<true> : MSOLAPCachePin<false>);
+    function.stability = FunctionStability::VOLATILE;
+    return function;
+}
+
+} // namespace duckdb
@@ -0,0 +1,748 @@
+#include "msolap_rowset_reader.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace duckdb {
+
+//===--------------------------------------------------------------------===//
+// MSOLAPQueryWatchdog
+//===--------------------------------------------------------------------===//
+
+void MSOLAPQueryWatchdog::Start(ICommand *command_p, ClientContext &context, idx_t timeout_ms) {
+    command = command_p;
+    watchdog.Start(
+        [this]() {
+            // ICommand::Cancel is documented as callable from another thread
+            MSOLAPConnection::InitializeCOM();
+            command->Cancel();
+        },
+        context.interrupted, timeout_ms);
+}
+
+void MSOLAPQueryWatchdog::CheckCancelled() const {
+    if (watchdog.Interrupted()) {
+        throw InterruptException();
+    }
+    if (watchdog.TimedOut()) {
+        throw std::runtime_error("MSOLAP query cancelled after exceeding msolap_query_timeout of " +
+                                 std::to_string(watchdog.TimeoutMs() / 1000) + " seconds");
+    }
+}
+
+//===--------------------------------------------------------------------===//
+// MSOLAPFetchSizer
+//===--------------------------------------------------------------------===//
+
+void MSOLAPFetchSizer::Initialize(idx_t initial_size, idx_t memory_limit, idx_t bytes_per_row) {
+    // The provider materializes every row we ask for, so budget for the bound row
+    // layout plus the HROW itself
+    idx_t row_cost = MaxValue<idx_t>(bytes_per_row + sizeof(HROW), 1);
+    max_size = MaxValue<idx_t>(memory_limit / row_cost, STANDARD_VECTOR_SIZE);
+    current_size = MinValue<idx_t>(MaxValue<idx_t>(initial_size, 1), max_size);
+    best_throughput = 0;
+    growing = true;
+    largest_size = current_size;
+}
+
+void MSOLAPFetchSizer::Update(idx_t rows_obtained, double elapsed_seconds) {
+    if (!growing || rows_obtained < current_size || elapsed_seconds <= 0) {
+        // A short batch means the rowset is draining, nothing to learn from it
+        return;
+    }
+
+    double throughput = rows_obtained / elapsed_seconds;
+    if (throughput > best_throughput * 1.1 && current_size < max_size) {
+        // Still improving - try a bigger round trip
+        best_throughput = throughput;
+        current_size = MinValue<idx_t>(current_size * 2, max_size);
+        largest_size = MaxValue<idx_t>(largest_size, current_size);
+    } else {
+        // No meaningful gain from the last increase, settle on the current size
+        best_throughput = MaxValue<double>(best_throughput, throughput);
+        growing = false;
+    }
+}
+
+bool MSOLAPFetchSizer::Shrink() {
+    if (current_size <= MSOLAP_MIN_FETCH_SIZE) {
+        return false;
+    }
+    current_size = MaxValue<idx_t>(current_size / 2, MSOLAP_MIN_FETCH_SIZE);
+    // Memory freed up later doesn't make bigger round trips safe again
+    max_size = current_size;
+    growing = false;
+    throttled++;
+    return true;
+}
+
+//===--------------------------------------------------------------------===//
+// MSOLAPRowsetReader
+//===--------------------------------------------------------------------===//
+
+MSOLAPRowsetReader::MSOLAPRowsetReader()
+    : server_timings(false), session_reused(false), command_reused(false), session_cache(nullptr), command(nullptr), rowset(nullptr), accessor(nullptr), haccessor(NULL), bindings(nullptr), column_count(0),
+      row_size(0), done(false), buffer_manager(nullptr), row_handles(nullptr), row_handles_capacity(0), end_of_rowset(false),
+      close_requested(false), scan_start(std::chrono::steady_clock::now()), logged(true) {
+}
+
+MSOLAPRowsetReader::~MSOLAPRowsetReader() {
+    Close();
+}
+
+idx_t MSOLAPRowsetReader::GetQueryTimeout(ClientContext &context) {
+    Value timeout;
+    if (!context.TryGetCurrentSetting("msolap_query_timeout", timeout) || timeout.IsNull()) {
+        return 0;
+    }
+    return timeout.GetValue<idx_t>() * 1000;
+}
+
+void MSOLAPRowsetReader::Describe(ClientContext &context, const string &connection_string,
+                                  const string &dax_query, vector<string> &names, vector<LogicalType> &types,
+                                  const vector<MSOLAPParameter> &parameters, vector<string> *references,
+                                  vector<bool> *variants) {
+    MSOLAPRowsetReader reader;
+    reader.connection_string = connection_string;
+    reader.dax_query = dax_query;
+    try {
+        MSOLAPConnection::WorkerPool().Run([&]() {
+            // Execute query to get column information
+            reader.Execute(context, parameters);
+            bool got_columns = reader.connection.GetColumnInfo(reader.rowset, names, types, references, variants);
+
+            // Only the schema was needed, Close cancels the command before the rows are produced
+            reader.Close();
+
+            if (!got_columns) {
+                throw std::runtime_error("Failed to get column information");
+            }
+        });
+    } catch (std::exception &e) {
+        reader.metrics.status = "failed";
+        reader.watchdog.CheckCancelled();
+        throw std::runtime_error("MSOLAP connection failed: " + string(e.what()));
+    }
+}
+
+void MSOLAPRowsetReader::DescribeTable(ClientContext &context, const string &connection_string,
+                                       const string &table_expression, vector<string> &names,
+                                       vector<LogicalType> &types, vector<string> *references) {
+    // FILTER keeps the columns and their lineage, FALSE() lets the engine skip the scan
+    Describe(context, connection_string, "EVALUATE FILTER(" + table_expression + ", FALSE())", names, types,
+             vector<MSOLAPParameter>(), references);
+}
+
+void MSOLAPRowsetReader::Execute(ClientContext &context, const vector<MSOLAPParameter> &parameters) {
+    // The trace has to be subscribed before the query runs. The marker comment tells
+    // its QueryEnd apart from the other sessions' ones.
+    string command_text = dax_query;
+    if (server_timings) {
+        try {
+            auto new_trace = make_uniq<MSOLAPServerTrace>();
+            new_trace->Start(connection_string);
+            command_text = new_trace->Marker() + dax_query;
+            trace = std::move(new_trace);
+        } catch (std::exception &e) {
+            // Typically missing administrator rights, the query runs untraced
+            metrics.server_timings.error = e.what();
+        }
+    }
+
+    auto phase_start = std::chrono::steady_clock::now();
+    if (parameters.empty()) {
+        // Connect to MSOLAP
+        connection = MSOLAPConnection::Connect(connection_string);
+    } else {
+        session_cache = &MSOLAPSessionCache::Get(context);
+        session = session_cache->Acquire(connection_string, session_reused);
+    }
+    auto phase_end = std::chrono::steady_clock::now();
+    metrics.connect_seconds = std::chrono::duration<double>(phase_end - phase_start).count();
+
+    // Execute the DAX query, keeping the command so it can be cancelled. Repeated
+    // executions of the same parameterized text skip parsing and preparing.
+    phase_start = phase_end;
+    ICommand* new_command = parameters.empty() ? connection.CreateCommand(command_text)
+                                               : session->GetPreparedCommand(command_text, command_reused);
+    {
+        std::lock_guard<std::mutex> guard(execute_lock);
+        command = new_command;
+        if (close_requested) {
+            throw std::runtime_error("Scan closed before the query was executed");
+        }
+    }
+    watchdog.Start(command, context, GetQueryTimeout(context));
+    if (parameters.empty()) {
+        rowset = connection.ExecuteCommand(command);
+    } else {
+        rowset = session->connection.ExecuteCommand(command, parameters);
+    }
+    metrics.execute_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - phase_start).count();
+}
+
+void MSOLAPRowsetReader::Open(ClientContext &context, const string &connection_string_p,
+                              const string &dax_query_p, const vector<MSOLAPParameter> &parameters,
+                              const vector<idx_t> &projection_p) {
+    connection_string = connection_string_p;
+    dax_query = dax_query_p;
+    projection = projection_p;
+    metrics = MSOLAPScanMetrics();
+    current_batch = MSOLAPRowBatch();
+    next_batch = MSOLAPRowBatch();
+    end_of_rowset = false;
+    done = false;
+    buffer_manager = &BufferManager::GetBufferManager(context);
+    scan_start = std::chrono::steady_clock::now();
+    logged = false;
+    Value log_file_setting;
+    if (context.TryGetCurrentSetting("msolap_query_log_file", log_file_setting) && !log_file_setting.IsNull()) {
+        log_file = log_file_setting.ToString();
+    }
+    close_requested = false;
+    open_promise = std::promise<void>();
+    opened = open_promise.get_future().share();
+
+    // The server computes the result and the first batch is fetched while DuckDB
+    // plans and runs other pipelines; only Read waits for rows
+    pending_fetch = MSOLAPConnection::WorkerPool().Async([this, &context, parameters]() {
+        try {
+            OpenRowset(context, parameters);
+        } catch (std::exception &e) {
+            {
+                std::lock_guard<std::mutex> guard(execute_lock);
+                metrics.status = close_requested ? "cancelled" : "failed";
+            }
+            std::exception_ptr error;
+            try {
+                watchdog.CheckCancelled();
+                throw std::runtime_error("MSOLAP scan initialization failed: " + string(e.what()));
+            } catch (...) {
+                error = std::current_exception();
+            }
+            open_promise.set_exception(error);
+            std::rethrow_exception(error);
+        }
+        open_promise.set_value();
+        FetchBatch(next_batch);
+    });
+}
+
+void MSOLAPRowsetReader::Attach(ClientContext &context, IRowset *rowset_p, const string &connection_string_p,
+                                const string &dax_query_p) {
+    rowset = rowset_p;
+    Open(context, connection_string_p, dax_query_p);
+    logged = true;
+}
+
+void MSOLAPRowsetReader::WaitOpen() {
+    opened.get();
+}
+
+vector<MSOLAPValueKind> MSOLAPRowsetReader::SampleValueKinds(const vector<bool> &columns) {
+    WaitOpen();
+    vector<MSOLAPValueKind> kinds(names.size(), MSOLAPValueKind::EMPTY);
+    // The open task fetches the first batch into next_batch; a failed fetch leaves
+    // it empty and the error surfaces from Read
+    if (pending_fetch.valid()) {
+        pending_fetch.wait();
+    }
+    for (idx_t row = 0; row < next_batch.row_count; row++) {
+        BYTE* row_data = next_batch.data + row * row_size;
+        for (idx_t slot = 0; slot < column_count; slot++) {
+            auto col = bound_columns[slot];
+            auto pColData = (ColumnData*)(row_data + slot * sizeof(ColumnData));
+            if (col < columns.size() && columns[col] && pColData->dwStatus == DBSTATUS_S_OK) {
+                kinds[col] = MSOLAPTypeInference::Combine(kinds[col], MSOLAPUtils::GetVariantKind(pColData->var));
+            }
+        }
+    }
+    return kinds;
+}
+
+void MSOLAPRowsetReader::OpenRowset(ClientContext &context, const vector<MSOLAPParameter> &parameters) {
+    // Attached rowsets are already executed
+    if (!rowset) {
+        Execute(context, parameters);
+    }
+
+    // Get the IAccessor interface
+    HRESULT hr = rowset->QueryInterface(IID_IAccessor, (void**)&accessor);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to get IAccessor: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+
+    // Get column information using IColumnsInfo
+    IColumnsInfo* pIColumnsInfo = NULL;
+    hr = rowset->QueryInterface(IID_IColumnsInfo, (void**)&pIColumnsInfo);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to get IColumnsInfo: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+
+    // Get column information
+    DBORDINAL cColumns;
+    WCHAR* pStringsBuffer = NULL;
+    DBCOLUMNINFO* pColumnInfo = NULL;
+
+    hr = pIColumnsInfo->GetColumnInfo(&cColumns, &pColumnInfo, &pStringsBuffer);
+    if (FAILED(hr)) {
+        MSOLAPUtils::SafeRelease(&pIColumnsInfo);
+        throw std::runtime_error("Failed to get column info: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+
+    ordinals.clear();
+    for (DBORDINAL i = 0; i < cColumns; i++) {
+        ordinals.push_back(pColumnInfo[i].iOrdinal); // 1-based ordinals
+    }
+
+    // Clean up
+    CoTaskMemFree(pColumnInfo);
+    CoTaskMemFree(pStringsBuffer);
+    MSOLAPUtils::SafeRelease(&pIColumnsInfo);
+
+    // Result schema, lets callers describe and scan with a single execution
+    names.clear();
+    types.clear();
+    references.clear();
+    if (!connection.GetColumnInfo(rowset, names, types, &references, &variant_columns)) {
+        throw std::runtime_error("Failed to get column information");
+    }
+
+    CreateAccessor();
+
+    // Size the GetNextRows batches from the settings and the bound row width
+    Value initial_size = Value::UBIGINT(STANDARD_VECTOR_SIZE);
+    Value memory_limit = Value::UBIGINT(MSOLAP_DEFAULT_FETCH_MEMORY_LIMIT);
+    context.TryGetCurrentSetting("msolap_fetch_size", initial_size);
+    context.TryGetCurrentSetting("msolap_fetch_memory_limit", memory_limit);
+    fetch_sizer.Initialize(initial_size.GetValue<idx_t>(), memory_limit.GetValue<idx_t>(), row_size);
+
+    // The HROW array is allocated once for the largest batch we may request
+    row_handles_capacity = fetch_sizer.max_size;
+    row_handles_buffer = buffer_manager->Allocate(MemoryTag::EXTENSION, row_handles_capacity * sizeof(HROW));
+    row_handles = (HROW*)row_handles_buffer.Ptr();
+}
+
+void MSOLAPRowsetReader::CreateAccessor() {
+    // Result columns to bind, in ordinal order, and the output column of each
+    bound_columns.clear();
+    output_columns.clear();
+    for (idx_t col = 0; col < ordinals.size(); col++) {
+        if (projection.empty()) {
+            bound_columns.push_back(col);
+            output_columns.push_back(col);
+            continue;
+        }
+        auto position = std::find(projection.begin(), projection.end(), col);
+        if (position != projection.end()) {
+            bound_columns.push_back(col);
+            output_columns.push_back(position - projection.begin());
+        }
+    }
+    if (bound_columns.empty() && !ordinals.empty()) {
+        // Nothing projected (COUNT(*)): one column keeps the row layout well defined
+        bound_columns.push_back(0);
+        output_columns.push_back(DConstants::INVALID_INDEX);
+    }
+
+    column_count = bound_columns.size();
+    bindings = (DBBINDING*)CoTaskMemAlloc(MaxValue<idx_t>(column_count, 1) * sizeof(DBBINDING));
+    if (!bindings) {
+        throw std::runtime_error("Failed to allocate memory for bindings");
+    }
+
+    // Set up bindings for the projected columns
+    DWORD dwOffset = 0;
+    for (DBORDINAL i = 0; i < column_count; i++) {
+        bindings[i].iOrdinal = ordinals[bound_columns[i]];
+        bindings[i].obValue = dwOffset + offsetof(ColumnData, var);
+        bindings[i].obLength = dwOffset + offsetof(ColumnData, dwLength);
+        bindings[i].obStatus = dwOffset + offsetof(ColumnData, dwStatus);
+        bindings[i].pTypeInfo = NULL;
+        bindings[i].pObject = NULL;
+        bindings[i].pBindExt = NULL;
+        bindings[i].cbMaxLen = sizeof(VARIANT);
+        bindings[i].dwFlags = 0;
+        bindings[i].eParamIO = DBPARAMIO_NOTPARAM;
+        bindings[i].dwPart = DBPART_VALUE | DBPART_LENGTH | DBPART_STATUS;
+        bindings[i].dwMemOwner = DBMEMOWNER_CLIENTOWNED;
+        bindings[i].wType = DBTYPE_VARIANT;
+        bindings[i].bPrecision = 0;
+        bindings[i].bScale = 0;
+
+        // Increment offset to next structure
+        dwOffset += sizeof(ColumnData);
+    }
+
+    // Create the accessor
+    HRESULT hr = accessor->CreateAccessor(DBACCESSOR_ROWDATA, column_count, bindings, dwOffset, &haccessor, NULL);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to create accessor: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+
+    row_size = dwOffset;
+}
+
+void MSOLAPRowsetReader::Project(const vector<idx_t> &projection_p) {
+    WaitOpen();
+    // Before the first Read only the first fetch, started by the open, can be in flight
+    if (pending_fetch.valid()) {
+        pending_fetch.wait();
+    }
+    auto old_bound = bound_columns;
+    auto old_row_size = row_size;
+    MSOLAPConnection::WorkerPool().Run([&]() {
+        accessor->ReleaseAccessor(haccessor, NULL);
+        haccessor = NULL;
+        CoTaskMemFree(bindings);
+        bindings = nullptr;
+        projection = projection_p;
+        CreateAccessor();
+    });
+    // The first batch was fetched with the previous accessor
+    CompactBatch(next_batch, old_bound, old_row_size);
+}
+
+void MSOLAPRowsetReader::CompactBatch(MSOLAPRowBatch &batch, const vector<idx_t> &old_bound, DWORD old_row_size) {
+    // Rows and columns only move towards the start of the buffer, so in place
+    // works: every target lies before the source values still to be read
+    for (idx_t row = batch.position; row < batch.row_count; row++) {
+        BYTE* source = batch.data + row * old_row_size;
+        BYTE* target = batch.data + row * row_size;
+        idx_t slot = 0;
+        for (idx_t old_slot = 0; old_slot < old_bound.size(); old_slot++) {
+            auto pColData = (ColumnData*)(source + old_slot * sizeof(ColumnData));
+            if (slot < bound_columns.size() && bound_columns[slot] == old_bound[old_slot]) {
+                memmove(target + slot * sizeof(ColumnData), pColData, sizeof(ColumnData));
+                slot++;
+            } else {
+                VariantClear(&pColData->var);
+            }
+        }
+    }
+}
+
+void MSOLAPRowsetReader::ReserveBatch(MSOLAPRowBatch &batch) {
+    // Close to memory_limit: ask for fewer rows and give back an oversized buffer
+    if (buffer_manager->GetUsedMemory() >
+        (idx_t)((double)buffer_manager->GetMaxMemory() * MSOLAP_MEMORY_PRESSURE_RATIO)) {
+        if (fetch_sizer.Shrink() && batch.capacity > fetch_sizer.current_size) {
+            batch.buffer.Destroy();
+            batch.data = nullptr;
+            batch.capacity = 0;
+        }
+    }
+
+    // The buffer only grows with the adaptive fetch size. It is reserved before
+    // GetNextRows so the provider never materializes rows there is no room for.
+    while (batch.capacity < fetch_sizer.current_size) {
+        try {
+            batch.buffer = buffer_manager->Allocate(MemoryTag::EXTENSION,
+                                                   MaxValue<idx_t>(fetch_sizer.current_size * row_size, 1));
+            batch.data = batch.buffer.Ptr();
+            batch.capacity = fetch_sizer.current_size;
+        } catch (OutOfMemoryException &) {
+            if (!fetch_sizer.Shrink()) {
+                throw;
+            }
+        }
+    }
+}
+
+void MSOLAPRowsetReader::FetchBatch(MSOLAPRowBatch &batch) {
+    ReserveBatch(batch);
+    DBROWCOUNT batch_size = (DBROWCOUNT)fetch_sizer.current_size;
+    DBCOUNTITEM cRowsObtained = 0;
+    HROW* pRows = row_handles;
+
+    auto start = std::chrono::steady_clock::now();
+    HRESULT hr = rowset->GetNextRows(0, 0, batch_size, &cRowsObtained, &pRows);
+    if (FAILED(hr)) {
+        // DB_E_CANCELED after the watchdog fired is reported as interrupt/timeout
+        watchdog.CheckCancelled();
+        metrics.status = "failed";
+        throw std::runtime_error("Failed to get rows: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+
+    // Copy the rows out so the HROWs can go back to the provider right away
+    memset(batch.data, 0, cRowsObtained * row_size);
+    for (DBCOUNTITEM i = 0; i < cRowsObtained; i++) {
+        BYTE* row = batch.data + i * row_size;
+        if (FAILED(rowset->GetData(row_handles[i], haccessor, row))) {
+            // Converted to NULLs like any other unavailable value
+            for (DBORDINAL col = 0; col < column_count; col++) {
+                ((ColumnData*)(row + col * sizeof(ColumnData)))->dwStatus = DBSTATUS_E_UNAVAILABLE;
+            }
+        }
+    }
+    if (cRowsObtained > 0) {
+        rowset->ReleaseRows(cRowsObtained, row_handles, NULL, NULL, NULL);
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+
+    metrics.fetch_seconds += elapsed.count();
+    metrics.batches++;
+    if (!metrics.first_row_seen && cRowsObtained > 0) {
+        metrics.first_row_seen = true;
+        metrics.first_row_seconds = std::chrono::duration<double>(end - scan_start).count();
+    }
+
+    batch.row_count = cRowsObtained;
+    batch.position = 0;
+    batch.end_of_rowset = hr == DB_S_ENDOFROWSET || cRowsObtained == 0;
+    fetch_sizer.Update(cRowsObtained, elapsed.count());
+}
+
+void MSOLAPRowsetReader::StartFetch() {
+    pending_fetch = MSOLAPConnection::WorkerPool().Async([this]() { FetchBatch(next_batch); });
+}
+
+void MSOLAPRowsetReader::TakeBatch() {
+    // Rethrows fetch errors on the scanning thread
+    pending_fetch.get();
+    std::swap(current_batch, next_batch);
+    end_of_rowset = current_batch.end_of_rowset;
+    if (!end_of_rowset) {
+        StartFetch();
+    }
+}
+
+void MSOLAPRowsetReader::ClearBatch(MSOLAPRowBatch &batch) {
+    for (; batch.position < batch.row_count; batch.position++) {
+        BYTE* row = batch.data + batch.position * row_size;
+        for (DBORDINAL col = 0; col < column_count; col++) {
+            VariantClear(&((ColumnData*)(row + col * sizeof(ColumnData)))->var);
+        }
+    }
+}
+
+Value MSOLAPRowsetReader::ConvertValue(idx_t col, VARIANT &var, const LogicalType &type) {
+    if (col < column_kinds.size() && column_kinds[col] != MSOLAPValueKind::EMPTY) {
+        auto kind = MSOLAPUtils::GetVariantKind(var);
+        if (!MSOLAPTypeInference::Fits(column_kinds[col], kind)) {
+            throw std::runtime_error("MSOLAP column \"" + names[col] + "\" was typed " +
+                                     MSOLAPTypeInference::TypeName(column_kinds[col]) +
+                                     " from the first rows of the result, but a later row holds the " +
+                                     MSOLAPTypeInference::TypeName(kind) + " value " +
+                                     MSOLAPUtils::ConvertVariantToValue(&var).ToString() +
+                                     ". Force a type with types := {'" + names[col] + "': '" +
+                                     MSOLAPTypeInference::TypeName(MSOLAPTypeInference::Combine(column_kinds[col], kind)) +
+                                     "'}");
+        }
+    }
+    Value value = MSOLAPUtils::ConvertVariantToValue(&var);
+    if (value.type() == type || value.IsNull()) {
+        return value;
+    }
+    Value result;
+    string error;
+    if (!value.DefaultTryCastAs(type, result, &error)) {
+        throw std::runtime_error("MSOLAP column \"" + names[col] + "\" can't hold the value " + value.ToString() +
+                                 " as " + type.ToString() + ": " + error);
+    }
+    return result;
+}
+
+idx_t MSOLAPRowsetReader::Read(DataChunk &output, idx_t column_offset) {
+    if (done) {
+        return 0;
+    }
+    watchdog.CheckCancelled();
+
+    // Conversion time is the time spent in this call minus waiting for fetches
+    auto read_start = std::chrono::steady_clock::now();
+    double wait_seconds = 0;
+
+    idx_t output_count = 0;
+    idx_t output_bytes = 0;
+
+    while (output_count < STANDARD_VECTOR_SIZE) {
+        // Switch to the prefetched batch once the current one is used up
+        if (current_batch.position >= current_batch.row_count) {
+            if (end_of_rowset) {
+                break;
+            }
+            auto wait_start = std::chrono::steady_clock::now();
+            TakeBatch();
+            wait_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - wait_start).count();
+            if (current_batch.row_count == 0) {
+                break;
+            }
+        }
+
+        BYTE* row_data = current_batch.data + current_batch.position++ * row_size;
+
+        // Extract values for each bound column
+        for (idx_t slot = 0; slot < column_count; slot++) {
+            // Get the COLUMNDATA structure for this column
+            ColumnData* pColData = (ColumnData*)(row_data + (slot * sizeof(ColumnData)));
+            if (output_columns[slot] == DConstants::INVALID_INDEX) {
+                // Bound only to count rows
+                VariantClear(&(pColData->var));
+                continue;
+            }
+            auto &out_vec = output.data[column_offset + output_columns[slot]];
+
+            if (pColData->dwStatus == DBSTATUS_S_OK) {
+                output_bytes += pColData->var.vt == VT_BSTR && pColData->var.bstrVal
+                                    ? SysStringByteLen(pColData->var.bstrVal)
+                                    : sizeof(pColData->var.llVal);
+
+                // Convert VARIANT to DuckDB value
+                Value value;
+                try {
+                    value = ConvertValue(bound_columns[slot], pColData->var, out_vec.GetType());
+                } catch (...) {
+                    // The rest of the row is no longer reachable through ClearBatch
+                    for (idx_t rest = slot; rest < column_count; rest++) {
+                        VariantClear(&((ColumnData*)(row_data + rest * sizeof(ColumnData)))->var);
+                    }
+                    throw;
+                }
+                out_vec.SetValue(output_count, value);
+
+                // Clear variant to avoid memory leaks
+                VariantClear(&(pColData->var));
+            } else {
+                // Add NULL for NULL or error values
+                FlatVector::SetNull(out_vec, output_count, true);
+            }
+        }
+        output_count++;
+    }
+    for (idx_t k = 0; k < projection.size(); k++) {
+        if (projection[k] == DConstants::INVALID_INDEX) {
+            auto &virtual_column = output.data[column_offset + k];
+            virtual_column.SetVectorType(VectorType::CONSTANT_VECTOR);
+            ConstantVector::SetNull(virtual_column, true);
+        }
+    }
+
+    metrics.rows += output_count;
+    metrics.bytes += output_bytes;
+    metrics.convert_seconds +=
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - read_start).count() - wait_seconds;
+
+    if (output_count == 0) {
+        done = true;
+        watchdog.Stop();
+        LogQuery();
+    }
+    return output_count;
+}
+
+void MSOLAPRowsetReader::LogQuery() {
+    if (logged) {
+        return;
+    }
+    logged = true;
+    if (metrics.status == "running") {
+        if (watchdog.Interrupted()) {
+            metrics.status = "interrupted";
+        } else if (watchdog.TimedOut()) {
+            metrics.status = "timed out";
+        } else {
+            metrics.status = end_of_rowset ? "completed" : "stopped early";
+        }
+    }
+    try {
+        if (trace) {
+            // The server reports the end of a drained query right away; a cancelled
+            // one would only keep the scan waiting
+            metrics.server_timings = trace->Finish(end_of_rowset ? MSOLAP_TRACE_FINISH_TIMEOUT_MS : 0);
+        }
+        MSOLAPQueryLog::Get().Record(connection_string, dax_query, metrics, log_file);
+    } catch (...) {
+        // Telemetry must never fail the query
+    }
+}
+
+void MSOLAPRowsetReader::Close() {
+    // Until the open completes the pool may still start the watchdog, stop it after the wait
+    bool opening = opened.valid() && opened.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+    if (!opening) {
+        watchdog.Stop();
+        LogQuery();
+    }
+
+    auto &pool = MSOLAPConnection::WorkerPool();
+    try {
+        // Stopped before the end (LIMIT satisfied, error, interrupt) - don't leave
+        // the server evaluating a result nobody will read. This also unblocks an
+        // Execute or a fetch still waiting in GetNextRows, and keeps a queued open
+        // from executing at all.
+        ICommand* running;
+        {
+            std::lock_guard<std::mutex> guard(execute_lock);
+            close_requested = true;
+            running = end_of_rowset ? nullptr : command;
+            if (running) {
+                running->AddRef();
+            }
+        }
+        if (running) {
+            // From this thread like the watchdog: on a saturated pool the cancel would
+            // queue behind the Execute and GetNextRows calls it has to interrupt
+            MSOLAPConnection::InitializeCOM();
+            running->Cancel();
+            running->Release();
+        }
+        // Wait here rather than on a worker, the fetch may still be queued behind other tasks
+        if (pending_fetch.valid()) {
+            pending_fetch.wait();
+            pending_fetch = std::future<void>();
+            ClearBatch(next_batch);
+        }
+        watchdog.Stop();
+        LogQuery();
+        ClearBatch(current_batch);
+        pool.Run([&]() { ReleaseRowset(); });
+    } catch (...) {
+        // Close also runs from destructors
+    }
+    done = true;
+}
+
+void MSOLAPRowsetReader::ReleaseRowset() {
+    row_handles_buffer.Destroy();
+    row_handles = nullptr;
+
+    if (bindings) {
+        CoTaskMemFree(bindings);
+        bindings = nullptr;
+    }
+
+    if (accessor && haccessor) {
+        accessor->ReleaseAccessor(haccessor, NULL);
+        haccessor = NULL;
+    }
+
+    if (accessor) {
+        MSOLAPUtils::SafeRelease(&accessor);
+    }
+
+    if (rowset) {
+        MSOLAPUtils::SafeRelease(&rowset);
+    }
+
+    if (command) {
+        if (session && metrics.status != "failed" && !trace) {
+            // Keep the prepared command for the next execution with other values
+            session->ReturnPreparedCommand(dax_query, command);
+            command = nullptr;
+        } else {
+            MSOLAPUtils::SafeRelease(&command);
+        }
+    }
+
+    if (session) {
+        if (metrics.status != "failed") {
+            session_cache->Release(connection_string, std::move(session));
+        }
+        session.reset();
+    }
+
+    connection.Close();
+}
+
+} // namespace duckdb
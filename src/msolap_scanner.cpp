@@ -1,48 +1,294 @@
 #include "duckdb.hpp"
 #include "msolap_scanner.hpp"
 #include "msolap_utils.hpp"
+#include "msolap_filter_pushdown.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/parser/expression/constant_expression.hpp"
+#include "duckdb/parser/expression/function_expression.hpp"
+#include "duckdb/parser/tableref/table_function_ref.hpp"
 #include <stdexcept>
 
 namespace duckdb {
 
+// Serve the query from the result cache when the model hasn't been refreshed since
+static unique_ptr<TableRef> MSOLAPBindReplace(ClientContext &context, TableFunctionBindInput &input) {
+    string directory;
+    if (!MSOLAPResultCache::GetDirectory(context, directory) || input.named_parameters.count("params") > 0 ||
+        input.named_parameters.count("types") > 0 || input.named_parameters.count("columns") > 0 ||
+        input.named_parameters.count("server_timings") > 0) {
+        return nullptr;
+    }
+    string path;
+    try {
+        path = MSOLAPResultCache::Get().Lookup(context, directory, input.inputs[0].GetValue<string>(),
+                                               input.inputs[1].GetValue<string>());
+    } catch (InterruptException &) {
+        throw;
+    } catch (std::exception &) {
+        // No refresh state (permissions, old server) or an unusable directory: no caching
+        return nullptr;
+    }
+    if (path.empty()) {
+        return nullptr;
+    }
+    auto result = make_uniq<TableFunctionRef>();
+    vector<unique_ptr<ParsedExpression>> children;
+    children.push_back(make_uniq<ConstantExpression>(Value(path)));
+    result->function = make_uniq<FunctionExpression>("read_parquet", std::move(children));
+    return std::move(result);
+}
+
+// types := {'Amount': 'DECIMAL(18,2)'}, by column name or DAX reference. INVALID for
+// the columns that keep their type.
+static vector<LogicalType> MSOLAPForcedTypes(ClientContext &context, const Value &types_value,
+                                             const vector<string> &names, const vector<string> &references) {
+    vector<LogicalType> result(names.size());
+    if (types_value.IsNull()) {
+        return result;
+    }
+    if (types_value.type().id() != LogicalTypeId::STRUCT) {
+        throw std::runtime_error("types must be a struct, e.g. types := {'Amount': 'DOUBLE'}");
+    }
+    auto &child_types = StructType::GetChildTypes(types_value.type());
+    auto &children = StructValue::GetChildren(types_value);
+    for (idx_t i = 0; i < children.size(); i++) {
+        auto &column = child_types[i].first;
+        idx_t index = 0;
+        while (index < names.size() && !StringUtil::CIEquals(names[index], column) &&
+               !(index < references.size() && StringUtil::CIEquals(references[index], column))) {
+            index++;
+        }
+        if (index == names.size()) {
+            throw std::runtime_error("types: the DAX query has no column \"" + column + "\"");
+        }
+        if (children[i].IsNull()) {
+            throw std::runtime_error("types: no type given for column \"" + column + "\"");
+        }
+        result[index] = TransformStringToLogicalType(children[i].ToString(), context);
+    }
+    return result;
+}
+
+// columns := {'Color': 'VARCHAR', 'Sales[Amount]': 'DECIMAL(19,4)'}: the result
+// schema as declared, in order. Names given as DAX references are sanitized like
+// the provider's column names and kept as the references filters are pushed on.
+static void MSOLAPDeclaredColumns(ClientContext &context, const Value &columns_value, MSOLAPBindData &bind_data) {
+    if (columns_value.type().id() != LogicalTypeId::STRUCT) {
+        throw std::runtime_error("columns must be a struct, e.g. columns := {'Color': 'VARCHAR', 'Total': 'DOUBLE'}");
+    }
+    auto &child_types = StructType::GetChildTypes(columns_value.type());
+    auto &children = StructValue::GetChildren(columns_value);
+    for (idx_t i = 0; i < children.size(); i++) {
+        auto &column = child_types[i].first;
+        if (children[i].IsNull()) {
+            throw std::runtime_error("columns: no type given for column \"" + column + "\"");
+        }
+        auto name = StringUtil::Replace(StringUtil::Replace(column, "[", "_"), "]", "_");
+        for (auto &existing : bind_data.names) {
+            if (StringUtil::CIEquals(existing, name)) {
+                throw std::runtime_error("columns: column \"" + column + "\" is declared twice");
+            }
+        }
+        bind_data.names.push_back(name);
+        bind_data.column_references.push_back(column);
+        bind_data.types.push_back(TransformStringToLogicalType(children[i].ToString(), context));
+    }
+    bind_data.column_kinds.assign(bind_data.names.size(), MSOLAPValueKind::EMPTY);
+    bind_data.declared_schema = true;
+}
+
+// Broad kind of a type, for catching a declared type that can't hold the provider's values
+static idx_t MSOLAPTypeFamily(const LogicalType &type) {
+    if (type.IsNumeric() || type.id() == LogicalTypeId::BOOLEAN) {
+        return 1;
+    }
+    if (type.IsTemporal()) {
+        return 2;
+    }
+    return type.id() == LogicalTypeId::VARCHAR ? 3 : 0;
+}
+
+// Result column of every declared column. The query's result is only seen at scan
+// init, so a schema that changed on the server fails here, before the first row.
+static vector<idx_t> MSOLAPMatchDeclaredColumns(const MSOLAPBindData &bind_data, MSOLAPRowsetReader &reader) {
+    reader.WaitOpen();
+    auto mismatch = [&](const string &reason) {
+        return std::runtime_error("msolap: the result of the DAX query doesn't match the declared columns, " + reason +
+                                  ". The query returns " + StringUtil::Join(reader.references, ", "));
+    };
+    if (reader.names.size() != bind_data.names.size()) {
+        throw mismatch(to_string(bind_data.names.size()) + " columns are declared but the query returns " +
+                       to_string(reader.names.size()));
+    }
+    vector<idx_t> result;
+    vector<bool> used(reader.names.size(), false);
+    for (idx_t i = 0; i < bind_data.names.size(); i++) {
+        auto &declared = bind_data.column_references[i];
+        // By output name or DAX reference; a bare name also matches Table[name] if unique
+        idx_t match = DConstants::INVALID_INDEX;
+        idx_t suffix_match = DConstants::INVALID_INDEX;
+        idx_t suffix_matches = 0;
+        for (idx_t col = 0; col < reader.names.size(); col++) {
+            auto &reference = col < reader.references.size() ? reader.references[col] : reader.names[col];
+            if (used[col]) {
+                continue;
+            }
+            if (StringUtil::CIEquals(reader.names[col], bind_data.names[i]) ||
+                StringUtil::CIEquals(reference, declared) || StringUtil::CIEquals(reference, "[" + declared + "]")) {
+                match = col;
+                break;
+            }
+            if (declared.find('[') == string::npos &&
+                StringUtil::EndsWith(StringUtil::Lower(reference), "[" + StringUtil::Lower(declared) + "]")) {
+                suffix_match = col;
+                suffix_matches++;
+            }
+        }
+        if (match == DConstants::INVALID_INDEX && suffix_matches == 1) {
+            match = suffix_match;
+        }
+        if (match == DConstants::INVALID_INDEX) {
+            throw mismatch("there is no column \"" + declared + "\"");
+        }
+        bool variant = match < reader.variant_columns.size() && reader.variant_columns[match];
+        auto family = MSOLAPTypeFamily(reader.types[match]);
+        auto declared_family = MSOLAPTypeFamily(bind_data.types[i]);
+        if (!variant && family != 0 && declared_family != 3 && family != declared_family) {
+            throw mismatch("column \"" + declared + "\" is " + reader.types[match].ToString() + " and can't be read as " +
+                           bind_data.types[i].ToString());
+        }
+        used[match] = true;
+        result.push_back(match);
+    }
+    return result;
+}
+
+static bool MSOLAPExecuteAtBind(ClientContext &context) {
+    Value execute_at_bind = Value::BOOLEAN(true);
+    context.TryGetCurrentSetting("msolap_execute_at_bind", execute_at_bind);
+    return !execute_at_bind.IsNull() && execute_at_bind.GetValue<bool>();
+}
+
 static unique_ptr<FunctionData> MSOLAPBind(ClientContext &context, TableFunctionBindInput &input,
                                          vector<LogicalType> &return_types, vector<string> &names) {
-    MSOLAPConnection::InitializeCOM();
     auto result = make_uniq<MSOLAPBindData>();
     
     // Get connection string and DAX query from input
     result->connection_string = input.inputs[0].GetValue<string>();
     result->dax_query = input.inputs[1].GetValue<string>();
+
+    Value types_value;
+    Value columns_value;
+    for (auto &kv : input.named_parameters) {
+        if (kv.first == "params") {
+            result->parameters = MSOLAPParameters::FromStruct(kv.second);
+        } else if (kv.first == "types") {
+            types_value = kv.second;
+        } else if (kv.first == "columns") {
+            columns_value = kv.second;
+        } else if (kv.first == "server_timings") {
+            result->server_timings = !kv.second.IsNull() && kv.second.GetValue<bool>();
+        }
+    }
     
-    try {
-        // Connect to MSOLAP and execute query to get column information
-        MSOLAPConnection connection = MSOLAPConnection::Connect(result->connection_string);
-        IRowset* rowset = connection.ExecuteQuery(result->dax_query);
-        
-        // Get column information
-        if (!connection.GetColumnInfo(rowset, result->names, result->types)) {
-            MSOLAPUtils::SafeRelease(&rowset);
-            throw std::runtime_error("Failed to get column information");
+    if (!columns_value.IsNull()) {
+        if (!types_value.IsNull()) {
+            throw std::runtime_error("columns and types can't be combined, declare the types in columns");
         }
-        
-        MSOLAPUtils::SafeRelease(&rowset);
-        connection.Close();
-        
-        // Copy output column names and types
-        names.clear();
-        return_types.clear();
-
-        for (auto &name : result->names) {
-            names.push_back(name);
+        // Known schema: bind doesn't wait for the server, scan init checks the result
+        MSOLAPDeclaredColumns(context, columns_value, *result);
+        names = result->names;
+        return_types = result->types;
+        if (names.empty()) {
+            throw std::runtime_error("columns must declare at least one column");
         }
+        if (MSOLAPExecuteAtBind(context)) {
+            // Nothing waits for this execution, the server works while DuckDB plans
+            auto reader = make_uniq<MSOLAPRowsetReader>();
+            reader->server_timings = result->server_timings;
+            reader->Open(context, result->connection_string, result->dax_query, result->parameters);
+            result->bind_reader = std::move(reader);
+        }
+        return std::move(result);
+    }
+
+    unique_ptr<MSOLAPRowsetReader> reader;
+    vector<bool> variants;
+    if (!MSOLAPExecuteAtBind(context)) {
+        // Execute query to get column information
+        MSOLAPRowsetReader::Describe(context, result->connection_string, result->dax_query, result->names,
+                                     result->types, result->parameters, &result->column_references, &variants);
+    } else {
+        // Learn the schema from an execution that stays open for the scan. The schema
+        // is only known once the server has executed the query, bind waits for that.
+        reader = make_uniq<MSOLAPRowsetReader>();
+        reader->server_timings = result->server_timings;
+        reader->Open(context, result->connection_string, result->dax_query, result->parameters);
+        reader->WaitOpen();
+        result->names = reader->names;
+        result->types = reader->types;
+        result->column_references = reader->references;
+        variants = reader->variant_columns;
+    }
 
-        for (auto &type : result->types) {
-            return_types.push_back(type);
+    // DBTYPE_VARIANT columns would all be VARCHAR, type them from the values of the
+    // first batch unless the user gave a type
+    auto forced_types = MSOLAPForcedTypes(context, types_value, result->names, result->column_references);
+    vector<bool> infer(result->names.size(), false);
+    bool any_inferred = false;
+    for (idx_t i = 0; i < infer.size() && i < variants.size(); i++) {
+        infer[i] = variants[i] && forced_types[i].id() == LogicalTypeId::INVALID;
+        any_inferred = any_inferred || infer[i];
+    }
+    result->column_kinds.assign(result->names.size(), MSOLAPValueKind::EMPTY);
+    if (any_inferred) {
+        vector<MSOLAPValueKind> kinds;
+        if (reader) {
+            kinds = reader->SampleValueKinds(infer);
+        } else {
+            // Describe doesn't read rows, sample a separate execution
+            MSOLAPRowsetReader sample;
+            sample.Open(context, result->connection_string, result->dax_query, result->parameters);
+            kinds = sample.SampleValueKinds(infer);
+            sample.Close();
+        }
+        for (idx_t i = 0; i < infer.size(); i++) {
+            if (!infer[i]) {
+                continue;
+            }
+            auto kind = MSOLAPTypeInference::Finalize(kinds[i]);
+            result->types[i] = MSOLAPUtils::GetLogicalTypeFromValueKind(kind);
+            if (kind != MSOLAPValueKind::STRING) {
+                result->column_kinds[i] = kind;
+            }
         }
-        
-    } catch (std::exception &e) {
-        throw std::runtime_error("MSOLAP connection failed: " + string(e.what()));
     }
+    for (idx_t i = 0; i < forced_types.size(); i++) {
+        if (forced_types[i].id() != LogicalTypeId::INVALID) {
+            result->types[i] = forced_types[i];
+        }
+    }
+    if (reader) {
+        reader->column_kinds = result->column_kinds;
+        result->bind_reader = std::move(reader);
+    }
+
+    // Missed the result cache: remember what to store once the result is read
+    string cache_directory;
+    if (result->parameters.empty() && types_value.IsNull() &&
+        MSOLAPResultCache::GetDirectory(context, cache_directory)) {
+        auto &entry = result->cache_entry;
+        entry.key = MSOLAPResultCache::Key(result->connection_string, result->dax_query);
+        if (MSOLAPResultCache::Get().TakeRefreshState(entry.key, entry.refresh)) {
+            result->cache_directory = cache_directory;
+            entry.data_source = MSOLAPConnection::GetDataSource(result->connection_string);
+            entry.dax_query = result->dax_query;
+        }
+    }
+
+    // Copy output column names and types
+    names = result->names;
+    return_types = result->types;
     
     if (names.empty()) {
         throw std::runtime_error("No columns found in DAX query result");
@@ -53,190 +299,138 @@ static unique_ptr<FunctionData> MSOLAPBind(ClientContext &context, TableFunction
 
 static unique_ptr<GlobalTableFunctionState> MSOLAPInitGlobalState(ClientContext &context,
                                                               TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<MSOLAPBindData>();
     // MSOLAP doesn't support parallel execution
-    return make_uniq<MSOLAPGlobalState>(1);
+    auto result = make_uniq<MSOLAPGlobalState>(1);
+    result->dax_query = bind_data.dax_query;
+    result->pushdowns = bind_data.pushdowns;
+    result->reader = bind_data.TakeBindReader();
+
+    // Only the columns DuckDB reads are bound, the provider never materializes the rest
+    for (idx_t i = 0; i < input.column_ids.size(); i++) {
+        auto column_id = input.column_ids[i];
+        result->projection.push_back(column_id < bind_data.types.size() ? column_id : DConstants::INVALID_INDEX);
+        result->full_projection = result->full_projection && column_id == i;
+    }
+    result->full_projection = result->full_projection && input.column_ids.size() == bind_data.types.size();
+
+    if (!input.filters) {
+        return std::move(result);
+    }
+
+    // Global init runs once the build side of a join is complete, so input.filters
+    // also carries the join's runtime key filters at this point
+    MSOLAPFilterPushdown pushdown(bind_data.column_references, bind_data.types,
+                                  MSOLAPFilterPushdown::KeyThreshold(context));
+    pushdown.AddFilters(*input.filters, input.column_ids);
+    string rewritten = pushdown.Rewrite(bind_data.dax_query);
+    if (rewritten != bind_data.dax_query) {
+        result->dax_query = rewritten;
+        result->pushdowns.insert(result->pushdowns.end(), pushdown.pushdowns.begin(), pushdown.pushdowns.end());
+        // The bind-time execution computes the unfiltered result, cancel it
+        result->reader.reset();
+    }
+    result->filter = MSOLAPFilterPushdown::LocalFilter(*input.filters, input.column_ids, bind_data.types);
+    return std::move(result);
 }
 
 static unique_ptr<LocalTableFunctionState>
 MSOLAPInitLocalState(ExecutionContext &context, TableFunctionInitInput &input, GlobalTableFunctionState *global_state) {
-    MSOLAPConnection::InitializeCOM();
     auto &bind_data = input.bind_data->Cast<MSOLAPBindData>();
+    auto &gstate = global_state->Cast<MSOLAPGlobalState>();
     auto result = make_uniq<MSOLAPLocalState>();
-    
-    try {
-        // Connect to MSOLAP
-        result->connection = MSOLAPConnection::Connect(bind_data.connection_string);
-        
-        // Execute the DAX query
-        result->rowset = result->connection.ExecuteQuery(bind_data.dax_query);
-        
-        // Get the IAccessor interface
-        HRESULT hr = result->rowset->QueryInterface(IID_IAccessor, (void**)&result->accessor);
-        if (FAILED(hr)) {
-            throw std::runtime_error("Failed to get IAccessor: " + MSOLAPUtils::GetErrorMessage(hr));
-        }
-        
-        // Create bindings for all columns
-        DBORDINAL column_count = bind_data.names.size();
-        result->bindings = (DBBINDING*)CoTaskMemAlloc(column_count * sizeof(DBBINDING));
-        if (!result->bindings) {
-            throw std::runtime_error("Failed to allocate memory for bindings");
-        }
 
-        // Get column information using IColumnsInfo
-        IColumnsInfo* pIColumnsInfo = NULL;
-        hr = result->rowset->QueryInterface(IID_IColumnsInfo, (void**)&pIColumnsInfo);
-        if (FAILED(hr)) {
-            throw std::runtime_error("Failed to get IColumnsInfo: " + MSOLAPUtils::GetErrorMessage(hr));
-        }
+    {
+        std::lock_guard<std::mutex> guard(gstate.reader_lock);
+        result->reader = std::move(gstate.reader);
+    }
+    result->executed_at_bind = result->reader != nullptr;
 
-        // Get column information
-        DBORDINAL cColumns;
-        WCHAR* pStringsBuffer = NULL;
-        DBCOLUMNINFO* pColumnInfo = NULL;
+    // Only the complete result of the query as written is cached. A scan without real
+    // columns (the row id of COUNT(*)) still reads every column to fill the cache.
+    bool virtual_projection = true;
+    for (auto column : gstate.projection) {
+        virtual_projection = virtual_projection && column == DConstants::INVALID_INDEX;
+    }
+    if (!bind_data.cache_directory.empty() && gstate.dax_query == bind_data.dax_query &&
+        (gstate.full_projection || virtual_projection)) {
+        try {
+            result->cache_writer = make_uniq<MSOLAPCacheWriter>(context.client, bind_data.cache_directory,
+                                                                bind_data.cache_entry, bind_data.names,
+                                                                bind_data.types);
+        } catch (std::exception &) {
+            // Best effort, scan without caching
+        }
+    }
+    bool read_all = gstate.full_projection || result->cache_writer;
+    if (!gstate.full_projection && result->cache_writer) {
+        result->cache_chunk.Initialize(context.client, bind_data.types);
+    }
 
-        hr = pIColumnsInfo->GetColumnInfo(&cColumns, &pColumnInfo, &pStringsBuffer);
-        if (FAILED(hr)) {
-            MSOLAPUtils::SafeRelease(&pIColumnsInfo);
-            throw std::runtime_error("Failed to get column info: " + MSOLAPUtils::GetErrorMessage(hr));
+    auto projection = read_all ? vector<idx_t>() : gstate.projection;
+    if (bind_data.declared_schema) {
+        // Every column is bound until the result is matched against the declaration
+        if (!result->reader) {
+            result->reader = make_uniq<MSOLAPRowsetReader>();
+            result->reader->server_timings = bind_data.server_timings;
+            result->reader->Open(context.client, bind_data.connection_string, gstate.dax_query,
+                                 bind_data.parameters);
         }
-        
-        // Set up bindings for all columns
-        DWORD dwOffset = 0;
-        for (DBORDINAL i = 0; i < column_count; i++) {
-            result->bindings[i].iOrdinal = pColumnInfo[i].iOrdinal; // 1-based ordinals
-            result->bindings[i].obValue = dwOffset + offsetof(ColumnData, var);
-            result->bindings[i].obLength = dwOffset + offsetof(ColumnData, dwLength);
-            result->bindings[i].obStatus = dwOffset + offsetof(ColumnData, dwStatus);
-            result->bindings[i].pTypeInfo = NULL;
-            result->bindings[i].pObject = NULL;
-            result->bindings[i].pBindExt = NULL;
-            result->bindings[i].cbMaxLen = sizeof(VARIANT);
-            result->bindings[i].dwFlags = 0;
-            result->bindings[i].eParamIO = DBPARAMIO_NOTPARAM;
-            result->bindings[i].dwPart = DBPART_VALUE | DBPART_LENGTH | DBPART_STATUS;
-            result->bindings[i].dwMemOwner = DBMEMOWNER_CLIENTOWNED;
-            result->bindings[i].wType = DBTYPE_VARIANT;
-            result->bindings[i].bPrecision = 0;
-            result->bindings[i].bScale = 0;
-            
-            // Increment offset to next structure
-            dwOffset += sizeof(ColumnData);
+        auto columns = MSOLAPMatchDeclaredColumns(bind_data, *result->reader);
+        vector<idx_t> declared_projection;
+        for (idx_t i = 0; i < (read_all ? bind_data.types.size() : gstate.projection.size()); i++) {
+            auto column = read_all ? i : gstate.projection[i];
+            declared_projection.push_back(column == DConstants::INVALID_INDEX ? column : columns[column]);
         }
-
-        // Clean up
-        CoTaskMemFree(pColumnInfo);
-        CoTaskMemFree(pStringsBuffer);
-        MSOLAPUtils::SafeRelease(&pIColumnsInfo);
-
-        // Create the accessor
-        hr = result->accessor->CreateAccessor(
-            DBACCESSOR_ROWDATA,
-            column_count,
-            result->bindings,
-            dwOffset,
-            &result->haccessor,
-            NULL
-        );
-        
-        if (FAILED(hr)) {
-            throw std::runtime_error("Failed to create accessor: " + MSOLAPUtils::GetErrorMessage(hr));
+        result->reader->Project(declared_projection);
+    } else if (result->reader) {
+        if (!gstate.full_projection) {
+            result->reader->Project(projection);
         }
-        
-        // Allocate buffer for row data
-        result->row_size = dwOffset;
-        result->row_data = new BYTE[result->row_size];
-        
-        result->done = false;
-        
-    } catch (std::exception &e) {
-        throw std::runtime_error("MSOLAP scan initialization failed: " + string(e.what()));
+    } else {
+        // Connect to MSOLAP and execute the DAX query, without waiting for it
+        result->reader = make_uniq<MSOLAPRowsetReader>();
+        result->reader->column_kinds = bind_data.column_kinds;
+        result->reader->server_timings = bind_data.server_timings;
+        result->reader->Open(context.client, bind_data.connection_string, gstate.dax_query, bind_data.parameters,
+                             projection);
     }
+    result->filter.Initialize(context.client, gstate.filter.get());
     
     return std::move(result);
 }
 
 static void MSOLAPScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
     auto &state = data.local_state->Cast<MSOLAPLocalState>();
-    auto &bind_data = data.bind_data->Cast<MSOLAPBindData>();
-    
-    if (state.done) {
-        return;
-    }
-    
-    // Process rows in batches
-    const DBROWCOUNT batch_size = STANDARD_VECTOR_SIZE;
-    HROW* pRows = new HROW[batch_size];
-    DBCOUNTITEM cRowsObtained = 0;
-    
-    HRESULT hr = state.rowset->GetNextRows(0, 0, batch_size, &cRowsObtained, &pRows);
-    if (FAILED(hr)) {
-        delete[] pRows;
-        throw std::runtime_error("Failed to get rows: " + MSOLAPUtils::GetErrorMessage(hr));
-    }
-    
-    if (cRowsObtained == 0) {
-        state.done = true;
-        delete[] pRows;
-        return;
-    }
-    
-    // Prepare vectors for each column type
-    const idx_t col_count = output.ColumnCount();
-    std::vector<std::vector<Value>> column_values(col_count);
-    for (idx_t col = 0; col < col_count; col++) {
-        column_values[col].reserve(cRowsObtained);
-    }
-    
-    // Get data for all rows
-    for (DBCOUNTITEM i = 0; i < cRowsObtained; i++) {
-        // Clear the buffer before getting new data
-        memset(state.row_data, 0, state.row_size);
-        
-        // Get the row data
-        hr = state.rowset->GetData(pRows[i], state.haccessor, state.row_data);
-        if (FAILED(hr)) {
-            // On error, add NULL values for all columns
-            for (idx_t col = 0; col < col_count; col++) {
-                column_values[col].push_back(Value());
+
+    while (true) {
+        idx_t count;
+        if (state.cache_chunk.ColumnCount() > 0) {
+            // Only virtual columns are projected, the cache gets the columns read
+            state.cache_chunk.Reset();
+            count = state.reader->Read(state.cache_chunk);
+            state.cache_chunk.SetCardinality(count);
+            for (auto &column : output.data) {
+                column.SetVectorType(VectorType::CONSTANT_VECTOR);
+                ConstantVector::SetNull(column, true);
             }
-            continue;
+        } else {
+            count = state.reader->Read(output);
         }
-        
-        // Extract values for each column
-        for (idx_t col = 0; col < col_count; col++) {
-            // Get the COLUMNDATA structure for this column
-            ColumnData* pColData = (ColumnData*)(state.row_data + (col * sizeof(ColumnData)));
-            
-            if (pColData->dwStatus == DBSTATUS_S_OK) {
-                // Convert VARIANT to DuckDB value
-                Value val = MSOLAPUtils::ConvertVariantToValue(&(pColData->var));
-                column_values[col].push_back(val);
-                
-                // Clear variant to avoid memory leaks
-                VariantClear(&(pColData->var));
+        output.SetCardinality(count);
+        if (state.cache_writer) {
+            // Before the local filter: the cache holds the unfiltered result
+            if (count == 0) {
+                state.cache_writer->Commit();
+                state.cache_writer.reset();
             } else {
-                // Add NULL for NULL or error values
-                column_values[col].push_back(Value());
+                state.cache_writer->Append(state.cache_chunk.ColumnCount() > 0 ? state.cache_chunk : output);
             }
         }
-    }
-    
-    // Release the row handles
-    state.rowset->ReleaseRows(cRowsObtained, pRows, NULL, NULL, NULL);
-    delete[] pRows;
-    
-    // Now use bulk operations to populate the output vectors
-    for (idx_t col = 0; col < col_count; col++) {
-        auto &out_vec = output.data[col];
-        
-        // For each column, set all values at once
-        for (idx_t row = 0; row < column_values[col].size(); row++) {
-            out_vec.SetValue(row, column_values[col][row]);
+        if (count == 0 || state.filter.Apply(output)) {
+            return;
         }
     }
-    
-    output.SetCardinality(cRowsObtained);
 }
 
 static InsertionOrderPreservingMap<string> MSOLAPToString(TableFunctionToStringInput &input) {
@@ -245,14 +439,114 @@ static InsertionOrderPreservingMap<string> MSOLAPToString(TableFunctionToStringI
     
     result["Connection"] = bind_data.connection_string;
     result["Query"] = bind_data.dax_query;
+    if (!bind_data.parameters.empty()) {
+        result["Parameters"] = MSOLAPParameters::ToString(bind_data.parameters);
+    }
+    vector<string> inferred;
+    for (idx_t i = 0; i < bind_data.column_kinds.size(); i++) {
+        if (bind_data.column_kinds[i] != MSOLAPValueKind::EMPTY) {
+            inferred.push_back(bind_data.names[i] + " " + bind_data.types[i].ToString());
+        }
+    }
+    if (!inferred.empty()) {
+        result["Inferred Types"] = StringUtil::Join(inferred, ", ");
+    }
+    if (bind_data.declared_schema) {
+        result["Schema"] = "declared";
+    }
     
     return result;
 }
 
+static string MSOLAPFormatMilliseconds(double seconds) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.3f ms", seconds * 1000);
+    return buffer;
+}
+
+static InsertionOrderPreservingMap<string> MSOLAPDynamicToString(TableFunctionDynamicToStringInput &input) {
+    InsertionOrderPreservingMap<string> result;
+    if (!input.local_state) {
+        return result;
+    }
+    auto &local_state = input.local_state->Cast<MSOLAPLocalState>();
+    auto &reader = *local_state.reader;
+    auto &sizer = reader.fetch_sizer;
+    auto &metrics = reader.metrics;
+
+    result["Executed Query"] = reader.dax_query;
+    result["Executed At"] = local_state.executed_at_bind ? "bind" : "scan start";
+    if (input.global_state) {
+        auto &gstate = input.global_state->Cast<MSOLAPGlobalState>();
+        result["Pushdown"] = gstate.pushdowns.empty() ? "none" : StringUtil::Join(gstate.pushdowns, ", ");
+        if (input.bind_data) {
+            idx_t projected = 0;
+            for (auto column : gstate.projection) {
+                projected += column != DConstants::INVALID_INDEX;
+            }
+            auto total = input.bind_data->Cast<MSOLAPBindData>().types.size();
+            result["Bound Columns"] = to_string(gstate.full_projection ? total : projected) + " of " + to_string(total);
+        }
+    }
+    if (input.bind_data) {
+        auto &bind_data = input.bind_data->Cast<MSOLAPBindData>();
+        if (!bind_data.parameters.empty()) {
+            result["Session"] = reader.session_reused ? "pooled" : "new";
+            result["Prepared Command"] = reader.command_reused ? "reused" : "prepared";
+        }
+    }
+
+    // Where the time went: connect and execute happen once, fetch and convert per batch
+    result["Connect Time"] = MSOLAPFormatMilliseconds(metrics.connect_seconds);
+    result["Execute Time"] = MSOLAPFormatMilliseconds(metrics.execute_seconds);
+    result["Time To First Row"] = MSOLAPFormatMilliseconds(metrics.first_row_seconds);
+    result["Fetch Time"] = MSOLAPFormatMilliseconds(metrics.fetch_seconds);
+    result["Convert Time"] = MSOLAPFormatMilliseconds(metrics.convert_seconds);
+
+    result["Rows"] = to_string(metrics.rows);
+    result["Bytes"] = to_string(metrics.bytes);
+    result["Rows Per Batch"] = to_string(metrics.batches == 0 ? 0 : metrics.rows / metrics.batches);
+    result["Fetch Batches"] = to_string(metrics.batches);
+    result["Fetch Size"] = to_string(sizer.current_size);
+    result["Largest Fetch Size"] = to_string(sizer.largest_size);
+    result["Max Fetch Size"] = to_string(sizer.max_size);
+    if (sizer.throttled > 0) {
+        result["Memory Throttled"] = to_string(sizer.throttled) + "x";
+    }
+
+    // Storage engine vs. formula engine, as reported by the server trace
+    if (reader.server_timings) {
+        auto &timings = metrics.server_timings;
+        if (timings.captured) {
+            result["Server Time"] = MSOLAPFormatMilliseconds(timings.total_ms / 1000);
+            result["SE Time"] = MSOLAPFormatMilliseconds(timings.se_ms / 1000);
+            result["FE Time"] = MSOLAPFormatMilliseconds(timings.fe_ms / 1000);
+            result["SE CPU Time"] = MSOLAPFormatMilliseconds(timings.se_cpu_ms / 1000);
+            result["SE Queries"] = to_string(timings.se_queries);
+            result["SE Cache Hits"] = to_string(timings.se_cache_hits);
+        } else {
+            result["Server Timings"] =
+                "unavailable" + (timings.error.empty() ? string() : " (" + timings.error + ")");
+        }
+    }
+
+    return result;
+}
+
 MSOLAPScanFunction::MSOLAPScanFunction()
     : TableFunction("msolap", {LogicalType::VARCHAR, LogicalType::VARCHAR}, MSOLAPScan, MSOLAPBind,
                     MSOLAPInitGlobalState, MSOLAPInitLocalState) {
+    named_parameters["params"] = LogicalType::ANY;
+    named_parameters["types"] = LogicalType::ANY;
+    named_parameters["columns"] = LogicalType::ANY;
+    named_parameters["server_timings"] = LogicalType::BOOLEAN;
+    bind_replace = MSOLAPBindReplace;
+    // Receives constant predicates and the runtime key filters of hash joins
+    filter_pushdown = true;
+    // Only the columns read by the query are bound in the accessor
+    projection_pushdown = true;
     to_string = MSOLAPToString;
+    dynamic_to_string = MSOLAPDynamicToString;
 }
 
 } // namespace duckdb
\ No newline at end of file
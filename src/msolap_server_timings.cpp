@@ -0,0 +1,287 @@
+#include "msolap_server_timings.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace duckdb {
+
+static std::string MSOLAPTraceNormalizeName(const std::string &name) {
+    std::string result;
+    for (char c : name) {
+        if (!std::isspace((unsigned char)c)) {
+            result += (char)std::tolower((unsigned char)c);
+        }
+    }
+    return result;
+}
+
+static int64_t MSOLAPTraceParseInteger(const std::string &value) {
+    // Durations may come as "12", "12.0" or empty
+    return (int64_t)std::strtod(value.c_str(), nullptr);
+}
+
+MSOLAPTraceEventClass MSOLAPTraceParser::ParseEventClass(const std::string &value) {
+    auto name = MSOLAPTraceNormalizeName(value);
+    if (name == "10" || name == "queryend") {
+        return MSOLAPTraceEventClass::QUERY_END;
+    }
+    if (name == "83" || name == "vertipaqsequeryend") {
+        return MSOLAPTraceEventClass::VERTIPAQ_SE_QUERY_END;
+    }
+    if (name == "85" || name == "vertipaqsequerycachematch") {
+        return MSOLAPTraceEventClass::VERTIPAQ_SE_QUERY_CACHE_MATCH;
+    }
+    return MSOLAPTraceEventClass::OTHER;
+}
+
+static bool MSOLAPTraceDigits(const std::string &value, size_t pos, size_t count, int &result) {
+    if (pos + count > value.size()) {
+        return false;
+    }
+    result = 0;
+    for (size_t i = pos; i < pos + count; i++) {
+        if (!std::isdigit((unsigned char)value[i])) {
+            return false;
+        }
+        result = result * 10 + (value[i] - '0');
+    }
+    return true;
+}
+
+int64_t MSOLAPTraceParser::ParseTimestamp(const std::string &value) {
+    int year, month, day, hour, minute, second;
+    if (!MSOLAPTraceDigits(value, 0, 4, year) || value.size() < 19 || value[4] != '-' ||
+        !MSOLAPTraceDigits(value, 5, 2, month) || value[7] != '-' || !MSOLAPTraceDigits(value, 8, 2, day) ||
+        (value[10] != 'T' && value[10] != ' ') || !MSOLAPTraceDigits(value, 11, 2, hour) || value[13] != ':' ||
+        !MSOLAPTraceDigits(value, 14, 2, minute) || value[16] != ':' || !MSOLAPTraceDigits(value, 17, 2, second)) {
+        return -1;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        return -1;
+    }
+    // Fraction of a second, more digits than milliseconds are cut off
+    int64_t millis = 0;
+    if (value.size() > 20 && value[19] == '.') {
+        int64_t scale = 100;
+        for (size_t i = 20; i < value.size() && std::isdigit((unsigned char)value[i]); i++) {
+            millis += (value[i] - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    // Days since 1970-01-01 of the proleptic Gregorian calendar
+    int64_t y = year - (month <= 2 ? 1 : 0);
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t year_of_era = y - era * 400;
+    int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    int64_t days = era * 146097 + day_of_era - 719468;
+    return ((days * 24 + hour) * 60 + minute) * 60000 + second * 1000 + millis;
+}
+
+MSOLAPTraceEvent MSOLAPTraceParser::FromColumns(const std::vector<std::pair<std::string, std::string>> &columns) {
+    MSOLAPTraceEvent event;
+    for (auto &column : columns) {
+        auto name = MSOLAPTraceNormalizeName(column.first);
+        auto &value = column.second;
+        if (name == "eventclass") {
+            event.event_class = ParseEventClass(value);
+        } else if (name == "eventsubclass") {
+            event.subclass = MSOLAPTraceParseInteger(value);
+        } else if (name == "starttime") {
+            event.start_ms = ParseTimestamp(value);
+        } else if (name == "duration") {
+            event.duration_ms = MSOLAPTraceParseInteger(value);
+        } else if (name == "cputime") {
+            event.cpu_ms = MSOLAPTraceParseInteger(value);
+        } else if (name == "textdata") {
+            event.text = value;
+        } else if (name == "requestid") {
+            event.request_id = value;
+        }
+    }
+    return event;
+}
+
+static std::string MSOLAPTraceDecodeXml(const std::string &text) {
+    std::string result;
+    result.reserve(text.size());
+    for (size_t pos = 0; pos < text.size(); pos++) {
+        if (text[pos] != '&') {
+            result += text[pos];
+            continue;
+        }
+        auto end = text.find(';', pos);
+        if (end == std::string::npos) {
+            result += text[pos];
+            continue;
+        }
+        auto entity = text.substr(pos + 1, end - pos - 1);
+        if (entity == "lt") {
+            result += '<';
+        } else if (entity == "gt") {
+            result += '>';
+        } else if (entity == "amp") {
+            result += '&';
+        } else if (entity == "quot") {
+            result += '"';
+        } else if (entity == "apos") {
+            result += '\'';
+        } else if (entity.size() > 1 && entity[0] == '#') {
+            unsigned long code = entity[1] == 'x' || entity[1] == 'X' ? std::strtoul(entity.c_str() + 2, nullptr, 16)
+                                                                       : std::strtoul(entity.c_str() + 1, nullptr, 10);
+            // UTF-8 encoding of the code point
+            if (code < 0x80) {
+                result += (char)code;
+            } else if (code < 0x800) {
+                result += (char)(0xC0 | (code >> 6));
+                result += (char)(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                result += (char)(0xE0 | (code >> 12));
+                result += (char)(0x80 | ((code >> 6) & 0x3F));
+                result += (char)(0x80 | (code & 0x3F));
+            } else {
+                result += (char)(0xF0 | (code >> 18));
+                result += (char)(0x80 | ((code >> 12) & 0x3F));
+                result += (char)(0x80 | ((code >> 6) & 0x3F));
+                result += (char)(0x80 | (code & 0x3F));
+            }
+        } else {
+            // Unknown entity, keep it as written
+            result += text.substr(pos, end - pos + 1);
+        }
+        pos = end;
+    }
+    return result;
+}
+
+static bool MSOLAPTraceIsNameEnd(char c) {
+    return c == '>' || c == '/' || std::isspace((unsigned char)c);
+}
+
+std::vector<MSOLAPTraceEvent> MSOLAPTraceParser::ParseRowsetXml(const std::string &xml) {
+    std::vector<MSOLAPTraceEvent> events;
+    size_t pos = 0;
+    while ((pos = xml.find("<row", pos)) != std::string::npos) {
+        if (pos + 4 >= xml.size() || !MSOLAPTraceIsNameEnd(xml[pos + 4])) {
+            pos += 4;
+            continue;
+        }
+        auto tag_end = xml.find('>', pos);
+        if (tag_end == std::string::npos) {
+            break;
+        }
+        pos = tag_end + 1;
+        if (xml[tag_end - 1] == '/') {
+            // <row/> without columns
+            continue;
+        }
+
+        // Child elements up to </row>
+        std::vector<std::pair<std::string, std::string>> columns;
+        while (true) {
+            auto open = xml.find('<', pos);
+            if (open == std::string::npos || xml.compare(open, 2, "</") == 0) {
+                auto row_end = open == std::string::npos ? std::string::npos : xml.find('>', open);
+                pos = row_end == std::string::npos ? xml.size() : row_end + 1;
+                break;
+            }
+            size_t name_end = open + 1;
+            while (name_end < xml.size() && !MSOLAPTraceIsNameEnd(xml[name_end])) {
+                name_end++;
+            }
+            auto name = xml.substr(open + 1, name_end - open - 1);
+            auto element_end = xml.find('>', name_end);
+            if (element_end == std::string::npos) {
+                pos = xml.size();
+                break;
+            }
+            // Column names never need a namespace prefix
+            auto local_name = name.substr(name.find(':') == std::string::npos ? 0 : name.find(':') + 1);
+            if (xml[element_end - 1] == '/') {
+                columns.emplace_back(local_name, std::string());
+                pos = element_end + 1;
+                continue;
+            }
+            auto close = xml.find("</" + name, element_end);
+            if (close == std::string::npos) {
+                pos = xml.size();
+                break;
+            }
+            columns.emplace_back(local_name, MSOLAPTraceDecodeXml(xml.substr(element_end + 1, close - element_end - 1)));
+            auto close_end = xml.find('>', close);
+            pos = close_end == std::string::npos ? xml.size() : close_end + 1;
+        }
+        events.push_back(FromColumns(columns));
+    }
+    return events;
+}
+
+MSOLAPServerTimings MSOLAPServerTimings::Compute(const std::vector<MSOLAPTraceEvent> &events,
+                                                 const std::string &marker) {
+    MSOLAPServerTimings result;
+    const MSOLAPTraceEvent *query_end = nullptr;
+    for (auto &event : events) {
+        if (event.event_class == MSOLAPTraceEventClass::QUERY_END &&
+            (marker.empty() || event.text.find(marker) != std::string::npos)) {
+            query_end = &event;
+            break;
+        }
+    }
+    if (!query_end) {
+        result.error = "the trace delivered no QueryEnd event for the query";
+        return result;
+    }
+    result.captured = true;
+    result.total_ms = (double)query_end->duration_ms;
+
+    auto query_start = query_end->start_ms;
+    auto query_finish = query_end->start_ms + query_end->duration_ms;
+    auto belongs = [&](const MSOLAPTraceEvent &event) {
+        if (!query_end->request_id.empty() && !event.request_id.empty()) {
+            return event.request_id == query_end->request_id;
+        }
+        if (query_start >= 0 && event.start_ms >= 0) {
+            return event.start_ms >= query_start && event.start_ms <= query_finish;
+        }
+        return true;
+    };
+
+    // Scans run in parallel, so their wall-clock time is the union of their intervals
+    std::vector<std::pair<int64_t, int64_t>> intervals;
+    double untimed_ms = 0;
+    for (auto &event : events) {
+        if (event.subclass == MSOLAP_TRACE_SUBCLASS_INTERNAL || !belongs(event)) {
+            continue;
+        }
+        if (event.event_class == MSOLAPTraceEventClass::VERTIPAQ_SE_QUERY_END) {
+            result.se_queries++;
+            result.se_cpu_ms += (double)event.cpu_ms;
+            if (event.start_ms >= 0) {
+                intervals.emplace_back(event.start_ms, event.start_ms + event.duration_ms);
+            } else {
+                untimed_ms += (double)event.duration_ms;
+            }
+        } else if (event.event_class == MSOLAPTraceEventClass::VERTIPAQ_SE_QUERY_CACHE_MATCH) {
+            result.se_cache_hits++;
+        }
+    }
+    std::sort(intervals.begin(), intervals.end());
+    int64_t covered = 0;
+    int64_t covered_until = INT64_MIN;
+    for (auto &interval : intervals) {
+        auto begin = std::max(interval.first, covered_until);
+        if (interval.second > begin) {
+            covered += interval.second - begin;
+        }
+        covered_until = std::max(covered_until, interval.second);
+    }
+    result.se_ms = (double)covered + untimed_ms;
+    if (result.se_ms > result.total_ms) {
+        result.se_ms = result.total_ms;
+    }
+    result.fe_ms = result.total_ms - result.se_ms;
+    return result;
+}
+
+} // namespace duckdb
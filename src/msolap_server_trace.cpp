@@ -0,0 +1,252 @@
+#include "msolap_server_trace.hpp"
+#include "msolap_utils.hpp"
+#include <atomic>
+#include <stdexcept>
+
+namespace duckdb {
+
+static const char *MSOLAP_XMLA_ENGINE_NAMESPACE = "http://schemas.microsoft.com/analysisservices/2003/engine";
+
+// Trace columns: EventClass, EventSubclass, StartTime, Duration, CPUTime, TextData, RequestID
+static constexpr int MSOLAP_TRACE_COLUMN_REQUEST_ID = 47;
+
+static string MSOLAPTraceEventXml(int event_id, const vector<int> &columns, bool request_ids) {
+    string xml = "<Event><EventID>" + std::to_string(event_id) + "</EventID><Columns>";
+    for (auto column : columns) {
+        xml += "<ColumnID>" + std::to_string(column) + "</ColumnID>";
+    }
+    if (request_ids) {
+        xml += "<ColumnID>" + std::to_string(MSOLAP_TRACE_COLUMN_REQUEST_ID) + "</ColumnID>";
+    }
+    return xml + "</Columns></Event>";
+}
+
+MSOLAPServerTrace::MSOLAPServerTrace()
+    : created(false), subscribed(false), ended(false), query_end_seen(false), subscription(nullptr),
+      finished(false) {
+    // Unique per process and trace; the server holds traces of all clients
+    static std::atomic<idx_t> next_trace(0);
+    trace_id = "msolap_" + std::to_string(GetCurrentProcessId()) + "_" + std::to_string(next_trace.fetch_add(1)) +
+               "_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+    tag = "msolap trace " + trace_id;
+}
+
+MSOLAPServerTrace::~MSOLAPServerTrace() {
+    try {
+        Finish(0);
+    } catch (...) {
+    }
+}
+
+string MSOLAPServerTrace::Marker() const {
+    return "// " + tag + "\n";
+}
+
+void MSOLAPServerTrace::Create(bool request_ids) {
+    string xml = string("<Create xmlns=\"") + MSOLAP_XMLA_ENGINE_NAMESPACE + "\"><ObjectDefinition><Trace>" +
+                 "<ID>" + trace_id + "</ID><Name>" + trace_id + "</Name><Events>" +
+                 MSOLAPTraceEventXml(10, {0, 1, 3, 5, 6, 42}, request_ids) +
+                 MSOLAPTraceEventXml(83, {0, 1, 3, 5, 6, 42}, request_ids) +
+                 MSOLAPTraceEventXml(85, {0, 1, 42}, request_ids) + "</Events></Trace></ObjectDefinition></Create>";
+    ICommand* command = control.CreateCommand(xml);
+    try {
+        IRowset* result = control.ExecuteCommand(command);
+        MSOLAPUtils::SafeRelease(&result);
+    } catch (...) {
+        MSOLAPUtils::SafeRelease(&command);
+        throw;
+    }
+    MSOLAPUtils::SafeRelease(&command);
+}
+
+void MSOLAPServerTrace::Start(const string &connection_string) {
+    control = MSOLAPConnection::Connect(connection_string);
+    try {
+        Create(true);
+    } catch (std::exception &) {
+        // Servers before RequestID was added; events are then matched by time
+        Create(false);
+    }
+    created = true;
+
+    thread = std::thread([this, connection_string]() { Run(connection_string); });
+
+    // Execute of the Subscribe command normally returns as soon as the server
+    // registered it. If it doesn't the query goes ahead anyway: the request is on
+    // its way and at worst the first events are missed.
+    std::unique_lock<std::mutex> guard(lock);
+    cv.wait_for(guard, std::chrono::milliseconds(MSOLAP_TRACE_SUBSCRIBE_TIMEOUT_MS),
+                [&]() { return subscribed || ended; });
+    if (ended && !subscribed) {
+        throw std::runtime_error("Failed to subscribe to the server trace: " + error);
+    }
+}
+
+void MSOLAPServerTrace::Run(const string &connection_string) {
+    MSOLAPConnection::InitializeCOM();
+
+    MSOLAPConnection connection;
+    ICommand* command = nullptr;
+    IRowset* rowset = nullptr;
+    IAccessor* accessor = nullptr;
+    HACCESSOR haccessor = NULL;
+    vector<DBBINDING> bindings;
+    string failure;
+    try {
+        connection = MSOLAPConnection::Connect(connection_string);
+        command = connection.CreateCommand(string("<Subscribe xmlns=\"") + MSOLAP_XMLA_ENGINE_NAMESPACE +
+                                           "\"><Object><TraceID>" + trace_id + "</TraceID></Object></Subscribe>");
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            subscription = command;
+        }
+        rowset = connection.ExecuteCommand(command);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            subscribed = true;
+        }
+        cv.notify_all();
+
+        vector<string> names;
+        vector<LogicalType> types;
+        vector<string> columns;
+        if (!connection.GetColumnInfo(rowset, names, types, &columns)) {
+            throw std::runtime_error("Failed to get the columns of the trace");
+        }
+        HRESULT hr = rowset->QueryInterface(IID_IAccessor, (void**)&accessor);
+        if (FAILED(hr)) {
+            throw std::runtime_error("Failed to get IAccessor: " + MSOLAPUtils::GetErrorMessage(hr));
+        }
+        // Every column as a VARIANT, in the same layout the rowset reader uses
+        bindings.resize(columns.size());
+        for (idx_t i = 0; i < columns.size(); i++) {
+            auto &binding = bindings[i];
+            ZeroMemory(&binding, sizeof(DBBINDING));
+            binding.iOrdinal = i + 1;
+            binding.obValue = i * sizeof(ColumnData) + offsetof(ColumnData, var);
+            binding.obLength = i * sizeof(ColumnData) + offsetof(ColumnData, dwLength);
+            binding.obStatus = i * sizeof(ColumnData) + offsetof(ColumnData, dwStatus);
+            binding.cbMaxLen = sizeof(VARIANT);
+            binding.eParamIO = DBPARAMIO_NOTPARAM;
+            binding.dwPart = DBPART_VALUE | DBPART_LENGTH | DBPART_STATUS;
+            binding.dwMemOwner = DBMEMOWNER_CLIENTOWNED;
+            binding.wType = DBTYPE_VARIANT;
+        }
+        hr = accessor->CreateAccessor(DBACCESSOR_ROWDATA, bindings.size(), bindings.data(),
+                                      columns.size() * sizeof(ColumnData), &haccessor, NULL);
+        if (FAILED(hr)) {
+            throw std::runtime_error("Failed to create accessor: " + MSOLAPUtils::GetErrorMessage(hr));
+        }
+
+        // GetNextRows blocks until events arrive and fails or ends once the trace is deleted
+        vector<ColumnData> row(columns.size());
+        HROW handles[16];
+        while (true) {
+            DBCOUNTITEM obtained = 0;
+            HROW* pRows = handles;
+            hr = rowset->GetNextRows(0, 0, 16, &obtained, &pRows);
+            if (FAILED(hr) || obtained == 0) {
+                break;
+            }
+            vector<MSOLAPTraceEvent> received;
+            for (DBCOUNTITEM r = 0; r < obtained; r++) {
+                memset(row.data(), 0, row.size() * sizeof(ColumnData));
+                if (FAILED(rowset->GetData(handles[r], haccessor, row.data()))) {
+                    continue;
+                }
+                vector<std::pair<string, string>> values;
+                for (idx_t i = 0; i < columns.size(); i++) {
+                    string value;
+                    if (row[i].dwStatus == DBSTATUS_S_OK) {
+                        auto converted = MSOLAPUtils::ConvertVariantToValue(&row[i].var);
+                        value = converted.IsNull() ? string() : converted.ToString();
+                    }
+                    values.emplace_back(columns[i], value);
+                    VariantClear(&row[i].var);
+                }
+                received.push_back(MSOLAPTraceParser::FromColumns(values));
+            }
+            rowset->ReleaseRows(obtained, handles, NULL, NULL, NULL);
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                for (auto &event : received) {
+                    query_end_seen = query_end_seen || (event.event_class == MSOLAPTraceEventClass::QUERY_END &&
+                                                        event.text.find(tag) != string::npos);
+                    events.push_back(std::move(event));
+                }
+            }
+            cv.notify_all();
+            if (hr == DB_S_ENDOFROWSET) {
+                break;
+            }
+        }
+    } catch (std::exception &e) {
+        failure = e.what();
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        subscription = nullptr;
+        error = failure;
+        ended = true;
+    }
+    cv.notify_all();
+    if (accessor && haccessor) {
+        accessor->ReleaseAccessor(haccessor, NULL);
+    }
+    MSOLAPUtils::SafeRelease(&accessor);
+    MSOLAPUtils::SafeRelease(&rowset);
+    MSOLAPUtils::SafeRelease(&command);
+    connection.Close();
+}
+
+void MSOLAPServerTrace::Delete() {
+    if (created) {
+        created = false;
+        try {
+            ICommand* command = control.CreateCommand(string("<Delete xmlns=\"") + MSOLAP_XMLA_ENGINE_NAMESPACE +
+                                                      "\"><Object><TraceID>" + trace_id +
+                                                      "</TraceID></Object></Delete>");
+            IRowset* result = nullptr;
+            try {
+                result = control.ExecuteCommand(command);
+            } catch (...) {
+            }
+            MSOLAPUtils::SafeRelease(&result);
+            MSOLAPUtils::SafeRelease(&command);
+        } catch (...) {
+            // The server drops the trace with the session anyway
+        }
+    }
+    control.Close();
+
+    // A subscription the delete didn't end is cancelled
+    std::lock_guard<std::mutex> guard(lock);
+    if (subscription) {
+        subscription->Cancel();
+    }
+}
+
+MSOLAPServerTimings MSOLAPServerTrace::Finish(idx_t timeout_ms) {
+    if (finished) {
+        return timings;
+    }
+    finished = true;
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        cv.wait_for(guard, std::chrono::milliseconds(timeout_ms), [&]() { return ended || query_end_seen; });
+    }
+    MSOLAPConnection::WorkerPool().Run([&]() { Delete(); });
+    if (thread.joinable()) {
+        thread.join();
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    timings = MSOLAPServerTimings::Compute(events, tag);
+    if (!timings.captured && !error.empty()) {
+        timings.error = error;
+    }
+    return timings;
+}
+
+} // namespace duckdb
@@ -0,0 +1,78 @@
+#include "msolap_session.hpp"
+#include "msolap_utils.hpp"
+#include <stdexcept>
+
+namespace duckdb {
+
+MSOLAPSession::MSOLAPSession(MSOLAPConnection connection_p) : connection(std::move(connection_p)) {
+}
+
+MSOLAPSession::~MSOLAPSession() {
+    for (auto &entry : prepared_commands) {
+        MSOLAPUtils::SafeRelease(&entry.second);
+    }
+    prepared_commands.clear();
+    connection.Close();
+}
+
+ICommand* MSOLAPSession::GetPreparedCommand(const string &dax_query, bool &reused) {
+    auto entry = prepared_commands.find(dax_query);
+    if (entry != prepared_commands.end()) {
+        // Already parsed and prepared on the server, only the parameter values change
+        ICommand* command = entry->second;
+        prepared_commands.erase(entry);
+        reused = true;
+        return command;
+    }
+
+    reused = false;
+    return connection.PrepareCommand(dax_query);
+}
+
+void MSOLAPSession::ReturnPreparedCommand(const string &dax_query, ICommand *command) {
+    if (prepared_commands.size() >= MSOLAP_PREPARED_COMMAND_CACHE_SIZE ||
+        prepared_commands.find(dax_query) != prepared_commands.end()) {
+        MSOLAPUtils::SafeRelease(&command);
+        return;
+    }
+    prepared_commands[dax_query] = command;
+}
+
+MSOLAPSessionCache::~MSOLAPSessionCache() {
+    // The sessions were created on the worker pool's apartment, release them there
+    try {
+        MSOLAPConnection::WorkerPool().Run([&]() { idle_sessions.clear(); });
+    } catch (...) {
+    }
+}
+
+MSOLAPSessionCache &MSOLAPSessionCache::Get(ClientContext &context) {
+    return *context.registered_state->GetOrCreate<MSOLAPSessionCache>("msolap_session_cache");
+}
+
+unique_ptr<MSOLAPSession> MSOLAPSessionCache::Acquire(const string &connection_string, bool &reused) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto &sessions = idle_sessions[connection_string];
+        if (!sessions.empty()) {
+            auto session = std::move(sessions.back());
+            sessions.pop_back();
+            reused = true;
+            return session;
+        }
+    }
+
+    // Connect outside the lock, other scans may use other idle sessions meanwhile
+    reused = false;
+    return make_uniq<MSOLAPSession>(MSOLAPConnection::Connect(connection_string));
+}
+
+void MSOLAPSessionCache::Release(const string &connection_string, unique_ptr<MSOLAPSession> session) {
+    if (!session || !session->connection.IsOpen()) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    idle_sessions[connection_string].push_back(std::move(session));
+}
+
+} // namespace duckdb
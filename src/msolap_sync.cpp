@@ -0,0 +1,297 @@
+#include "msolap_sync.hpp"
+#include "msolap_dax.hpp"
+#include "msolap_rowset_reader.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+#include "duckdb/main/appender.hpp"
+#include "duckdb/main/connection.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/parser/qualified_name.hpp"
+#include <chrono>
+#include <stdexcept>
+
+namespace duckdb {
+
+struct MSOLAPSyncResult {
+    Value watermark_from;
+    Value watermark_to;
+    idx_t rows_deleted = 0;
+    idx_t rows_inserted = 0;
+};
+
+struct MSOLAPSyncGlobalState : public GlobalTableFunctionState {
+    bool finished = false;
+};
+
+// Run a statement on the sync connection, throwing its error
+static unique_ptr<QueryResult> MSOLAPSyncQuery(Connection &con, const string &sql,
+                                               vector<Value> parameters = vector<Value>()) {
+    unique_ptr<QueryResult> result;
+    if (parameters.empty()) {
+        result = con.Query(sql);
+    } else {
+        auto statement = con.Prepare(sql);
+        if (statement->HasError()) {
+            throw std::runtime_error(statement->GetError());
+        }
+        result = statement->Execute(parameters, false);
+    }
+    if (result->HasError()) {
+        throw std::runtime_error(result->GetError());
+    }
+    return result;
+}
+
+static Value MSOLAPSyncScalar(Connection &con, const string &sql, vector<Value> parameters = vector<Value>()) {
+    auto result = MSOLAPSyncQuery(con, sql, std::move(parameters));
+    auto chunk = result->Fetch();
+    if (!chunk || chunk->size() == 0) {
+        return Value();
+    }
+    return chunk->GetValue(0, 0);
+}
+
+// Lower bound of the rows to pull: the high watermark minus the lookback
+static Value MSOLAPSyncLowerBound(const Value &high, int64_t lookback) {
+    if (high.IsNull()) {
+        return high;
+    }
+    switch (high.type().id()) {
+    case LogicalTypeId::DATE:
+        return Value::DATE(date_t(high.GetValue<date_t>().days - lookback));
+    case LogicalTypeId::TIMESTAMP: {
+        // DAX datetime literals have second precision; round down so the DAX filter
+        // and the local delete agree on the boundary
+        auto micros = high.GetValue<timestamp_t>().value - lookback * Interval::MICROS_PER_DAY;
+        micros -= ((micros % Interval::MICROS_PER_SEC) + Interval::MICROS_PER_SEC) % Interval::MICROS_PER_SEC;
+        return Value::TIMESTAMP(timestamp_t(micros));
+    }
+    case LogicalTypeId::TINYINT:
+    case LogicalTypeId::SMALLINT:
+    case LogicalTypeId::INTEGER:
+    case LogicalTypeId::BIGINT:
+        return Value::BIGINT(high.GetValue<int64_t>() - lookback);
+    case LogicalTypeId::FLOAT:
+    case LogicalTypeId::DOUBLE:
+    case LogicalTypeId::DECIMAL:
+        return Value::DOUBLE(high.GetValue<double>() - lookback);
+    default:
+        if (lookback != 0) {
+            throw std::runtime_error("msolap_sync: lookback requires a numeric, date or timestamp watermark, not " +
+                                     high.type().ToString());
+        }
+        return high;
+    }
+}
+
+static MSOLAPSyncResult MSOLAPSyncRun(ClientContext &context, Connection &con, const MSOLAPSyncBindData &bind_data) {
+    MSOLAPSyncResult result;
+
+    // Schema of the model table and the position of the watermark column in it
+    string table_expression = MSOLAPDax::TableReference(bind_data.table);
+    vector<string> names, references;
+    vector<LogicalType> types;
+    MSOLAPRowsetReader::DescribeTable(context, bind_data.connection_string, table_expression, names, types,
+                                      &references);
+    string watermark_reference = MSOLAPDax::ColumnReference(bind_data.watermark);
+    idx_t watermark_index = DConstants::INVALID_INDEX;
+    for (idx_t i = 0; i < references.size(); i++) {
+        if (StringUtil::CIEquals(MSOLAPDax::ColumnReference(references[i]), watermark_reference)) {
+            watermark_index = i;
+        }
+    }
+    if (watermark_index == DConstants::INVALID_INDEX) {
+        throw std::runtime_error("msolap_sync: watermark " + bind_data.watermark + " is not a column of " +
+                                 bind_data.table);
+    }
+
+    auto qualified_name = QualifiedName::Parse(bind_data.target);
+    string schema = qualified_name.schema.empty() ? DEFAULT_SCHEMA : qualified_name.schema;
+    string target = KeywordHelper::WriteOptionallyQuoted(schema) + "." +
+                    KeywordHelper::WriteOptionallyQuoted(qualified_name.name);
+    if (!qualified_name.catalog.empty()) {
+        target = KeywordHelper::WriteOptionallyQuoted(qualified_name.catalog) + "." + target;
+    }
+
+    // First run: create the target with the model table's columns
+    vector<string> column_definitions;
+    for (idx_t i = 0; i < names.size(); i++) {
+        column_definitions.push_back(KeywordHelper::WriteOptionallyQuoted(names[i]) + " " + types[i].ToString());
+    }
+    MSOLAPSyncQuery(con, "CREATE TABLE IF NOT EXISTS " + target + " (" + StringUtil::Join(column_definitions, ", ") +
+                             ")");
+    auto target_types = MSOLAPSyncQuery(con, "SELECT * FROM " + target + " LIMIT 0")->types;
+    if (target_types.size() != types.size()) {
+        throw std::runtime_error("msolap_sync: " + bind_data.target + " has " + to_string(target_types.size()) +
+                                 " columns, " + bind_data.table + " has " + to_string(types.size()));
+    }
+    auto &watermark_type = target_types[watermark_index];
+    string watermark_column = KeywordHelper::WriteOptionallyQuoted(names[watermark_index]);
+
+    // Continue from the last successful run, or from the data already in the target.
+    // An empty (or recreated) target always gets a full load.
+    Value high = MSOLAPSyncScalar(con, "SELECT max(" + watermark_column + ") FROM " + target);
+    if (!high.IsNull()) {
+        Value remembered = MSOLAPSyncScalar(
+            con,
+            "SELECT watermark_to FROM " + string(MSOLAP_SYNC_LOG_TABLE) +
+                " WHERE target = $1 AND status = 'success' ORDER BY started_at DESC LIMIT 1",
+            {Value(bind_data.target)});
+        if (!remembered.IsNull()) {
+            high = remembered;
+        }
+        high = high.DefaultCastAs(watermark_type);
+    }
+    Value low = MSOLAPSyncLowerBound(high, bind_data.lookback);
+    result.watermark_from = low;
+
+    string dax_query = "EVALUATE " + table_expression;
+    if (!low.IsNull()) {
+        dax_query = "EVALUATE CALCULATETABLE(" + table_expression + ", " + watermark_reference + " > " +
+                    MSOLAPDax::ToLiteral(low) + ")";
+        // Rows inside the lookback window are replaced by their current version
+        auto deleted = MSOLAPSyncScalar(con, "DELETE FROM " + target + " WHERE " + watermark_column + " > $1",
+                                        {low.DefaultCastAs(watermark_type)});
+        result.rows_deleted = deleted.IsNull() ? 0 : deleted.GetValue<idx_t>();
+    }
+
+    // Stream the new rows straight into the target
+    MSOLAPRowsetReader reader;
+    reader.Open(context, bind_data.connection_string, dax_query);
+    auto appender = qualified_name.catalog.empty()
+                        ? make_uniq<Appender>(con, schema, qualified_name.name)
+                        : make_uniq<Appender>(con, qualified_name.catalog, schema, qualified_name.name);
+    DataChunk chunk, cast_chunk;
+    chunk.Initialize(Allocator::DefaultAllocator(), types);
+    cast_chunk.Initialize(Allocator::DefaultAllocator(), target_types);
+    while (true) {
+        chunk.Reset();
+        idx_t count = reader.Read(chunk);
+        if (count == 0) {
+            break;
+        }
+        chunk.SetCardinality(count);
+        if (types == target_types) {
+            appender->AppendDataChunk(chunk);
+        } else {
+            cast_chunk.Reset();
+            for (idx_t col = 0; col < types.size(); col++) {
+                VectorOperations::Cast(context, chunk.data[col], cast_chunk.data[col], count);
+            }
+            cast_chunk.SetCardinality(count);
+            appender->AppendDataChunk(cast_chunk);
+        }
+        result.rows_inserted += count;
+    }
+    appender->Close();
+    reader.Close();
+
+    result.watermark_to = MSOLAPSyncScalar(con, "SELECT max(" + watermark_column + ") FROM " + target);
+    return result;
+}
+
+static Value MSOLAPSyncWatermarkString(const Value &watermark) {
+    return watermark.IsNull() ? Value() : Value(watermark.ToString());
+}
+
+static void MSOLAPSyncLog(Connection &con, const MSOLAPSyncBindData &bind_data, timestamp_t started_at,
+                          double duration_ms, const MSOLAPSyncResult &result, const string &status,
+                          const string &error) {
+    MSOLAPSyncQuery(con, "INSERT INTO " + string(MSOLAP_SYNC_LOG_TABLE) +
+                             " VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11)",
+                    {Value(bind_data.target), Value(bind_data.table), Value(bind_data.watermark),
+                     Value::TIMESTAMP(started_at), Value::DOUBLE(duration_ms), Value::UBIGINT(result.rows_deleted),
+                     Value::UBIGINT(result.rows_inserted), MSOLAPSyncWatermarkString(result.watermark_from),
+                     MSOLAPSyncWatermarkString(result.watermark_to), Value(status),
+                     error.empty() ? Value() : Value(error)});
+}
+
+static unique_ptr<FunctionData> MSOLAPSyncBind(ClientContext &context, TableFunctionBindInput &input,
+                                               vector<LogicalType> &return_types, vector<string> &names) {
+    auto result = make_uniq<MSOLAPSyncBindData>();
+    result->connection_string = input.inputs[0].GetValue<string>();
+    result->table = input.inputs[1].GetValue<string>();
+    for (auto &kv : input.named_parameters) {
+        if (kv.first == "target") {
+            result->target = kv.second.GetValue<string>();
+        } else if (kv.first == "watermark") {
+            result->watermark = kv.second.GetValue<string>();
+        } else if (kv.first == "lookback") {
+            result->lookback = kv.second.GetValue<int64_t>();
+        }
+    }
+    if (result->target.empty() || result->watermark.empty()) {
+        throw std::runtime_error("msolap_sync requires target := and watermark :=");
+    }
+    if (result->lookback < 0) {
+        throw std::runtime_error("msolap_sync: lookback must not be negative");
+    }
+
+    names = {"target", "watermark_from", "watermark_to", "rows_deleted", "rows_inserted", "duration_ms"};
+    return_types = {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::VARCHAR,
+                    LogicalType::UBIGINT, LogicalType::UBIGINT, LogicalType::DOUBLE};
+    return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> MSOLAPSyncInit(ClientContext &context, TableFunctionInitInput &input) {
+    return make_uniq<MSOLAPSyncGlobalState>();
+}
+
+static void MSOLAPSyncScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+    auto &bind_data = data.bind_data->Cast<MSOLAPSyncBindData>();
+    auto &state = data.global_state->Cast<MSOLAPSyncGlobalState>();
+    if (state.finished) {
+        return;
+    }
+    state.finished = true;
+
+    // The load runs in a transaction of its own connection, the calling query
+    // can't write to the database while it is executing
+    Connection con(*context.db);
+    MSOLAPSyncQuery(con, "CREATE TABLE IF NOT EXISTS " + string(MSOLAP_SYNC_LOG_TABLE) +
+                             " (target VARCHAR, source_table VARCHAR, watermark_column VARCHAR, "
+                             "started_at TIMESTAMP, duration_ms DOUBLE, rows_deleted UBIGINT, rows_inserted UBIGINT, "
+                             "watermark_from VARCHAR, watermark_to VARCHAR, status VARCHAR, error VARCHAR)");
+
+    auto started_at = Timestamp::GetCurrentTimestamp();
+    auto start = std::chrono::steady_clock::now();
+    MSOLAPSyncResult result;
+    MSOLAPSyncQuery(con, "BEGIN TRANSACTION");
+    try {
+        result = MSOLAPSyncRun(context, con, bind_data);
+        double duration_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        MSOLAPSyncLog(con, bind_data, started_at, duration_ms, result, "success", "");
+        MSOLAPSyncQuery(con, "COMMIT");
+    } catch (std::exception &e) {
+        // Nothing of a failed run is kept, but the failure is logged
+        string error = e.what();
+        con.Query("ROLLBACK");
+        double duration_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        try {
+            MSOLAPSyncLog(con, bind_data, started_at, duration_ms, MSOLAPSyncResult(), "failed", error);
+        } catch (...) {
+        }
+        throw;
+    }
+
+    double duration_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    output.SetValue(0, 0, Value(bind_data.target));
+    output.SetValue(1, 0, MSOLAPSyncWatermarkString(result.watermark_from));
+    output.SetValue(2, 0, MSOLAPSyncWatermarkString(result.watermark_to));
+    output.SetValue(3, 0, Value::UBIGINT(result.rows_deleted));
+    output.SetValue(4, 0, Value::UBIGINT(result.rows_inserted));
+    output.SetValue(5, 0, Value::DOUBLE(duration_ms));
+    output.SetCardinality(1);
+}
+
+MSOLAPSyncFunction::MSOLAPSyncFunction()
+    : TableFunction("msolap_sync", {LogicalType::VARCHAR, LogicalType::VARCHAR}, MSOLAPSyncScan, MSOLAPSyncBind,
+                    MSOLAPSyncInit) {
+    named_parameters["target"] = LogicalType::VARCHAR;
+    named_parameters["watermark"] = LogicalType::VARCHAR;
+    named_parameters["lookback"] = LogicalType::BIGINT;
+}
+
+} // namespace duckdb
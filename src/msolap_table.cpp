@@ -0,0 +1,325 @@
+#include "msolap_table.hpp"
+#include "msolap_dax.hpp"
+#include "msolap_filter_pushdown.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+#include <stdexcept>
+
+namespace duckdb {
+
+bool MSOLAPTableBindData::Partitionable() const {
+    return partition_column != DConstants::INVALID_INDEX &&
+           MSOLAPDax::IsTableName(MSOLAPDax::TableExpression(dax_query));
+}
+
+string MSOLAPTableBindData::BuildQuery(const vector<idx_t> &columns, const string &filtered_table) const {
+    vector<string> selected;
+    for (auto column : columns) {
+        selected.push_back(MSOLAPDax::QuoteString(names[column]) + ", " +
+                           MSOLAPDax::ColumnReference(column_references[column]));
+    }
+    return "EVALUATE SELECTCOLUMNS(" + filtered_table + ", " + StringUtil::Join(selected, ", ") + ")";
+}
+
+string MSOLAPTableBindData::PartitionFilter(idx_t index, idx_t count) const {
+    auto column = MSOLAPDax::ColumnReference(column_references[partition_column]);
+    // Ranges of equal width over [min, max], in unsigned arithmetic so the span of
+    // any two int64 values fits; the first and last ranges are open ended
+    uint64_t span = uint64_t(partition_max) - uint64_t(partition_min);
+    uint64_t width = span / count + 1;
+    auto low = std::to_string(int64_t(uint64_t(partition_min) + index * width));
+    auto high = std::to_string(int64_t(uint64_t(partition_min) + (index + 1) * width));
+    if (index == 0) {
+        return "ISBLANK(" + column + ") || " + column + " < " + high;
+    }
+    if (index + 1 == count) {
+        return "NOT ISBLANK(" + column + ") && " + column + " >= " + low;
+    }
+    return "NOT ISBLANK(" + column + ") && " + column + " >= " + low + " && " + column + " < " + high;
+}
+
+static bool MSOLAPTableIsIntegerKey(const LogicalType &type) {
+    switch (type.id()) {
+    case LogicalTypeId::TINYINT:
+    case LogicalTypeId::SMALLINT:
+    case LogicalTypeId::INTEGER:
+    case LogicalTypeId::BIGINT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// The column given as partition_column (by name or reference), else the first
+// integer column named like a key (...Key, ...ID), else the first integer column
+static idx_t MSOLAPTablePartitionColumn(const MSOLAPTableBindData &bind_data, const string &partition_column) {
+    auto &references = bind_data.column_references;
+    if (!partition_column.empty()) {
+        for (idx_t col = 0; col < references.size(); col++) {
+            if (!StringUtil::CIEquals(bind_data.names[col], partition_column) &&
+                !StringUtil::CIEquals(references[col], partition_column) &&
+                !StringUtil::CIEquals(MSOLAPDax::ColumnReference(references[col]), partition_column)) {
+                continue;
+            }
+            if (!MSOLAPTableIsIntegerKey(bind_data.types[col])) {
+                throw std::runtime_error("msolap_table: partition_column " + references[col] + " is " +
+                                         bind_data.types[col].ToString() + ", it has to be an integer column");
+            }
+            return col;
+        }
+        throw std::runtime_error("msolap_table: " + bind_data.table_name + " has no column \"" + partition_column +
+                                 "\"");
+    }
+    idx_t first_integer = DConstants::INVALID_INDEX;
+    for (idx_t col = 0; col < references.size(); col++) {
+        if (!MSOLAPTableIsIntegerKey(bind_data.types[col])) {
+            continue;
+        }
+        auto reference = StringUtil::Lower(references[col]);
+        if (StringUtil::EndsWith(reference, "key]") || StringUtil::EndsWith(reference, "id]")) {
+            return col;
+        }
+        if (first_integer == DConstants::INVALID_INDEX) {
+            first_integer = col;
+        }
+    }
+    return first_integer;
+}
+
+// Row count and the range of the partition column in one round trip
+static void MSOLAPTableStatistics(ClientContext &context, MSOLAPTableBindData &bind_data, const string &table) {
+    string query = "EVALUATE ROW(\"Rows\", COUNTROWS(" + table + ") + 0";
+    if (bind_data.partition_column != DConstants::INVALID_INDEX) {
+        auto column = MSOLAPDax::ColumnReference(bind_data.column_references[bind_data.partition_column]);
+        query += ", \"Min\", MIN(" + column + "), \"Max\", MAX(" + column + ")";
+    }
+    query += ")";
+
+    MSOLAPRowsetReader reader;
+    reader.Open(context, bind_data.connection_string, query);
+    reader.WaitOpen();
+    DataChunk chunk;
+    chunk.Initialize(Allocator::DefaultAllocator(), reader.types);
+    idx_t count = reader.Read(chunk);
+    reader.Close();
+    if (count == 0) {
+        throw std::runtime_error("msolap_table: no row count returned for " + table);
+    }
+    bind_data.cardinality = chunk.GetValue(0, 0).GetValue<idx_t>();
+    if (bind_data.partition_column == DConstants::INVALID_INDEX) {
+        return;
+    }
+    auto min = chunk.GetValue(1, 0);
+    auto max = chunk.GetValue(2, 0);
+    if (min.IsNull() || max.IsNull()) {
+        // Empty or all BLANK, nothing to split
+        bind_data.partition_column = DConstants::INVALID_INDEX;
+        return;
+    }
+    bind_data.partition_min = min.GetValue<int64_t>();
+    bind_data.partition_max = max.GetValue<int64_t>();
+}
+
+static unique_ptr<FunctionData> MSOLAPTableBind(ClientContext &context, TableFunctionBindInput &input,
+                                                vector<LogicalType> &return_types, vector<string> &names) {
+    auto result = make_uniq<MSOLAPTableBindData>();
+    if (input.inputs[0].IsNull() || input.inputs[1].IsNull()) {
+        throw std::runtime_error("msolap_table: conn and table must not be NULL");
+    }
+    result->connection_string = input.inputs[0].GetValue<string>();
+    result->table_name = input.inputs[1].GetValue<string>();
+
+    string partition_column;
+    for (auto &kv : input.named_parameters) {
+        if (kv.first == "partition_column") {
+            partition_column = kv.second.GetValue<string>();
+        } else if (kv.first == "max_threads") {
+            result->max_threads = kv.second.GetValue<idx_t>();
+            if (result->max_threads == 0) {
+                throw std::runtime_error("msolap_table: max_threads must be at least 1");
+            }
+        }
+    }
+
+    // The schema is the model's, described by an empty query over the table. The row
+    // count and key range need the schema, they take a second round trip.
+    auto table = MSOLAPDax::TableReference(result->table_name);
+    result->dax_query = "EVALUATE " + table;
+    MSOLAPRowsetReader::DescribeTable(context, result->connection_string, table, result->names, result->types,
+                                      &result->column_references);
+    if (result->names.empty()) {
+        throw std::runtime_error("msolap_table: " + result->table_name + " has no columns");
+    }
+    result->column_kinds.assign(result->names.size(), MSOLAPValueKind::EMPTY);
+
+    result->partition_column = MSOLAPTablePartitionColumn(*result, partition_column);
+    MSOLAPTableStatistics(context, *result, table);
+
+    names = result->names;
+    return_types = result->types;
+    return std::move(result);
+}
+
+static unique_ptr<NodeStatistics> MSOLAPTableCardinality(ClientContext &context, const FunctionData *bind_data_p) {
+    auto &bind_data = bind_data_p->Cast<MSOLAPTableBindData>();
+    return make_uniq<NodeStatistics>(bind_data.cardinality, bind_data.cardinality);
+}
+
+static unique_ptr<GlobalTableFunctionState> MSOLAPTableInitGlobal(ClientContext &context,
+                                                                  TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<MSOLAPTableBindData>();
+    auto result = make_uniq<MSOLAPTableGlobalState>();
+    result->pushdowns = bind_data.pushdowns;
+
+    // Only the columns DuckDB reads are selected
+    vector<idx_t> columns;
+    for (auto column_id : input.column_ids) {
+        if (column_id < bind_data.types.size()) {
+            result->projection.push_back(columns.size());
+            columns.push_back(column_id);
+        } else {
+            result->projection.push_back(DConstants::INVALID_INDEX);
+        }
+    }
+    bool partitionable = bind_data.Partitionable();
+    if (columns.empty()) {
+        // COUNT(*) and the like still need one row per row of the table
+        columns.push_back(partitionable ? bind_data.partition_column : 0);
+    }
+
+    MSOLAPFilterPushdown pushdown(bind_data.column_references, bind_data.types,
+                                  MSOLAPFilterPushdown::KeyThreshold(context));
+    if (input.filters) {
+        // Global init runs once the build side of a join is complete, so input.filters
+        // also carries the join's runtime key filters at this point
+        pushdown.AddFilters(*input.filters, input.column_ids);
+        result->pushdowns.insert(result->pushdowns.end(), pushdown.pushdowns.begin(), pushdown.pushdowns.end());
+        result->filter = MSOLAPFilterPushdown::LocalFilter(*input.filters, input.column_ids, bind_data.types);
+    }
+
+    // One partition per MSOLAP_TABLE_PARTITION_ROWS rows, each a range of the key
+    idx_t partitions = 1;
+    if (partitionable) {
+        partitions = MaxValue<idx_t>(bind_data.cardinality / MSOLAP_TABLE_PARTITION_ROWS, 1);
+        partitions = MinValue<idx_t>(partitions, bind_data.max_threads);
+        partitions = MinValue<idx_t>(partitions, TaskScheduler::GetScheduler(context).NumberOfThreads());
+        uint64_t span = uint64_t(bind_data.partition_max) - uint64_t(bind_data.partition_min);
+        if (span < partitions) {
+            partitions = span + 1;
+        }
+    }
+    for (idx_t i = 0; i < partitions; i++) {
+        // The range goes with the pushed filters, a filter on the partition column
+        // (e.g. join keys) must not replace it
+        vector<string> partition;
+        if (partitions > 1) {
+            partition.push_back(bind_data.PartitionFilter(i, partitions));
+        }
+        auto table = MSOLAPDax::TableExpression(pushdown.Rewrite(bind_data.dax_query, partition));
+        result->queries.push_back(bind_data.BuildQuery(columns, table));
+    }
+    if (partitions > 1) {
+        result->pushdowns.push_back(to_string(partitions) + " partitions of " +
+                                    bind_data.column_references[bind_data.partition_column]);
+    }
+    return std::move(result);
+}
+
+static unique_ptr<LocalTableFunctionState> MSOLAPTableInitLocal(ExecutionContext &context,
+                                                                TableFunctionInitInput &input,
+                                                                GlobalTableFunctionState *global_state) {
+    auto &gstate = global_state->Cast<MSOLAPTableGlobalState>();
+    auto result = make_uniq<MSOLAPTableLocalState>();
+    result->filter.Initialize(context.client, gstate.filter.get());
+    return std::move(result);
+}
+
+static void MSOLAPTableScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+    auto &bind_data = data.bind_data->Cast<MSOLAPTableBindData>();
+    auto &gstate = data.global_state->Cast<MSOLAPTableGlobalState>();
+    auto &state = data.local_state->Cast<MSOLAPTableLocalState>();
+
+    while (true) {
+        // Each thread streams one partition at a time and claims the next when it drains
+        if (!state.scanning) {
+            idx_t index = gstate.next_query++;
+            if (index >= gstate.queries.size()) {
+                output.SetCardinality(0);
+                return;
+            }
+            state.reader = make_uniq<MSOLAPRowsetReader>();
+            state.reader->Open(context, bind_data.connection_string, gstate.queries[index],
+                               vector<MSOLAPParameter>(), gstate.projection);
+            state.scanning = true;
+            state.partitions++;
+        }
+
+        idx_t count = state.reader->Read(output);
+        if (count == 0) {
+            state.rows += state.reader->metrics.rows;
+            state.bytes += state.reader->metrics.bytes;
+            state.reader->Close();
+            state.scanning = false;
+            continue;
+        }
+        output.SetCardinality(count);
+        if (state.filter.Apply(output)) {
+            return;
+        }
+    }
+}
+
+static InsertionOrderPreservingMap<string> MSOLAPTableToString(TableFunctionToStringInput &input) {
+    InsertionOrderPreservingMap<string> result;
+    auto &bind_data = input.bind_data->Cast<MSOLAPTableBindData>();
+
+    result["Connection"] = bind_data.connection_string;
+    result["Table"] = bind_data.table_name;
+    result["Rows"] = to_string(bind_data.cardinality);
+    if (bind_data.Partitionable()) {
+        result["Partition Column"] = bind_data.column_references[bind_data.partition_column] + " [" +
+                                     to_string(bind_data.partition_min) + ", " +
+                                     to_string(bind_data.partition_max) + "]";
+    }
+    if (!bind_data.pushdowns.empty()) {
+        result["Query"] = bind_data.dax_query;
+    }
+
+    return result;
+}
+
+static InsertionOrderPreservingMap<string> MSOLAPTableDynamicToString(TableFunctionDynamicToStringInput &input) {
+    InsertionOrderPreservingMap<string> result;
+    if (input.global_state) {
+        auto &gstate = input.global_state->Cast<MSOLAPTableGlobalState>();
+        result["Pushdown"] = gstate.pushdowns.empty() ? "none" : StringUtil::Join(gstate.pushdowns, ", ");
+        result["Partitions"] = to_string(gstate.queries.size());
+    }
+    if (!input.local_state) {
+        return result;
+    }
+    auto &local_state = input.local_state->Cast<MSOLAPTableLocalState>();
+    result["Scanned Partitions"] = to_string(local_state.partitions);
+    result["Rows"] = to_string(local_state.rows);
+    result["Bytes"] = to_string(local_state.bytes);
+    if (local_state.reader) {
+        result["Executed Query"] = local_state.reader->dax_query;
+    }
+    return result;
+}
+
+MSOLAPTableFunction::MSOLAPTableFunction()
+    : TableFunction("msolap_table", {LogicalType::VARCHAR, LogicalType::VARCHAR}, MSOLAPTableScan, MSOLAPTableBind,
+                    MSOLAPTableInitGlobal, MSOLAPTableInitLocal) {
+    named_parameters["partition_column"] = LogicalType::VARCHAR;
+    named_parameters["max_threads"] = LogicalType::UBIGINT;
+    // Constant predicates and join keys become CALCULATETABLE filters of every partition
+    filter_pushdown = true;
+    // SELECTCOLUMNS lists only the columns read by the query
+    projection_pushdown = true;
+    cardinality = MSOLAPTableCardinality;
+    to_string = MSOLAPTableToString;
+    dynamic_to_string = MSOLAPTableDynamicToString;
+}
+
+} // namespace duckdb
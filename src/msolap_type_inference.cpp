@@ -0,0 +1,48 @@
+#include "msolap_type_inference.hpp"
+
+namespace duckdb {
+
+static bool MSOLAPIsNumber(MSOLAPValueKind kind) {
+    return kind == MSOLAPValueKind::INTEGER || kind == MSOLAPValueKind::DECIMAL || kind == MSOLAPValueKind::DOUBLE;
+}
+
+static bool MSOLAPIsDate(MSOLAPValueKind kind) {
+    return kind == MSOLAPValueKind::DATE || kind == MSOLAPValueKind::TIMESTAMP;
+}
+
+MSOLAPValueKind MSOLAPTypeInference::Combine(MSOLAPValueKind left, MSOLAPValueKind right) {
+    if (left == right || right == MSOLAPValueKind::EMPTY) {
+        return left;
+    }
+    if (left == MSOLAPValueKind::EMPTY) {
+        return right;
+    }
+    // Within a family the enum is ordered from narrow to wide
+    if ((MSOLAPIsNumber(left) && MSOLAPIsNumber(right)) || (MSOLAPIsDate(left) && MSOLAPIsDate(right))) {
+        return left > right ? left : right;
+    }
+    return MSOLAPValueKind::STRING;
+}
+
+const char *MSOLAPTypeInference::TypeName(MSOLAPValueKind kind) {
+    switch (kind) {
+    case MSOLAPValueKind::BOOLEAN:
+        return "BOOLEAN";
+    case MSOLAPValueKind::INTEGER:
+        return "BIGINT";
+    case MSOLAPValueKind::DECIMAL:
+        return "DECIMAL(38,4)";
+    case MSOLAPValueKind::DOUBLE:
+        return "DOUBLE";
+    case MSOLAPValueKind::DATE:
+        return "DATE";
+    case MSOLAPValueKind::TIMESTAMP:
+        return "TIMESTAMP";
+    case MSOLAPValueKind::EMPTY:
+    case MSOLAPValueKind::STRING:
+    default:
+        return "VARCHAR";
+    }
+}
+
+} // namespace duckdb
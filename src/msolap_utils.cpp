@@ -1,4 +1,5 @@
 #include "msolap_utils.hpp"
+#include <cmath>
 
 namespace duckdb {
 
@@ -23,12 +24,26 @@ Value MSOLAPUtils::ConvertVariantToValue(VARIANT* pVar) {
     case VT_NULL:
     case VT_EMPTY:
         return Value();
+    case VT_I1:
+        return Value::TINYINT(pVar->cVal);
+    case VT_UI1:
+        return Value::UTINYINT(pVar->bVal);
     case VT_I2:
         return Value::SMALLINT(pVar->iVal);
+    case VT_UI2:
+        return Value::USMALLINT(pVar->uiVal);
     case VT_I4:
         return Value::INTEGER(pVar->lVal);
+    case VT_INT:
+        return Value::INTEGER(pVar->intVal);
+    case VT_UI4:
+        return Value::UINTEGER(pVar->ulVal);
+    case VT_UINT:
+        return Value::UINTEGER(pVar->uintVal);
     case VT_I8:
         return Value::BIGINT(pVar->llVal);
+    case VT_UI8:
+        return Value::UBIGINT(pVar->ullVal);
     case VT_R4:
         return Value::FLOAT(pVar->fltVal);
     case VT_R8:
@@ -51,21 +66,24 @@ Value MSOLAPUtils::ConvertVariantToValue(VARIANT* pVar) {
             return Value("");
         }
     case VT_DATE: {
-        date_t date_val = date_t(0); // Initialize with epoch
-        try {
-            // Convert OLE automation date to DuckDB date
-            time_t epoch_seconds = (time_t)((pVar->date - 25569) * 86400); // 25569 is days between 1899-12-30 and 1970-01-01
-            date_val = Date::EpochToDate(epoch_seconds);
-        } catch (...) {
-            // Return default date on error
+        // OLE automation dates count days since 1899-12-30 (25569 days before the
+        // epoch); the time of day is the fraction, also for negative dates
+        double days = std::trunc(pVar->date);
+        auto time_micros = (int64_t)std::llround(std::fabs(pVar->date - days) * (double)Interval::MICROS_PER_DAY);
+        auto epoch_days = (int64_t)days - 25569;
+        if (time_micros == 0) {
+            return Value::DATE(date_t((int32_t)epoch_days));
         }
-        return Value::DATE(date_val);
+        return Value::TIMESTAMP(timestamp_t(epoch_days * Interval::MICROS_PER_DAY + time_micros));
     }
-    case VT_CY: {
+    case VT_CY:
         // Currency is a 64-bit integer scaled by 10,000
-        int64_t scaled_value = ((int64_t)pVar->cyVal.Hi) << 32 | pVar->cyVal.Lo;
-        double value = scaled_value / 10000.0;
-        return Value::DOUBLE(value);
+        return Value::DECIMAL(hugeint_t(pVar->cyVal.int64), 38, 4);
+    case VT_DECIMAL: {
+        // 96-bit magnitude with a separate sign and up to 28 digits after the point
+        auto &dec = pVar->decVal;
+        hugeint_t magnitude((int64_t)dec.Hi32, dec.Lo64);
+        return Value::DECIMAL(dec.sign & DECIMAL_NEG ? -magnitude : magnitude, 38, dec.scale);
     }
     default:
         // For types we can't handle well, convert to string
@@ -91,6 +109,42 @@ Value MSOLAPUtils::ConvertVariantToValue(VARIANT* pVar) {
     }
 }
 
+void MSOLAPUtils::ConvertValueToVariant(const Value &value, VARIANT* pVar) {
+    VariantInit(pVar);
+    if (value.IsNull()) {
+        pVar->vt = VT_NULL;
+        return;
+    }
+
+    switch (value.type().id()) {
+    case LogicalTypeId::BOOLEAN:
+        pVar->vt = VT_BOOL;
+        pVar->boolVal = BooleanValue::Get(value) ? VARIANT_TRUE : VARIANT_FALSE;
+        break;
+    case LogicalTypeId::BIGINT:
+        pVar->vt = VT_I8;
+        pVar->llVal = BigIntValue::Get(value);
+        break;
+    case LogicalTypeId::DOUBLE:
+        pVar->vt = VT_R8;
+        pVar->dblVal = DoubleValue::Get(value);
+        break;
+    case LogicalTypeId::TIMESTAMP: {
+        // OLE automation dates count days since 1899-12-30
+        auto micros = Timestamp::GetEpochMicroSeconds(value.GetValue<timestamp_t>());
+        pVar->vt = VT_DATE;
+        pVar->date = 25569.0 + (double)micros / (double)Interval::MICROS_PER_DAY;
+        break;
+    }
+    default: {
+        std::wstring wstr = WindowsUtil::UTF8ToUnicode(value.ToString().c_str());
+        pVar->vt = VT_BSTR;
+        pVar->bstrVal = SysAllocString(wstr.c_str());
+        break;
+    }
+    }
+}
+
 LogicalType MSOLAPUtils::GetLogicalTypeFromDBTYPE(DBTYPE type) {
     switch (type) {
     case DBTYPE_BOOL:
@@ -120,6 +174,8 @@ LogicalType MSOLAPUtils::GetLogicalTypeFromDBTYPE(DBTYPE type) {
     case DBTYPE_DBTIME:
     case DBTYPE_DBTIMESTAMP:
         return LogicalType::TIMESTAMP;
+    case DBTYPE_VARIANT:
+        // Measures and calculated columns, typed from their values when scanned by msolap()
     case DBTYPE_GUID:
     case DBTYPE_WSTR:
     case DBTYPE_STR:
@@ -129,6 +185,59 @@ LogicalType MSOLAPUtils::GetLogicalTypeFromDBTYPE(DBTYPE type) {
     }
 }
 
+MSOLAPValueKind MSOLAPUtils::GetVariantKind(const VARIANT &var) {
+    switch (var.vt) {
+    case VT_EMPTY:
+    case VT_NULL:
+        return MSOLAPValueKind::EMPTY;
+    case VT_BOOL:
+        return MSOLAPValueKind::BOOLEAN;
+    case VT_I1:
+    case VT_UI1:
+    case VT_I2:
+    case VT_UI2:
+    case VT_I4:
+    case VT_UI4:
+    case VT_INT:
+    case VT_UINT:
+    case VT_I8:
+        return MSOLAPValueKind::INTEGER;
+    case VT_CY:
+        return MSOLAPValueKind::DECIMAL;
+    case VT_DECIMAL:
+        return var.decVal.scale <= 4 ? MSOLAPValueKind::DECIMAL : MSOLAPValueKind::DOUBLE;
+    case VT_UI8:
+        // Doesn't always fit a BIGINT
+        return MSOLAPValueKind::DECIMAL;
+    case VT_R4:
+    case VT_R8:
+        return MSOLAPValueKind::DOUBLE;
+    case VT_DATE:
+        return var.date == std::trunc(var.date) ? MSOLAPValueKind::DATE : MSOLAPValueKind::TIMESTAMP;
+    default:
+        return MSOLAPValueKind::STRING;
+    }
+}
+
+LogicalType MSOLAPUtils::GetLogicalTypeFromValueKind(MSOLAPValueKind kind) {
+    switch (kind) {
+    case MSOLAPValueKind::BOOLEAN:
+        return LogicalType::BOOLEAN;
+    case MSOLAPValueKind::INTEGER:
+        return LogicalType::BIGINT;
+    case MSOLAPValueKind::DECIMAL:
+        return LogicalType::DECIMAL(38, 4);
+    case MSOLAPValueKind::DOUBLE:
+        return LogicalType::DOUBLE;
+    case MSOLAPValueKind::DATE:
+        return LogicalType::DATE;
+    case MSOLAPValueKind::TIMESTAMP:
+        return LogicalType::TIMESTAMP;
+    default:
+        return LogicalType::VARCHAR;
+    }
+}
+
 std::string MSOLAPUtils::GetErrorMessage(HRESULT hr) {
     _com_error err(hr);
     LPCTSTR errMsg = err.ErrorMessage();
@@ -0,0 +1,65 @@
+#include "msolap_watchdog.hpp"
+
+namespace duckdb {
+
+MSOLAPWatchdog::MSOLAPWatchdog()
+    : interrupt_flag(nullptr), timeout_ms(0), stopping(false), cancelled(false), interrupted(false),
+      timed_out(false) {
+}
+
+MSOLAPWatchdog::~MSOLAPWatchdog() {
+    Stop();
+}
+
+void MSOLAPWatchdog::Start(std::function<void()> cancel_p, const std::atomic<bool> &interrupted_p,
+                           uint64_t timeout_ms_p) {
+    Stop();
+    cancel = std::move(cancel_p);
+    interrupt_flag = &interrupted_p;
+    timeout_ms = timeout_ms_p;
+    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    stopping = false;
+    cancelled = false;
+    interrupted = false;
+    timed_out = false;
+    thread = std::thread(&MSOLAPWatchdog::Run, this);
+}
+
+void MSOLAPWatchdog::Stop() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    cv.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void MSOLAPWatchdog::Cancel() {
+    if (cancel && !cancelled.exchange(true)) {
+        cancel();
+    }
+}
+
+void MSOLAPWatchdog::Run() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (!stopping) {
+        cv.wait_for(guard, std::chrono::milliseconds(MSOLAP_WATCHDOG_POLL_MS));
+        if (stopping) {
+            break;
+        }
+        if (*interrupt_flag) {
+            interrupted = true;
+            Cancel();
+            break;
+        }
+        if (timeout_ms > 0 && std::chrono::steady_clock::now() >= deadline) {
+            timed_out = true;
+            Cancel();
+            break;
+        }
+    }
+}
+
+} // namespace duckdb
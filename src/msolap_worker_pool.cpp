@@ -0,0 +1,96 @@
+#include "msolap_worker_pool.hpp"
+#include <chrono>
+
+namespace duckdb {
+
+// Set on the workers of every pool, used to run nested tasks inline
+static thread_local bool msolap_worker_thread = false;
+
+// Spins before an idle worker goes to sleep; fetch requests from a running scan
+// usually arrive back to back, so this avoids a futex round trip per batch
+static constexpr int MSOLAP_WORKER_SPIN_COUNT = 64;
+
+MSOLAPWorkerPool::MSOLAPWorkerPool(size_t thread_count, std::function<void()> thread_start_p,
+                                   std::function<void()> thread_stop_p, size_t queue_capacity)
+    : queue(queue_capacity), thread_start(std::move(thread_start_p)), thread_stop(std::move(thread_stop_p)),
+      pending(0), sleeping(0), stopping(false) {
+    if (thread_count == 0) {
+        thread_count = 1;
+    }
+    for (size_t i = 0; i < thread_count; i++) {
+        threads.emplace_back(&MSOLAPWorkerPool::WorkerLoop, this);
+    }
+}
+
+MSOLAPWorkerPool::~MSOLAPWorkerPool() {
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        stopping = true;
+    }
+    sleep_cv.notify_all();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+bool MSOLAPWorkerPool::OnWorkerThread() {
+    return msolap_worker_thread;
+}
+
+void MSOLAPWorkerPool::Submit(Task task) {
+    // Counted before the push so a worker never sees more tasks than pending
+    pending++;
+    while (!queue.TryPush(task)) {
+        // Full: every worker is busy, let one of them make progress
+        std::this_thread::yield();
+    }
+    if (sleeping.load() > 0) {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        sleep_cv.notify_one();
+    }
+}
+
+void MSOLAPWorkerPool::WorkerLoop() {
+    msolap_worker_thread = true;
+    if (thread_start) {
+        thread_start();
+    }
+
+    Task task;
+    int spins = 0;
+    while (true) {
+        if (queue.TryPop(task)) {
+            pending--;
+            spins = 0;
+            try {
+                task();
+            } catch (...) {
+                // Async() hands exceptions to the waiting caller, plain tasks can't report them
+            }
+            task = nullptr;
+            continue;
+        }
+        if (stopping) {
+            break;
+        }
+        if (++spins < MSOLAP_WORKER_SPIN_COUNT) {
+            std::this_thread::yield();
+            continue;
+        }
+        spins = 0;
+
+        // pending is incremented before a producer checks sleeping, so a task
+        // submitted while we get here is either seen by the predicate or wakes us
+        std::unique_lock<std::mutex> guard(sleep_lock);
+        sleeping++;
+        sleep_cv.wait_for(guard, std::chrono::milliseconds(100), [&]() { return pending.load() > 0 || stopping; });
+        sleeping--;
+    }
+
+    if (thread_stop) {
+        thread_stop();
+    }
+    msolap_worker_thread = false;
+}
+
+} // namespace duckdb
@@ -0,0 +1,125 @@
+// Unit tests of the cellset to table expansion on synthetic cellsets. Portable,
+// build with -DMSOLAP_BUILD_UNITTESTS=ON or directly:
+//
+//   g++ -std=c++17 -Isrc/include -o test_msolap_cellset
+//       test/cpp/test_msolap_cellset.cpp src/msolap_cellset.cpp
+
+#include "msolap_cellset.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace duckdb;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                                               \
+    do {                                                                                                               \
+        if (!(condition)) {                                                                                            \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition);                        \
+            failures++;                                                                                                \
+        }                                                                                                              \
+    } while (0)
+
+static MSOLAPCellsetAxis Axis(std::vector<std::string> dimensions, std::vector<std::string> members) {
+    MSOLAPCellsetAxis axis;
+    axis.dimension_names = std::move(dimensions);
+    axis.members = std::move(members);
+    return axis;
+}
+
+// Ordinal as defined by OLE DB for OLAP: sum of tuple[a] * product of earlier axis sizes
+static size_t ReferenceOrdinal(const std::vector<size_t> &tuples, const std::vector<size_t> &sizes) {
+    size_t ordinal = 0;
+    size_t factor = 1;
+    for (size_t axis = 0; axis < tuples.size(); axis++) {
+        ordinal += tuples[axis] * factor;
+        factor *= sizes[axis];
+    }
+    return ordinal;
+}
+
+static void TestScalar() {
+    MSOLAPCellsetLayout layout({});
+    CHECK(layout.RowCount() == 1);
+    CHECK(layout.MemberColumnCount() == 0);
+    CHECK(layout.ValueColumnCount() == 1);
+    CHECK(layout.ColumnNames() == std::vector<std::string>({"Value"}));
+    CHECK(layout.CellOrdinal(0, 0) == 0);
+}
+
+static void TestColumnsOnly() {
+    MSOLAPCellsetLayout layout({Axis({"Measures"}, {"Sales Amount", "Order Count"})});
+    CHECK(layout.RowCount() == 1);
+    CHECK(layout.MemberColumnCount() == 0);
+    CHECK(layout.ColumnNames() == std::vector<std::string>({"Sales Amount", "Order Count"}));
+    CHECK(layout.CellOrdinal(0, 1) == 1);
+    CHECK(layout.CellCount() == 2);
+}
+
+static void TestRowsAndColumns() {
+    MSOLAPCellsetLayout layout({Axis({"Measures"}, {"Sales Amount", "Order Count"}),
+                                Axis({"Year", "Country"}, {"2023", "DE", "2023", "FR", "2024", "DE"})});
+    CHECK(layout.RowCount() == 3);
+    CHECK(layout.MemberColumnCount() == 2);
+    CHECK(layout.ColumnNames() == std::vector<std::string>({"Year", "Country", "Sales Amount", "Order Count"}));
+    CHECK(layout.Member(1, 0) == "2023");
+    CHECK(layout.Member(1, 1) == "FR");
+    CHECK(layout.Member(2, 0) == "2024");
+    CHECK(layout.CellOrdinal(2, 1) == 5);
+    CHECK(layout.CellCount() == 6);
+}
+
+static void TestThreeAxes() {
+    MSOLAPCellsetLayout layout({Axis({"Measures"}, {"A", "B"}), Axis({"Product"}, {"p0", "p1", "p2"}),
+                                Axis({"Year"}, {"2023", "2024"})});
+    std::vector<size_t> sizes = {2, 3, 2};
+    CHECK(layout.RowCount() == 6);
+    CHECK(layout.ColumnNames() == std::vector<std::string>({"Product", "Year", "A", "B"}));
+    for (size_t row = 0; row < layout.RowCount(); row++) {
+        size_t product = row % 3;
+        size_t year = row / 3;
+        CHECK(layout.Member(row, 0) == "p" + std::to_string(product));
+        CHECK(layout.Member(row, 1) == (year == 0 ? "2023" : "2024"));
+        for (size_t column = 0; column < 2; column++) {
+            CHECK(layout.CellOrdinal(row, column) == ReferenceOrdinal({column, product, year}, sizes));
+        }
+    }
+    // Consecutive rows cover one contiguous ordinal range
+    CHECK(layout.CellOrdinal(5, 1) - layout.CellOrdinal(2, 0) + 1 == 4 * 2);
+}
+
+static void TestEmptyAxes() {
+    MSOLAPCellsetLayout empty_rows({Axis({"Measures"}, {"A"}), Axis({"Year"}, {})});
+    CHECK(empty_rows.RowCount() == 0);
+    CHECK(empty_rows.ColumnNames() == std::vector<std::string>({"Year", "A"}));
+
+    MSOLAPCellsetLayout empty_columns({Axis({"Measures"}, {}), Axis({"Year"}, {"2023"})});
+    CHECK(empty_columns.RowCount() == 0);
+    CHECK(empty_columns.ValueColumnCount() == 0);
+}
+
+static void TestColumnNames() {
+    // Crossjoined columns are named after all their members; repeated names get a suffix
+    MSOLAPCellsetLayout layout({Axis({"Year", "Measures"}, {"2023", "Sales", "2024", "Sales", "", ""}),
+                                Axis({"Sales"}, {"x"})});
+    CHECK(layout.ColumnNames() ==
+          std::vector<std::string>({"Sales", "2023 | Sales", "2024 | Sales", "Column2"}));
+
+    MSOLAPCellsetLayout duplicates({Axis({"Measures"}, {"A", "A", "A"})});
+    CHECK(duplicates.ColumnNames() == std::vector<std::string>({"A", "A_1", "A_2"}));
+}
+
+int main() {
+    TestScalar();
+    TestColumnsOnly();
+    TestRowsAndColumns();
+    TestThreeAxes();
+    TestEmptyAxes();
+    TestColumnNames();
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All cellset layout tests passed\n");
+    return EXIT_SUCCESS;
+}
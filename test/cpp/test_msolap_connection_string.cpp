@@ -0,0 +1,145 @@
+// Unit tests of the OLE DB connection string parser. Portable, build with
+// -DMSOLAP_BUILD_UNITTESTS=ON or directly:
+//
+//   g++ -std=c++17 -Isrc/include -o test_msolap_connection_string
+//       test/cpp/test_msolap_connection_string.cpp src/msolap_connection_string.cpp
+
+#include "msolap_connection_string.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace duckdb;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                                               \
+    do {                                                                                                               \
+        if (!(condition)) {                                                                                            \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition);                        \
+            failures++;                                                                                                \
+        }                                                                                                              \
+    } while (0)
+
+static bool ParseFails(const std::string &connection_string) {
+    try {
+        MSOLAPConnectionString::Parse(connection_string);
+    } catch (std::invalid_argument &) {
+        return true;
+    }
+    return false;
+}
+
+static std::string Get(const MSOLAPConnectionString &parsed, const std::string &keyword) {
+    std::string value;
+    return parsed.TryGet(keyword, value) ? value : "<missing>";
+}
+
+static void TestSimple() {
+    auto parsed = MSOLAPConnectionString::Parse("Data Source=localhost:61324;Catalog=0ec50266-bdf5");
+    CHECK(parsed.Properties().size() == 2);
+    CHECK(Get(parsed, "data source") == "localhost:61324");
+    CHECK(Get(parsed, "CATALOG") == "0ec50266-bdf5");
+    CHECK(Get(parsed, "Password") == "<missing>");
+}
+
+static void TestWhitespaceAndEmptyEntries() {
+    auto parsed = MSOLAPConnectionString::Parse("  Data Source = srv ;; Catalog=  Model  ;");
+    CHECK(parsed.Properties().size() == 2);
+    CHECK(parsed.Properties()[0].keyword == "Data Source");
+    CHECK(Get(parsed, "Data Source") == "srv");
+    CHECK(Get(parsed, "Catalog") == "Model");
+    CHECK(MSOLAPConnectionString::Parse("").Properties().empty());
+}
+
+static void TestQuotedValues() {
+    auto parsed = MSOLAPConnectionString::Parse(
+        "Password=\"a;b=c\";User ID='O''Brien';Roles=\"Reader \"\"EU\"\"\" ;Catalog= ' padded '");
+    CHECK(Get(parsed, "Password") == "a;b=c");
+    CHECK(Get(parsed, "User ID") == "O'Brien");
+    CHECK(Get(parsed, "Roles") == "Reader \"EU\"");
+    CHECK(Get(parsed, "Catalog") == " padded ");
+}
+
+static void TestEscapedKeyword() {
+    auto parsed = MSOLAPConnectionString::Parse("a==b=c");
+    CHECK(Get(parsed, "a=b") == "c");
+}
+
+static void TestDuplicates() {
+    auto parsed = MSOLAPConnectionString::Parse("Catalog=A;catalog=B");
+    CHECK(parsed.Properties().size() == 1);
+    CHECK(Get(parsed, "Catalog") == "B");
+}
+
+static void TestErrors() {
+    CHECK(ParseFails("Data Source"));
+    CHECK(ParseFails("=value"));
+    CHECK(ParseFails("Password=\"open"));
+    CHECK(ParseFails("Password=\"a\"b"));
+    CHECK(!ParseFails("Password=\"a\"  ;Catalog=x"));
+}
+
+static void TestInitProperties() {
+    auto parsed = MSOLAPConnectionString::Parse("Provider=MSOLAP.8;Data Source=srv;Initial Catalog=A;Database=B;"
+                                                "UID=me;PWD=secret;Connect Timeout=30;Transport Compression=Compressed");
+    auto init = parsed.InitProperties();
+    CHECK(init.size() == 5);
+    CHECK(init[0].first == MSOLAPInitProperty::DATA_SOURCE && init[0].second == "srv");
+    // Synonyms collapse, the last one wins
+    CHECK(init[1].first == MSOLAPInitProperty::CATALOG && init[1].second == "B");
+    CHECK(init[2].first == MSOLAPInitProperty::USER_ID && init[2].second == "me");
+    CHECK(init[3].first == MSOLAPInitProperty::PASSWORD && init[3].second == "secret");
+    CHECK(init[4].first == MSOLAPInitProperty::CONNECT_TIMEOUT && init[4].second == "30");
+}
+
+static void TestProviderString() {
+    auto parsed = MSOLAPConnectionString::Parse("Provider=MSOLAP;Data Source=srv;Transport Compression=Compressed;"
+                                                "Compression Level=9;Application Name=\"duck;db\";Packet Size=32767");
+    auto provider_string = parsed.ProviderString();
+    CHECK(provider_string ==
+          "Transport Compression=Compressed;Compression Level=9;Application Name=\"duck;db\";Packet Size=32767");
+
+    // The provider string parses back to the same pairs
+    auto reparsed = MSOLAPConnectionString::Parse(provider_string);
+    CHECK(Get(reparsed, "Application Name") == "duck;db");
+    CHECK(reparsed.Properties().size() == 4);
+}
+
+static void TestDescription() {
+    auto parsed = MSOLAPConnectionString::Parse("Provider=MSOLAP.8;Data Source=srv;Initial Catalog=\"A;B\";"
+                                                "User ID=me;Pwd=secret;Transport Compression=Compressed");
+    CHECK(parsed.Description() == "Data Source=srv;Catalog=\"A;B\"");
+    CHECK(parsed.Description().find("secret") == std::string::npos);
+    CHECK(MSOLAPConnectionString::Parse("Password=x").Description() == "Data Source=");
+}
+
+static void TestQuoteValue() {
+    CHECK(MSOLAPConnectionString::QuoteValue("plain") == "plain");
+    CHECK(MSOLAPConnectionString::QuoteValue("a;b") == "\"a;b\"");
+    CHECK(MSOLAPConnectionString::QuoteValue("say \"hi\"") == "'say \"hi\"'");
+    CHECK(MSOLAPConnectionString::QuoteValue("both \"'") == "\"both \"\"'\"");
+    for (std::string value : {"x;y", " lead", "both \"';", "it's"}) {
+        auto parsed = MSOLAPConnectionString::Parse("k=" + MSOLAPConnectionString::QuoteValue(value));
+        CHECK(Get(parsed, "k") == value);
+    }
+}
+
+int main() {
+    TestSimple();
+    TestWhitespaceAndEmptyEntries();
+    TestQuotedValues();
+    TestEscapedKeyword();
+    TestDuplicates();
+    TestErrors();
+    TestInitProperties();
+    TestProviderString();
+    TestDescription();
+    TestQuoteValue();
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All connection string tests passed\n");
+    return EXIT_SUCCESS;
+}
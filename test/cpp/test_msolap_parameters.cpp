@@ -0,0 +1,94 @@
+// Unit tests of the params := {...} normalization. Needs DuckDB but no provider
+// or server, built with -DMSOLAP_BUILD_UNITTESTS=ON as part of the DuckDB build.
+
+#include "msolap_parameters.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace duckdb;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                                               \
+    do {                                                                                                               \
+        if (!(condition)) {                                                                                            \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition);                        \
+            failures++;                                                                                                \
+        }                                                                                                              \
+    } while (0)
+
+// Whether FromStruct rejects the value with a message containing expected
+static bool Rejects(const Value &params, const string &expected) {
+    try {
+        MSOLAPParameters::FromStruct(params);
+    } catch (std::runtime_error &e) {
+        return string(e.what()).find(expected) != string::npos;
+    }
+    return false;
+}
+
+static Value Params(child_list_t<Value> children) {
+    return Value::STRUCT(std::move(children));
+}
+
+static void TestNames() {
+    CHECK(MSOLAPParameters::NormalizeName("year") == "year");
+    CHECK(MSOLAPParameters::NormalizeName("@year") == "year");
+    CHECK(Rejects(Params({{"@", Value::INTEGER(1)}}), "must not be empty"));
+    CHECK(Rejects(Params({{"year", Value::INTEGER(1)}, {"@Year", Value::INTEGER(2)}}), "@Year is given twice"));
+
+    auto parameters = MSOLAPParameters::FromStruct(Params({{"@a", Value::INTEGER(1)}, {"b", Value("x")}}));
+    CHECK(parameters.size() == 2);
+    CHECK(parameters[0].name == "a");
+    CHECK(parameters[1].name == "b");
+}
+
+static void TestValueTypes() {
+    auto parameters = MSOLAPParameters::FromStruct(Params({{"flag", Value::BOOLEAN(true)},
+                                                           {"small", Value::SMALLINT(7)},
+                                                           {"unsigned", Value::UINTEGER(4000000000U)},
+                                                           {"decimal", Value::DECIMAL(12345, 9, 2)},
+                                                           {"real", Value::FLOAT(0.5f)},
+                                                           {"day", Value::DATE(2024, 2, 29)},
+                                                           {"text", Value("Red")},
+                                                           {"nothing", Value()}}));
+    CHECK(parameters.size() == 8);
+    CHECK(parameters[0].value.type().id() == LogicalTypeId::BOOLEAN);
+    CHECK(parameters[1].value == Value::BIGINT(7));
+    CHECK(parameters[2].value == Value::BIGINT(4000000000LL));
+    CHECK(std::abs(parameters[3].value.GetValue<double>() - 123.45) < 1e-9);
+    CHECK(parameters[4].value == Value::DOUBLE(0.5));
+    CHECK(parameters[5].value.type().id() == LogicalTypeId::TIMESTAMP);
+    CHECK(parameters[5].value == Value::TIMESTAMP(2024, 2, 29, 0, 0, 0, 0));
+    CHECK(parameters[6].value == Value("Red"));
+    CHECK(parameters[7].value.IsNull());
+}
+
+static void TestRejectedValues() {
+    // DAX integers are 64-bit signed
+    CHECK(Rejects(Params({{"big", Value::UBIGINT(NumericLimits<uint64_t>::Maximum())}}), "64-bit DAX integer"));
+    CHECK(!Rejects(Params({{"big", Value::UBIGINT(42)}}), "64-bit DAX integer"));
+    CHECK(Rejects(Params({{"list", Value::LIST(LogicalType::INTEGER, {Value::INTEGER(1)})}}), "Unsupported type"));
+    CHECK(Rejects(Value::INTEGER(42), "params must be a struct"));
+    CHECK(MSOLAPParameters::FromStruct(Value(LogicalType::SQLNULL)).empty());
+}
+
+static void TestToString() {
+    auto parameters = MSOLAPParameters::FromStruct(Params({{"a", Value::INTEGER(1)}, {"@b", Value("x")}}));
+    CHECK(MSOLAPParameters::ToString(parameters) == "@a = 1, @b = 'x'");
+}
+
+int main() {
+    TestNames();
+    TestValueTypes();
+    TestRejectedValues();
+    TestToString();
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All parameter tests passed\n");
+    return EXIT_SUCCESS;
+}
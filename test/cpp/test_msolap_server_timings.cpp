@@ -0,0 +1,140 @@
+// Unit tests of the trace parsing behind server_timings := true, run against
+// recorded trace payloads. Portable, build with -DMSOLAP_BUILD_UNITTESTS=ON or
+// directly:
+//
+//   g++ -std=c++17 -Isrc/include -o test_msolap_server_timings
+//       test/cpp/test_msolap_server_timings.cpp src/msolap_server_timings.cpp
+
+#include "msolap_server_timings.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace duckdb;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                                               \
+    do {                                                                                                               \
+        if (!(condition)) {                                                                                            \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition);                        \
+            failures++;                                                                                                \
+        }                                                                                                              \
+    } while (0)
+
+// Subscribe response of a trace while one query ran, in the XMLA rowset format and
+// trimmed to the events the timings use plus a scan of another session. The two
+// scans overlap by 8 ms, the third storage engine query is internal.
+static const char *RECORDED_TRACE = R"(<?xml version="1.0" encoding="utf-8"?>
+<return xmlns="urn:schemas-microsoft-com:xml-analysis">
+<root xmlns="urn:schemas-microsoft-com:xml-analysis:rowset">
+<row><EventClass>83</EventClass><EventSubclass>0</EventSubclass><StartTime>2024-05-01T10:00:00.105</StartTime><Duration>20</Duration><CPUTime>47</CPUTime><TextData>SET DC_KIND=&quot;AUTO&quot;; SELECT 'Date'[Year], SUM ( 'Sales'[Amount] ) FROM 'Sales' ...</TextData><RequestID>7E1F</RequestID></row>
+<row><EventClass>83</EventClass><EventSubclass>0</EventSubclass><StartTime>2024-05-01T10:00:00.117</StartTime><Duration>13</Duration><CPUTime>16</CPUTime><TextData>SELECT 'Product'[Color] FROM 'Product';</TextData><RequestID>7E1F</RequestID></row>
+<row><EventClass>83</EventClass><EventSubclass>10</EventSubclass><StartTime>2024-05-01T10:00:00.106</StartTime><Duration>19</Duration><CPUTime>47</CPUTime><TextData>internal</TextData><RequestID>7E1F</RequestID></row>
+<row><EventClass>85</EventClass><EventSubclass>0</EventSubclass><TextData>SELECT 'Date'[Year] FROM 'Date';</TextData><RequestID>7E1F</RequestID></row>
+<row><EventClass>83</EventClass><EventSubclass>0</EventSubclass><StartTime>2024-05-01T10:00:00.110</StartTime><Duration>500</Duration><CPUTime>900</CPUTime><TextData>other session</TextData><RequestID>99AA</RequestID></row>
+<row><EventClass>10</EventClass><EventSubclass>3</EventSubclass><StartTime>2024-05-01T10:00:00.100</StartTime><Duration>52</Duration><CPUTime>78</CPUTime><TextData>// msolap trace 4242
+EVALUATE SUMMARIZECOLUMNS ( 'Date'[Year], &quot;Amount&quot;, [Total Amount] )</TextData><RequestID>7E1F</RequestID></row>
+<row/>
+</root>
+</return>)";
+
+static bool Near(double left, double right) {
+    return std::fabs(left - right) < 1e-9;
+}
+
+static void TestParseRecordedPayload() {
+    auto events = MSOLAPTraceParser::ParseRowsetXml(RECORDED_TRACE);
+    // The empty <row/> is skipped
+    CHECK(events.size() == 6);
+    CHECK(events[0].event_class == MSOLAPTraceEventClass::VERTIPAQ_SE_QUERY_END);
+    CHECK(events[0].duration_ms == 20);
+    CHECK(events[0].cpu_ms == 47);
+    CHECK(events[0].request_id == "7E1F");
+    CHECK(events[0].text.find("DC_KIND=\"AUTO\"") != std::string::npos);
+    CHECK(events[2].subclass == MSOLAP_TRACE_SUBCLASS_INTERNAL);
+    CHECK(events[3].event_class == MSOLAPTraceEventClass::VERTIPAQ_SE_QUERY_CACHE_MATCH);
+    CHECK(events[3].start_ms == -1);
+    CHECK(events[5].event_class == MSOLAPTraceEventClass::QUERY_END);
+    CHECK(events[5].text.find("// msolap trace 4242\nEVALUATE") == 0);
+}
+
+static void TestComputeRecordedPayload() {
+    auto timings = MSOLAPServerTimings::Compute(MSOLAPTraceParser::ParseRowsetXml(RECORDED_TRACE), "msolap trace 4242");
+    CHECK(timings.captured);
+    CHECK(Near(timings.total_ms, 52));
+    // [105, 125) and [117, 130) cover 25 ms, the other session's scan doesn't count
+    CHECK(Near(timings.se_ms, 25));
+    CHECK(Near(timings.fe_ms, 27));
+    CHECK(Near(timings.se_cpu_ms, 63));
+    CHECK(timings.se_queries == 2);
+    CHECK(timings.se_cache_hits == 1);
+
+    auto missing = MSOLAPServerTimings::Compute(MSOLAPTraceParser::ParseRowsetXml(RECORDED_TRACE), "msolap trace 1");
+    CHECK(!missing.captured);
+    CHECK(!missing.error.empty());
+}
+
+static void TestWithoutRequestIds() {
+    // Older servers: correlate by time, events without a start time count
+    auto events = MSOLAPTraceParser::ParseRowsetXml(
+        "<root><row><EventClass>Query End</EventClass><StartTime>2024-05-01 23:59:59.900</StartTime>"
+        "<Duration>200</Duration><TextData>EVALUATE t</TextData></row>"
+        "<row><EventClass>VertiPaq SE Query End</EventClass><StartTime>2024-05-02T00:00:00.000</StartTime>"
+        "<Duration>50</Duration><CPUTime>10</CPUTime></row>"
+        "<row><EventClass>VertiPaq SE Query End</EventClass><StartTime>2024-05-02T00:00:01.000</StartTime>"
+        "<Duration>50</Duration></row>"
+        "<row><EventClass>VertiPaq SE Query End</EventClass><Duration>30</Duration></row>"
+        "<row><EventClass>VertiPaq SE Query Cache Match</EventClass></row></root>");
+    auto timings = MSOLAPServerTimings::Compute(events, "");
+    CHECK(timings.captured);
+    CHECK(timings.se_queries == 2);
+    CHECK(Near(timings.se_ms, 80));
+    CHECK(Near(timings.fe_ms, 120));
+    CHECK(timings.se_cache_hits == 1);
+}
+
+static void TestStorageEngineCappedAtTotal() {
+    std::vector<MSOLAPTraceEvent> events(2);
+    events[0].event_class = MSOLAPTraceEventClass::QUERY_END;
+    events[0].duration_ms = 10;
+    events[1].event_class = MSOLAPTraceEventClass::VERTIPAQ_SE_QUERY_END;
+    events[1].duration_ms = 15;
+    auto timings = MSOLAPServerTimings::Compute(events, "");
+    CHECK(Near(timings.se_ms, 10));
+    CHECK(Near(timings.fe_ms, 0));
+}
+
+static void TestParseTimestamp() {
+    CHECK(MSOLAPTraceParser::ParseTimestamp("1970-01-01T00:00:00") == 0);
+    CHECK(MSOLAPTraceParser::ParseTimestamp("1970-01-02 00:00:01.5") == 86401500);
+    CHECK(MSOLAPTraceParser::ParseTimestamp("2000-03-01T00:00:00.1239") == 951868800123);
+    CHECK(MSOLAPTraceParser::ParseTimestamp("2024-13-01T00:00:00") == -1);
+    CHECK(MSOLAPTraceParser::ParseTimestamp("yesterday") == -1);
+    CHECK(MSOLAPTraceParser::ParseTimestamp("") == -1);
+}
+
+static void TestEntities() {
+    auto events = MSOLAPTraceParser::ParseRowsetXml(
+        "<row><TextData>a &lt;&gt; b &amp;&amp; &#233; &#x20AC; &bogus;</TextData></row>"
+        "<rows><row xmlns:x=\"y\"><x:RequestID>R1</x:RequestID><TextData/></row></rows>");
+    CHECK(events.size() == 2);
+    CHECK(events[0].text == "a <> b && \xC3\xA9 \xE2\x82\xAC &bogus;");
+    CHECK(events[1].request_id == "R1");
+    CHECK(events[1].text.empty());
+}
+
+int main() {
+    TestParseRecordedPayload();
+    TestComputeRecordedPayload();
+    TestWithoutRequestIds();
+    TestStorageEngineCappedAtTotal();
+    TestParseTimestamp();
+    TestEntities();
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All server timings tests passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+// Unit tests of the DBTYPE_VARIANT column type inference. Portable, build with
+// -DMSOLAP_BUILD_UNITTESTS=ON or directly:
+//
+//   g++ -std=c++17 -Isrc/include -o test_msolap_type_inference
+//       test/cpp/test_msolap_type_inference.cpp src/msolap_type_inference.cpp
+
+#include "msolap_type_inference.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <string>
+
+using namespace duckdb;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                                               \
+    do {                                                                                                               \
+        if (!(condition)) {                                                                                            \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition);                        \
+            failures++;                                                                                                \
+        }                                                                                                              \
+    } while (0)
+
+using Kind = MSOLAPValueKind;
+
+// Column kind after sampling the given values
+static Kind Infer(std::initializer_list<Kind> values) {
+    Kind result = Kind::EMPTY;
+    for (auto value : values) {
+        result = MSOLAPTypeInference::Combine(result, value);
+    }
+    return MSOLAPTypeInference::Finalize(result);
+}
+
+static void TestSingleFamily() {
+    CHECK(Infer({Kind::INTEGER, Kind::INTEGER}) == Kind::INTEGER);
+    CHECK(Infer({Kind::INTEGER, Kind::DECIMAL}) == Kind::DECIMAL);
+    CHECK(Infer({Kind::DECIMAL, Kind::INTEGER, Kind::DOUBLE}) == Kind::DOUBLE);
+    CHECK(Infer({Kind::DOUBLE, Kind::INTEGER}) == Kind::DOUBLE);
+    CHECK(Infer({Kind::DATE, Kind::DATE}) == Kind::DATE);
+    CHECK(Infer({Kind::DATE, Kind::TIMESTAMP, Kind::DATE}) == Kind::TIMESTAMP);
+    CHECK(Infer({Kind::BOOLEAN}) == Kind::BOOLEAN);
+}
+
+static void TestBlanks() {
+    // Blanks don't influence the type, an all blank sample stays VARCHAR
+    CHECK(Infer({Kind::EMPTY, Kind::INTEGER, Kind::EMPTY}) == Kind::INTEGER);
+    CHECK(Infer({Kind::EMPTY, Kind::EMPTY}) == Kind::STRING);
+    CHECK(Infer({}) == Kind::STRING);
+}
+
+static void TestMixedFamilies() {
+    CHECK(Infer({Kind::INTEGER, Kind::STRING}) == Kind::STRING);
+    CHECK(Infer({Kind::BOOLEAN, Kind::INTEGER}) == Kind::STRING);
+    CHECK(Infer({Kind::DATE, Kind::DOUBLE}) == Kind::STRING);
+    CHECK(Infer({Kind::STRING, Kind::EMPTY, Kind::DATE}) == Kind::STRING);
+}
+
+static void TestCombineIsSymmetric() {
+    auto all = {Kind::EMPTY,  Kind::BOOLEAN, Kind::INTEGER,   Kind::DECIMAL,
+                Kind::DOUBLE, Kind::DATE,    Kind::TIMESTAMP, Kind::STRING};
+    for (auto left : all) {
+        for (auto right : all) {
+            CHECK(MSOLAPTypeInference::Combine(left, right) == MSOLAPTypeInference::Combine(right, left));
+        }
+    }
+}
+
+static void TestFits() {
+    CHECK(MSOLAPTypeInference::Fits(Kind::DOUBLE, Kind::INTEGER));
+    CHECK(MSOLAPTypeInference::Fits(Kind::DECIMAL, Kind::INTEGER));
+    CHECK(MSOLAPTypeInference::Fits(Kind::TIMESTAMP, Kind::DATE));
+    CHECK(MSOLAPTypeInference::Fits(Kind::INTEGER, Kind::EMPTY));
+    CHECK(MSOLAPTypeInference::Fits(Kind::STRING, Kind::DOUBLE));
+    // A later value wider than the sample can't be stored without losing it
+    CHECK(!MSOLAPTypeInference::Fits(Kind::INTEGER, Kind::DOUBLE));
+    CHECK(!MSOLAPTypeInference::Fits(Kind::INTEGER, Kind::DECIMAL));
+    CHECK(!MSOLAPTypeInference::Fits(Kind::DATE, Kind::TIMESTAMP));
+    CHECK(!MSOLAPTypeInference::Fits(Kind::BOOLEAN, Kind::INTEGER));
+    CHECK(!MSOLAPTypeInference::Fits(Kind::DOUBLE, Kind::STRING));
+}
+
+static void TestTypeNames() {
+    CHECK(std::string(MSOLAPTypeInference::TypeName(Kind::INTEGER)) == "BIGINT");
+    CHECK(std::string(MSOLAPTypeInference::TypeName(Kind::DECIMAL)) == "DECIMAL(38,4)");
+    CHECK(std::string(MSOLAPTypeInference::TypeName(Kind::EMPTY)) == "VARCHAR");
+}
+
+int main() {
+    TestSingleFamily();
+    TestBlanks();
+    TestMixedFamilies();
+    TestCombineIsSymmetric();
+    TestFits();
+    TestTypeNames();
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All type inference tests passed\n");
+    return EXIT_SUCCESS;
+}
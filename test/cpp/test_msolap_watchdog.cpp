@@ -0,0 +1,152 @@
+// Unit tests of the cancel watchdog against a fake command that blocks until it
+// is cancelled, the way ICommand::Execute does on a slow query. Portable, build
+// with -DMSOLAP_BUILD_UNITTESTS=ON or directly:
+//
+//   g++ -std=c++17 -pthread -Isrc/include -o test_msolap_watchdog
+//       test/cpp/test_msolap_watchdog.cpp src/msolap_watchdog.cpp
+
+#include "msolap_watchdog.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace duckdb;
+using Clock = std::chrono::steady_clock;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                                               \
+    do {                                                                                                               \
+        if (!(condition)) {                                                                                            \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition);                        \
+            failures++;                                                                                                \
+        }                                                                                                              \
+    } while (0)
+
+// Latest a cancel may arrive after the interrupt or the deadline: one poll plus
+// generous slack for a loaded test machine
+static constexpr int64_t CANCEL_BOUND_MS = MSOLAP_WATCHDOG_POLL_MS + 450;
+
+// A command whose Execute blocks (up to a safety limit) until Cancel is called
+class FakeSlowCommand {
+public:
+    void Cancel() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            cancel_calls++;
+            cancelled_at = Clock::now();
+        }
+        cv.notify_all();
+    }
+
+    // Returns whether it was cancelled rather than running into the safety limit
+    bool Execute() {
+        std::unique_lock<std::mutex> guard(lock);
+        return cv.wait_for(guard, std::chrono::seconds(10), [&]() { return cancel_calls > 0; });
+    }
+
+    int CancelCalls() {
+        std::lock_guard<std::mutex> guard(lock);
+        return cancel_calls;
+    }
+
+    Clock::time_point cancelled_at;
+
+private:
+    std::mutex lock;
+    std::condition_variable cv;
+    int cancel_calls = 0;
+};
+
+static int64_t ElapsedMs(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count();
+}
+
+static void TestInterrupt() {
+    FakeSlowCommand command;
+    std::atomic<bool> interrupted(false);
+    MSOLAPWatchdog watchdog;
+    watchdog.Start([&]() { command.Cancel(); }, interrupted, 0);
+
+    Clock::time_point interrupted_at;
+    std::thread interrupter([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        interrupted_at = Clock::now();
+        interrupted = true;
+    });
+    CHECK(command.Execute());
+    interrupter.join();
+    watchdog.Stop();
+
+    CHECK(watchdog.Interrupted());
+    CHECK(!watchdog.TimedOut());
+    CHECK(command.CancelCalls() == 1);
+    CHECK(ElapsedMs(interrupted_at, command.cancelled_at) <= CANCEL_BOUND_MS);
+}
+
+static void TestTimeout() {
+    FakeSlowCommand command;
+    std::atomic<bool> interrupted(false);
+    MSOLAPWatchdog watchdog;
+    auto start = Clock::now();
+    watchdog.Start([&]() { command.Cancel(); }, interrupted, 200);
+    CHECK(command.Execute());
+    watchdog.Stop();
+
+    CHECK(watchdog.TimedOut());
+    CHECK(!watchdog.Interrupted());
+    CHECK(command.CancelCalls() == 1);
+    auto elapsed = ElapsedMs(start, command.cancelled_at);
+    CHECK(elapsed >= 200);
+    CHECK(elapsed <= 200 + CANCEL_BOUND_MS);
+}
+
+// A command that finishes on its own is never cancelled, and Stop doesn't wait
+// for the timeout
+static void TestStopBeforeCancel() {
+    FakeSlowCommand command;
+    std::atomic<bool> interrupted(false);
+    MSOLAPWatchdog watchdog;
+    watchdog.Start([&]() { command.Cancel(); }, interrupted, 60000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto start = Clock::now();
+    watchdog.Stop();
+    CHECK(ElapsedMs(start, Clock::now()) <= CANCEL_BOUND_MS);
+
+    interrupted = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2 * MSOLAP_WATCHDOG_POLL_MS));
+    CHECK(command.CancelCalls() == 0);
+    CHECK(!watchdog.Interrupted());
+    CHECK(!watchdog.TimedOut());
+}
+
+// Early teardown cancels right away and only once, even if the watchdog fires too
+static void TestExplicitCancel() {
+    FakeSlowCommand command;
+    std::atomic<bool> interrupted(false);
+    MSOLAPWatchdog watchdog;
+    watchdog.Start([&]() { command.Cancel(); }, interrupted, 0);
+    watchdog.Cancel();
+    CHECK(command.Execute());
+    interrupted = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2 * MSOLAP_WATCHDOG_POLL_MS));
+    watchdog.Stop();
+    CHECK(command.CancelCalls() == 1);
+
+    // Cancel without a watched command is a no-op
+    MSOLAPWatchdog idle;
+    idle.Cancel();
+    idle.Stop();
+}
+
+int main() {
+    TestInterrupt();
+    TestTimeout();
+    TestStopBeforeCancel();
+    TestExplicitCancel();
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All watchdog tests passed\n");
+    return EXIT_SUCCESS;
+}